@@ -1,6 +1,21 @@
 #include "Alloc.h"
+#ifdef CCSTL_ALLOC_HARDENED
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <new>
+#endif
+#ifdef CCSTL_ALLOC_HUGEPAGE
+#include "MmapAlloc.h"
+#endif
 
 namespace CCSTL {
+#ifdef CCSTL_ALLOC_HUGEPAGE
+	alloc::chunk_provider alloc::provider = huge_page_arena::allocate;
+#else
+	alloc::chunk_provider alloc::provider = malloc;
+#endif
+
 	char* alloc::start_free = 0;
 
 	char* alloc::end_free = 0;
@@ -29,10 +44,10 @@ namespace CCSTL {
 			current_obj = next_obj;
 			next_obj = (obj*)((char*)next_obj + n);
 			if(nobjs - 1 == i) {
-				current_obj->next = 0;
+				set_next(current_obj, 0);
 				break;
 			} else {
-				current_obj->next = next_obj;
+				set_next(current_obj, next_obj);
 			}
 		}
 
@@ -56,21 +71,22 @@ namespace CCSTL {
 			return result;
 		} else {
 			size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
-			if(bytes_left > 0) {
+			// 加固模式下太小的零头放不下头、尾和next指针, 直接丢弃
+			if(bytes_left >= GUARD_BYTES + ALIGN) {
 				obj** my_free_list = free_list + FREELIST_INDEX(bytes_left);
-				((obj*)start_free)->next = *my_free_list;
+				set_next((obj*)start_free, *my_free_list);
 				*my_free_list = (obj*)start_free;
 			}
 
-			start_free = (char*)malloc(bytes_to_get);
+			start_free = (char*)provider(bytes_to_get);
 			if(0 == start_free) {
-				int i;
+				size_t i;
 				obj** my_free_list, *p;
-				for(i = size + ALIGN; i < MAXBYTES; i += ALIGN) {
+				for(i = size + ALIGN; i < MAXBLOCK; i += ALIGN) {
 					my_free_list = free_list + FREELIST_INDEX(i);
 					p = *my_free_list;
 					if(0 != p) {
-						*my_free_list = p->next;
+						*my_free_list = next_of(p);
 						start_free = (char*)p;
 						end_free = start_free + i;
 						return chunk_alloc(size, nobjs);
@@ -86,4 +102,131 @@ namespace CCSTL {
 			return chunk_alloc(size, nobjs);
 		}
 	}
+
+#ifdef CCSTL_ALLOC_HARDENED
+	// 块的布局:
+	//   [请求的大小 n][状态标记][用户数据 ROUND_UP(n) 字节][尾部canary]
+	//   |<----- HEADER_BYTES ->|
+	// 状态标记 = key ^ 用户地址 ^ 状态, 释放后保留, 用来发现重复释放;
+	// 空闲块的next指针放在用户数据的开头, 其余的用户数据填上POISON,
+	// 再次分配时检查, 发现释放后写. ROUND_UP带来的零头填上SLACK, 释放时检查.
+	// 大小为0的请求也占ALIGN字节, 保证放得下next指针
+	namespace {
+		const uintptr_t STATE_ALLOCATED = 0xA110CA7EDull;
+		const uintptr_t STATE_FREED = 0xF4EED0B1Eull;
+		const unsigned char POISON = 0xDD;
+		const unsigned char SLACK = 0xAB;
+
+		void hardened_fail(const char* what, const void* p, size_t expected = 0, size_t got = 0) {
+			if(expected != got)
+				fprintf(stderr, "CCSTL alloc: %s at %p (allocated %zu bytes, deallocated with %zu)\n",
+				        what, p, expected, got);
+			else
+				fprintf(stderr, "CCSTL alloc: %s at %p\n", what, p);
+			abort();
+		}
+
+		bool all_equal(const unsigned char* p, size_t n, unsigned char c) {
+			for(size_t i = 0; i < n; ++i) {
+				if(p[i] != c)
+					return false;
+			}
+			return true;
+		}
+
+		// p按8字节对齐, n是8的倍数: 逐字比较, 用户数据最多128字节, 开销有限
+		bool all_poison(const unsigned char* p, size_t n) {
+			const uint64_t word = 0x0101010101010101ull * POISON;
+			uint64_t diff = 0;
+			for(size_t i = 0; i < n; i += 8)
+				diff |= *(const uint64_t*)(p + i) ^ word;
+			return diff == 0;
+		}
+	}
+
+	uintptr_t alloc::key = 0;
+
+	// 第一次使用时由ASLR后的地址和启动时间生成, 最低位为1保证非0
+	uintptr_t alloc::secret() {
+		if(key == 0)
+			key = ((uintptr_t(&key) ^ uintptr_t(time(0))) * uintptr_t(0x9E3779B97F4A7C15ull)) | 1;
+		return key;
+	}
+
+	alloc::obj* alloc::next_of(obj* p) {
+		uintptr_t* slot = (uintptr_t*)((char*)p + HEADER_BYTES);
+		uintptr_t next = *slot ^ secret() ^ uintptr_t(slot);
+		if(next & (ALIGN - 1))
+			hardened_fail("free list corrupted (write after free or overflow)", p);
+		return (obj*)next;
+	}
+
+	void alloc::set_next(obj* p, obj* next) {
+		uintptr_t* slot = (uintptr_t*)((char*)p + HEADER_BYTES);
+		*slot = uintptr_t(next) ^ secret() ^ uintptr_t(slot);
+	}
+
+	void* alloc::hardened_allocate(size_t n) {
+		size_t user_bytes = ROUND_UP(n ? n : 1);
+		size_t block = user_bytes + GUARD_BYTES;
+		char* b;
+		if(n > MAXBYTES) {
+			b = (char*)::operator new(block);
+		} else {
+			obj** my_free_list = free_list + FREELIST_INDEX(block);
+			obj* result = *my_free_list;
+			if(result == 0) {
+				b = (char*)refill(block);
+			} else {
+				*my_free_list = next_of(result);
+				b = (char*)result;
+				// 以前分配过的块: 除了next指针, 用户数据应当还是POISON
+				uintptr_t* h = (uintptr_t*)b;
+				if((h[1] ^ secret() ^ uintptr_t(b + HEADER_BYTES)) == STATE_FREED &&
+				   !all_poison((unsigned char*)b + HEADER_BYTES + sizeof(uintptr_t),
+				               ROUND_UP(h[0] ? h[0] : 1) - sizeof(uintptr_t)))
+					hardened_fail("freed block modified (write after free)", b + HEADER_BYTES);
+			}
+		}
+		char* user = b + HEADER_BYTES;
+		uintptr_t* h = (uintptr_t*)b;
+		h[0] = n;
+		h[1] = secret() ^ uintptr_t(user) ^ STATE_ALLOCATED;
+		memset(user + n, SLACK, user_bytes - n);
+		*(uintptr_t*)(user + user_bytes) = secret() ^ uintptr_t(user) ^ n;
+		return user;
+	}
+
+	void alloc::hardened_deallocate(void* p, size_t n) {
+		if(p == 0)
+			return;
+		char* user = (char*)p;
+		char* b = user - HEADER_BYTES;
+		uintptr_t* h = (uintptr_t*)b;
+		uintptr_t state = h[1] ^ secret() ^ uintptr_t(user);
+		if(state == STATE_FREED)
+			hardened_fail("double free", p);
+		if(state != STATE_ALLOCATED)
+			hardened_fail("invalid pointer or corrupted block header (underflow)", p);
+		if(h[0] != n)
+			hardened_fail("size mismatch", p, h[0], n);
+		size_t user_bytes = ROUND_UP(n ? n : 1);
+		if(*(uintptr_t*)(user + user_bytes) != (secret() ^ uintptr_t(user) ^ n) ||
+		   !all_equal((unsigned char*)user + n, user_bytes - n, SLACK))
+			hardened_fail("buffer overflow (canary overwritten)", p);
+
+		if(n > MAXBYTES) {
+			// 交还给operator new的内存可能被malloc重新切给内存池, 不能留下FREED标记,
+			// 否则会被误认为池中释放过的块; 所以大块的重复释放只能报告为头部损坏
+			h[1] = 0;
+			::operator delete(b);
+			return;
+		}
+		h[1] = secret() ^ uintptr_t(user) ^ STATE_FREED;
+		memset(user, POISON, user_bytes);
+		obj** my_free_list = free_list + FREELIST_INDEX(user_bytes + GUARD_BYTES);
+		set_next((obj*)b, *my_free_list);
+		*my_free_list = (obj*)b;
+	}
+#endif
 }
\ No newline at end of file
@@ -2,14 +2,44 @@
 #define ALLOC_H
 #include <cstdlib>
 #include <cstddef>
+#include <mutex>
+#if defined(CCSTL_ALLOC_HARDENED) || defined(CCSTL_ALLOC_PROFILE)
+#include <stdint.h>
+#endif
+#ifdef CCSTL_ALLOC_PROFILE
+#include <typeinfo>
+#endif
 
 namespace CCSTL{
 	class alloc {
+	public:
+		// 内存池向系统要大块内存的函数, 失败时返回0, 由池子自行回退
+		// 默认是malloc; 定义CCSTL_ALLOC_HUGEPAGE时默认为huge_page_arena::allocate(见MmapAlloc.h)
+		typedef void* (*chunk_provider)(size_t bytes);
+
+		// 应在第一次分配之前设置; 池子不归还chunk, 所以provider不需要配套的释放函数
+		static void set_chunk_provider(chunk_provider p) { provider = p; }
+		static chunk_provider get_chunk_provider() { return provider; }
+
+#ifdef CCSTL_ALLOC_TRACE
+		// 每次allocate/deallocate之后调用, 0表示不记录; 由alloc_trace::start安装(见AllocTrace.h)
+		typedef void (*trace_hook)(bool is_allocate, void* p, size_t n);
+		static void set_trace_hook(trace_hook h) { tracer = h; }
+#endif
+
 	private:
-		const size_t ALIGN = 8;
-		const size_t MAXBYTES = 128;
-		const size_t NFREELISTS = MAXBYTES / CALIGN;
-		const size_t NNODES = 20;
+		static const size_t ALIGN = 8;
+		static const size_t MAXBYTES = 128;
+#ifdef CCSTL_ALLOC_HARDENED
+		// 加固模式: 每个块前有16字节的头(请求的大小, 状态标记), 后有8字节的尾部canary
+		static const size_t HEADER_BYTES = 16;
+		static const size_t GUARD_BYTES = HEADER_BYTES + 8;
+#else
+		static const size_t GUARD_BYTES = 0;
+#endif
+		static const size_t MAXBLOCK = MAXBYTES + GUARD_BYTES;  // 内存池中最大的块
+		static const size_t NFREELISTS = MAXBLOCK / ALIGN;
+		static const size_t NNODES = 20;
 
 	private:
 		static size_t ROUND_UP(size_t bytes) {
@@ -27,6 +57,21 @@ namespace CCSTL{
 			return (((bytes) + ALIGN - 1) / ALIGN - 1);
 		}
 
+#ifdef CCSTL_ALLOC_HARDENED
+		// 空闲块的next指针与块地址、随机密钥异或后存放,
+		// 被越界写或释放后写改掉的next解码后几乎不可能还是合法的地址
+		static uintptr_t key;
+		static uintptr_t secret();
+		static obj* next_of(obj* p);
+		static void set_next(obj* p, obj* next);
+
+		static void* hardened_allocate(size_t n);
+		static void hardened_deallocate(void* p, size_t n);
+#else
+		static obj* next_of(obj* p) { return p->next; }
+		static void set_next(obj* p, obj* next) { p->next = next; }
+#endif
+
 		static void* refill(size_t n);
 		static char* chunk_alloc(size_t size, int& nobjs);
 
@@ -34,8 +79,31 @@ namespace CCSTL{
 		static char* end_free;       // 内存池的尾
 
 		static size_t heap_size;     // 分配累计量
-	public:
-		static void* allocate(size_t n) {
+
+		static chunk_provider provider;
+#ifdef CCSTL_ALLOC_TRACE
+		static trace_hook tracer;
+#endif
+
+#ifdef CCSTL_ALLOC_PROFILE
+		// 采样分析(见AllocProfile.h): 距离下一次采样还剩的字节数, 减到负数时采样
+		static long sample_countdown;
+		// 计数器, 下标为地址的散列; 非0表示可能有被采样的块在这个位置, 释放时才去精确查找
+		static unsigned char sample_filter[1 << 16];
+		static size_t sample_filter_index(void* p) {
+			return size_t((uintptr_t(p) >> 3) * uintptr_t(0x9E3779B97F4A7C15ull)) >> (sizeof(size_t) * 8 - 16);
+		}
+
+		static void* sampled_allocate(size_t n, const char* type);
+		static void sampled_deallocate(void* p);
+
+		friend class alloc_profiler;
+#endif
+
+		static void* pool_allocate(size_t n) {
+#ifdef CCSTL_ALLOC_HARDENED
+			return hardened_allocate(n);
+#else
 			obj** my_free_list;
 			obj* result;
 
@@ -52,9 +120,13 @@ namespace CCSTL{
 
 			*my_free_list = result->next;
 			return result;
+#endif
 		}
 
-		static void deallocate(void* p, size_t n) {
+		static void pool_deallocate(void* p, size_t n) {
+#ifdef CCSTL_ALLOC_HARDENED
+			hardened_deallocate(p, n);
+#else
 			obj* q = (obj*)p;
 			obj** my_free_list;
 
@@ -66,6 +138,36 @@ namespace CCSTL{
 			my_free_list = free_list + FREELIST_INDEX(n);
 			q->next = *my_free_list;
 			*my_free_list = q;
+#endif
+		}
+
+	public:
+		// type是元素类型的名字(typeid(T).name()), 只在采样分析时使用, 见alloc_type_name
+		static void* allocate(size_t n, const char* type = 0) {
+#ifdef CCSTL_ALLOC_PROFILE
+			// 快速路径上只有这一次减法和比较
+			void* p = (sample_countdown -= long(n)) < 0 ? sampled_allocate(n, type) : pool_allocate(n);
+#else
+			(void)type;
+			void* p = pool_allocate(n);
+#endif
+#ifdef CCSTL_ALLOC_TRACE
+			if(tracer)
+				tracer(true, p, n);
+#endif
+			return p;
+		}
+
+		static void deallocate(void* p, size_t n) {
+#ifdef CCSTL_ALLOC_PROFILE
+			if(sample_filter[sample_filter_index(p)])
+				sampled_deallocate(p);
+#endif
+#ifdef CCSTL_ALLOC_TRACE
+			if(tracer)
+				tracer(false, p, n);
+#endif
+			pool_deallocate(p, n);
 		}
 
 		static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
@@ -76,5 +178,22 @@ namespace CCSTL{
 		}
 	};
 
+	// alloc的内存池本身不加锁. 会在多个线程中分配和释放的容器(concurrent_vector、persistent_vector)
+	// 调用alloc时都持有这把进程内唯一的锁, 彼此之间不会同时进入内存池;
+	// 其它线程里不加锁直接使用alloc的容器仍然不能与它们并发
+	inline std::mutex& alloc_mutex() {
+		static std::mutex m;
+		return m;
+	}
+
+	// allocator<T>把元素类型传给alloc::allocate, 不做采样分析时为0
+	template <class T>
+	inline const char* alloc_type_name() {
+#ifdef CCSTL_ALLOC_PROFILE
+		return typeid(T).name();
+#else
+		return 0;
+#endif
+	}
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,281 @@
+#ifdef CCSTL_ALLOC_PROFILE
+#include "AllocProfile.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+
+namespace CCSTL {
+	// 初始为0, 第一次分配就会进入sampled_allocate, 在那里开始计数
+	long alloc::sample_countdown = 0;
+	unsigned char alloc::sample_filter[1 << 16] = {0};
+
+	namespace {
+		const int MAX_DEPTH = 64;
+		// backtrace中属于采样代码本身的栈帧: record_allocation, alloc::sampled_allocate
+		const int SKIP_FRAMES = 2;
+
+		// 同一个调用栈加同一个类型合并为一条
+		struct stack_record {
+			std::vector<void*> frames;   // frames[0]是最内层
+			const char* type;
+			// 采样得到的原始次数和字节数, pprof的heap_v2格式需要这些
+			size_t live_count, live_bytes;
+			size_t alloc_count, alloc_bytes;
+			// 换算后估计的真实字节数
+			double live_estimate, alloc_estimate;
+		};
+
+		struct live_sample {
+			size_t stack;
+			size_t size;
+			double estimate;
+		};
+
+		// 内部的表都用std的容器, 经过operator new分配, 不会递归进alloc
+		struct profile_state {
+			size_t rate;
+			bool started;
+			unsigned long long rng;
+			size_t samples;
+			std::vector<stack_record> stacks;
+			std::unordered_map<std::string, size_t> stack_index;
+			std::unordered_map<void*, live_sample> live;
+
+			profile_state(): rate(512 * 1024), started(false), rng(88172645463325252ull), samples(0) {}
+		};
+
+		// 永不析构: 静态对象析构阶段仍可能有容器在释放内存
+		profile_state& state() {
+			static profile_state* s = new profile_state;
+			return *s;
+		}
+
+		// 大小为n的分配被采到的概率是1 - exp(-n/rate), 按概率的倒数放大
+		double estimate(size_t n, size_t rate) {
+			if(rate <= 1)
+				return double(n);
+			return double(n) / (1.0 - std::exp(-double(n) / double(rate)));
+		}
+
+		std::string demangle(const char* name) {
+			int status = 0;
+			char* s = abi::__cxa_demangle(name, 0, 0, &status);
+			if(status != 0 || !s)
+				return name;
+			std::string result(s);
+			free(s);
+			return result;
+		}
+
+		const std::string& symbol(void* pc, std::unordered_map<void*, std::string>& cache) {
+			std::unordered_map<void*, std::string>::iterator it = cache.find(pc);
+			if(it != cache.end())
+				return it->second;
+			Dl_info info;
+			std::string name;
+			if(dladdr(pc, &info) && info.dli_sname) {
+				name = demangle(info.dli_sname);
+			} else {
+				char buf[32];
+				snprintf(buf, sizeof(buf), "%p", pc);
+				name = buf;
+			}
+			return cache[pc] = name;
+		}
+	}
+
+	// ---------------------------------------------------------------
+	// alloc中的采样入口
+	// ---------------------------------------------------------------
+	__attribute__((noinline)) void* alloc::sampled_allocate(size_t n, const char* type) {
+		void* p = pool_allocate(n);
+		alloc_profiler::record_allocation(p, n, type);
+		return p;
+	}
+
+	void alloc::sampled_deallocate(void* p) {
+		alloc_profiler::record_deallocation(p);
+	}
+
+	// ---------------------------------------------------------------
+	// alloc_profiler
+	// ---------------------------------------------------------------
+	// 几何分布的采样间隔: 每个字节以1/rate的概率被选中
+	long alloc_profiler::next_interval() {
+		profile_state& s = state();
+		if(s.rate <= 1)
+			return 0;
+		s.rng ^= s.rng << 13;
+		s.rng ^= s.rng >> 7;
+		s.rng ^= s.rng << 17;
+		double u = (double((s.rng >> 11) + 1)) / 9007199254740993.0;   // (0, 1]
+		double interval = -std::log(u) * double(s.rate);
+		return interval > 1e15 ? long(1e15) : long(interval);
+	}
+
+	__attribute__((noinline)) void alloc_profiler::record_allocation(void* p, size_t n, const char* type) {
+		profile_state& s = state();
+		alloc::sample_countdown = next_interval();
+		if(!s.started) {
+			// 第一次分配只是开始计数, 不记录
+			s.started = true;
+			return;
+		}
+		if(!p)
+			return;
+
+		void* frames[MAX_DEPTH];
+		int depth = backtrace(frames, MAX_DEPTH);
+		int skip = depth > SKIP_FRAMES ? SKIP_FRAMES : 0;
+		std::string key(reinterpret_cast<const char*>(frames + skip), (depth - skip) * sizeof(void*));
+		key.append(reinterpret_cast<const char*>(&type), sizeof(type));
+
+		size_t index;
+		std::unordered_map<std::string, size_t>::iterator it = s.stack_index.find(key);
+		if(it == s.stack_index.end()) {
+			index = s.stacks.size();
+			stack_record r;
+			r.frames.assign(frames + skip, frames + depth);
+			r.type = type;
+			r.live_count = r.live_bytes = r.alloc_count = r.alloc_bytes = 0;
+			r.live_estimate = r.alloc_estimate = 0;
+			s.stacks.push_back(r);
+			s.stack_index[key] = index;
+		} else {
+			index = it->second;
+		}
+
+		double est = estimate(n, s.rate);
+		stack_record& r = s.stacks[index];
+		++r.live_count;
+		r.live_bytes += n;
+		r.live_estimate += est;
+		++r.alloc_count;
+		r.alloc_bytes += n;
+		r.alloc_estimate += est;
+		++s.samples;
+
+		live_sample ls = {index, n, est};
+		s.live[p] = ls;
+		// 计数满了就不再变化, 这个位置以后每次释放都会去查表
+		unsigned char& f = alloc::sample_filter[alloc::sample_filter_index(p)];
+		if(f != 255)
+			++f;
+	}
+
+	void alloc_profiler::record_deallocation(void* p) {
+		profile_state& s = state();
+		std::unordered_map<void*, live_sample>::iterator it = s.live.find(p);
+		if(it == s.live.end())
+			return;
+		stack_record& r = s.stacks[it->second.stack];
+		--r.live_count;
+		r.live_bytes -= it->second.size;
+		r.live_estimate -= it->second.estimate;
+		s.live.erase(it);
+		unsigned char& f = alloc::sample_filter[alloc::sample_filter_index(p)];
+		if(f != 255)
+			--f;
+	}
+
+	void alloc_profiler::set_sample_rate(size_t bytes) {
+		state().rate = bytes ? bytes : 1;
+		alloc::sample_countdown = next_interval();
+	}
+
+	size_t alloc_profiler::sample_rate() {
+		return state().rate;
+	}
+
+	size_t alloc_profiler::samples() {
+		return state().samples;
+	}
+
+	void alloc_profiler::reset() {
+		profile_state& s = state();
+		for(size_t i = 0; i < s.stacks.size(); ++i) {
+			s.stacks[i].alloc_count = s.stacks[i].alloc_bytes = 0;
+			s.stacks[i].alloc_estimate = 0;
+		}
+	}
+
+	// 格式见gperftools的heap profile: 第一行是总计, 之后每行一个调用栈,
+	// "live次数: live字节 [累计次数: 累计字节] @ 地址...", 最后附上/proc/self/maps
+	void alloc_profiler::dump_pprof(FILE* f) {
+		profile_state& s = state();
+		size_t live_count = 0, live_bytes = 0, alloc_count = 0, alloc_bytes = 0;
+		for(size_t i = 0; i < s.stacks.size(); ++i) {
+			live_count += s.stacks[i].live_count;
+			live_bytes += s.stacks[i].live_bytes;
+			alloc_count += s.stacks[i].alloc_count;
+			alloc_bytes += s.stacks[i].alloc_bytes;
+		}
+		fprintf(f, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n",
+		        live_count, live_bytes, alloc_count, alloc_bytes, s.rate);
+		for(size_t i = 0; i < s.stacks.size(); ++i) {
+			const stack_record& r = s.stacks[i];
+			if(r.live_count == 0 && r.alloc_count == 0)
+				continue;
+			fprintf(f, "%zu: %zu [%zu: %zu] @", r.live_count, r.live_bytes, r.alloc_count, r.alloc_bytes);
+			for(size_t k = 0; k < r.frames.size(); ++k)
+				fprintf(f, " %p", r.frames[k]);
+			fputc('\n', f);
+		}
+		fputs("\nMAPPED_LIBRARIES:\n", f);
+		FILE* maps = fopen("/proc/self/maps", "r");
+		if(maps) {
+			char buf[4096];
+			size_t n;
+			while((n = fread(buf, 1, sizeof(buf), maps)) > 0)
+				fwrite(buf, 1, n, f);
+			fclose(maps);
+		}
+	}
+
+	bool alloc_profiler::dump_pprof(const char* path) {
+		FILE* f = fopen(path, "w");
+		if(!f)
+			return false;
+		dump_pprof(f);
+		return fclose(f) == 0;
+	}
+
+	void alloc_profiler::dump_folded(FILE* f, kind k) {
+		profile_state& s = state();
+		std::unordered_map<void*, std::string> cache;
+		std::string line;
+		for(size_t i = 0; i < s.stacks.size(); ++i) {
+			const stack_record& r = s.stacks[i];
+			double value = k == LIVE ? r.live_estimate : r.alloc_estimate;
+			if(value < 0.5)
+				continue;
+			line.clear();
+			for(size_t j = r.frames.size(); j > 0; --j) {
+				if(!line.empty())
+					line += ';';
+				line += symbol(r.frames[j - 1], cache);
+			}
+			if(r.type) {
+				line += ";[";
+				line += demangle(r.type);
+				line += ']';
+			}
+			fprintf(f, "%s %.0f\n", line.c_str(), value);
+		}
+	}
+
+	bool alloc_profiler::dump_folded(const char* path, kind k) {
+		FILE* f = fopen(path, "w");
+		if(!f)
+			return false;
+		dump_folded(f, k);
+		return fclose(f) == 0;
+	}
+}
+#endif
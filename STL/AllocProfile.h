@@ -0,0 +1,53 @@
+#ifndef ALLOCPROFILE_H
+#define ALLOCPROFILE_H
+#include <cstddef>
+#include <cstdio>
+#include "Alloc.h"
+
+// alloc的采样分析, 只在定义了CCSTL_ALLOC_PROFILE时编译, 需要链接AllocProfile.cpp
+//
+// 每分配约sample_rate个字节, alloc::allocate就记录一次调用栈和大小;
+// 采样间隔服从均值为sample_rate的几何分布, 所以大的分配更容易被采到,
+// 由采样结果可以无偏地估计每个调用栈分配了多少字节.
+// 经过allocator<T>的分配还带有元素类型.
+//
+// 同时维护两份数据:
+//   live        目前还没有释放的采样块, 看谁占着内存
+//   cumulative  启动(或reset)以来所有的采样, 看谁让chunk_alloc不断扩大内存池
+// 与alloc一样不是线程安全的
+#ifdef CCSTL_ALLOC_PROFILE
+namespace CCSTL {
+	class alloc_profiler {
+	public:
+		enum kind { LIVE, CUMULATIVE };
+
+		// 平均每隔多少字节采样一次, 默认512KiB; 设为1时每次分配都采样
+		static void set_sample_rate(size_t bytes);
+		static size_t sample_rate();
+
+		// pprof的legacy heap格式(heap_v2), 同时包含live和cumulative,
+		// 用 pprof <程序> <文件> 查看, pprof会自己符号化并换算采样
+		static void dump_pprof(FILE* f);
+		static bool dump_pprof(const char* path);
+
+		// 折叠栈格式, 每行"函数;函数;...;[类型] 字节数", 可直接交给flamegraph.pl或speedscope.
+		// 字节数是换算后的估计值. 程序需要用-rdynamic链接, 否则只能输出地址
+		static void dump_folded(FILE* f, kind k);
+		static bool dump_folded(const char* path, kind k);
+
+		// 清空cumulative, live不受影响
+		static void reset();
+
+		// 采样的次数, 统计用
+		static size_t samples();
+
+	private:
+		static void record_allocation(void* p, size_t n, const char* type);
+		static void record_deallocation(void* p);
+		static long next_interval();
+
+		friend class alloc;
+	};
+}
+#endif
+#endif
@@ -0,0 +1,223 @@
+#include "AllocTrace.h"
+#include <cstring>
+#ifdef CCSTL_ALLOC_TRACE
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#endif
+
+namespace CCSTL {
+	namespace {
+		const char MAGIC[8] = {'C', 'C', 'S', 'T', 'L', 'A', 'T', '1'};
+	}
+
+	// ---------------------------------------------------------------
+	// writer
+	// ---------------------------------------------------------------
+	bool alloc_trace::writer::open(const char* path) {
+		close();
+		f = fopen(path, "wb");
+		if(!f)
+			return false;
+		uint32_t header[2] = {version, 0};
+		fwrite(MAGIC, 1, sizeof(MAGIC), f);
+		fwrite(header, 1, sizeof(header), f);
+		return true;
+	}
+
+	void alloc_trace::writer::flush() {
+		if(used) {
+			fwrite(buf, 1, used, f);
+			used = 0;
+		}
+	}
+
+	void alloc_trace::writer::put_varint(uint64_t v) {
+		while(v >= 0x80) {
+			buf[used++] = (unsigned char)(v | 0x80);
+			v >>= 7;
+		}
+		buf[used++] = (unsigned char)v;
+	}
+
+	void alloc_trace::writer::write(const event& e) {
+		// 一个事件最多1 + 4 * 10字节
+		if(used + 41 > sizeof(buf))
+			flush();
+		buf[used++] = e.op;
+		put_varint(e.thread);
+		put_varint(e.id);
+		put_varint(e.size);
+		put_varint(e.delta_ns);
+	}
+
+	bool alloc_trace::writer::close() {
+		if(!f)
+			return true;
+		flush();
+		bool ok = fclose(f) == 0;
+		f = 0;
+		return ok;
+	}
+
+	// ---------------------------------------------------------------
+	// reader
+	// ---------------------------------------------------------------
+	bool alloc_trace::reader::open(const char* path) {
+		close();
+		f = fopen(path, "rb");
+		if(!f)
+			return false;
+		char magic[8];
+		uint32_t header[2];
+		if(fread(magic, 1, sizeof(magic), f) != sizeof(magic) ||
+		   fread(header, 1, sizeof(header), f) != sizeof(header) ||
+		   memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || header[0] != version) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	bool alloc_trace::reader::get_byte(unsigned char& c) {
+		if(pos == len) {
+			len = fread(buf, 1, sizeof(buf), f);
+			pos = 0;
+			if(len == 0)
+				return false;
+		}
+		c = buf[pos++];
+		return true;
+	}
+
+	bool alloc_trace::reader::get_varint(uint64_t& v) {
+		v = 0;
+		unsigned char c;
+		for(int shift = 0; shift < 64; shift += 7) {
+			if(!get_byte(c))
+				return false;
+			v |= uint64_t(c & 0x7f) << shift;
+			if(!(c & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	bool alloc_trace::reader::next(event& e) {
+		unsigned char op;
+		uint64_t thread;
+		if(!f || !get_byte(op))
+			return false;
+		if(!get_varint(thread) || !get_varint(e.id) || !get_varint(e.size) || !get_varint(e.delta_ns))
+			return false;
+		e.op = op;
+		e.thread = uint32_t(thread);
+		return true;
+	}
+
+	void alloc_trace::reader::close() {
+		if(f)
+			fclose(f);
+		f = 0;
+		pos = len = 0;
+	}
+
+#ifdef CCSTL_ALLOC_TRACE
+	alloc::trace_hook alloc::tracer = 0;
+
+	// ---------------------------------------------------------------
+	// 记录
+	// ---------------------------------------------------------------
+	namespace {
+		// 内部的表都用std的容器, 经过operator new分配, 不会递归进alloc
+		struct recorder {
+			std::mutex m;
+			alloc_trace::writer out;
+			std::unordered_map<void*, uint64_t> ids;
+			std::vector<uint64_t> free_ids;
+			uint64_t next_id;
+			uint32_t threads;
+			uint64_t generation;   // 每次start加一, 让线程编号重新分配
+			std::chrono::steady_clock::time_point last;
+
+			recorder(): next_id(0), threads(0), generation(0) {}
+		};
+
+		// 永不析构: 静态对象析构阶段仍可能有容器在释放内存
+		recorder& state() {
+			static recorder* r = new recorder;
+			return *r;
+		}
+
+		uint32_t thread_index(recorder& r) {
+			static thread_local uint64_t generation = 0;
+			static thread_local uint32_t index = 0;
+			if(generation != r.generation) {
+				generation = r.generation;
+				index = r.threads++;
+			}
+			return index;
+		}
+	}
+
+	bool alloc_trace::start(const char* path) {
+		stop();
+		recorder& r = state();
+		std::lock_guard<std::mutex> lock(r.m);
+		if(!r.out.open(path))
+			return false;
+		r.ids.clear();
+		r.free_ids.clear();
+		r.next_id = 0;
+		r.threads = 0;
+		++r.generation;
+		r.last = std::chrono::steady_clock::now();
+		alloc::set_trace_hook(hook);
+		return true;
+	}
+
+	void alloc_trace::stop() {
+		recorder& r = state();
+		alloc::set_trace_hook(0);
+		std::lock_guard<std::mutex> lock(r.m);
+		r.out.close();
+	}
+
+	bool alloc_trace::recording() {
+		return state().out.is_open();
+	}
+
+	void alloc_trace::hook(bool is_allocate, void* p, size_t n) {
+		recorder& r = state();
+		std::lock_guard<std::mutex> lock(r.m);
+		if(!r.out.is_open() || !p)
+			return;
+		event e;
+		e.op = is_allocate ? ALLOCATE : DEALLOCATE;
+		e.size = n;
+		if(is_allocate) {
+			if(r.free_ids.empty()) {
+				e.id = r.next_id++;
+			} else {
+				e.id = r.free_ids.back();
+				r.free_ids.pop_back();
+			}
+			r.ids[p] = e.id;
+		} else {
+			// 开始记录之前分配的对象, 重放时无法对应, 不记录
+			std::unordered_map<void*, uint64_t>::iterator it = r.ids.find(p);
+			if(it == r.ids.end())
+				return;
+			e.id = it->second;
+			r.free_ids.push_back(e.id);
+			r.ids.erase(it);
+		}
+		e.thread = thread_index(r);
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		e.delta_ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - r.last).count());
+		r.last = now;
+		r.out.write(e);
+	}
+#endif
+}
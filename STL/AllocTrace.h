@@ -0,0 +1,88 @@
+#ifndef ALLOCTRACE_H
+#define ALLOCTRACE_H
+#include <cstddef>
+#include <cstdio>
+#include <stdint.h>
+#include "Alloc.h"
+
+// alloc的分配轨迹: 记录每一次allocate/deallocate, 离线重放来调整内存池的参数
+//
+// 轨迹文件是紧凑的二进制格式:
+//   文件头 16字节: "CCSTLAT1", uint32 版本, uint32 保留
+//   事件   1字节操作 + 4个varint: 线程编号, 对象编号, 大小, 距上一个事件的纳秒数
+// 对象编号代替地址: 分配时取一个空闲的编号, 释放时归还, 所以编号总是小于同时存活的对象数,
+// 重放时可以直接用数组保存对象. 一个事件通常只占6~8字节.
+//
+// 读写轨迹文件总是可用的; 记录功能只在定义了CCSTL_ALLOC_TRACE时编译,
+// 那时需要链接AllocTrace.cpp
+namespace CCSTL {
+	class alloc_trace {
+	public:
+		enum op { ALLOCATE = 0, DEALLOCATE = 1 };
+
+		struct event {
+			uint8_t op;
+			uint32_t thread;
+			uint64_t id;
+			uint64_t size;
+			uint64_t delta_ns;   // 距上一个事件的时间
+		};
+
+		static const uint32_t version = 1;
+
+		class writer {
+		public:
+			writer(): f(0), used(0) {}
+			~writer() { close(); }
+
+			bool open(const char* path);
+			void write(const event& e);
+			bool close();
+			bool is_open() const { return f != 0; }
+
+		private:
+			writer(const writer&);
+			writer& operator=(const writer&);
+			void put_varint(uint64_t v);
+			void flush();
+
+			FILE* f;
+			size_t used;
+			unsigned char buf[1 << 16];
+		};
+
+		class reader {
+		public:
+			reader(): f(0), pos(0), len(0) {}
+			~reader() { close(); }
+
+			// 文件头不对时返回false
+			bool open(const char* path);
+			// 读到文件尾返回false
+			bool next(event& e);
+			void close();
+
+		private:
+			reader(const reader&);
+			reader& operator=(const reader&);
+			bool get_byte(unsigned char& c);
+			bool get_varint(uint64_t& v);
+
+			FILE* f;
+			size_t pos;
+			size_t len;
+			unsigned char buf[1 << 16];
+		};
+
+#ifdef CCSTL_ALLOC_TRACE
+		// 开始记录到path, 已经在记录时先结束上一个. 记录本身加锁, 线程按第一次出现的顺序编号
+		static bool start(const char* path);
+		static void stop();
+		static bool recording();
+
+	private:
+		static void hook(bool is_allocate, void* p, size_t n);
+#endif
+	};
+}
+#endif
@@ -0,0 +1,84 @@
+#include "Instrument.h"
+#include <cstring>
+#include <mutex>
+
+namespace CCSTL {
+	namespace {
+		// 计数器都是函数内的静态对象, 登记后一直有效, 所以只需要一个单链表
+		std::mutex& registry_mutex() {
+			static std::mutex* m = new std::mutex;
+			return *m;
+		}
+
+		instrument_counters* head = 0;
+
+		size_t get(const std::atomic<size_t>& a) {
+			return a.load(std::memory_order_relaxed);
+		}
+	}
+
+	instrument_counters::instrument_counters(const char* name):
+		name(name), allocations(0), deallocations(0), bytes_allocated(0), bytes_deallocated(0),
+		reallocations(0), bytes_copied(0), copies(0), moves(0), max_size(0), next(0) {
+		instrument_registry::add(this);
+	}
+
+	void instrument_counters::reset() {
+		allocations.store(0, std::memory_order_relaxed);
+		deallocations.store(0, std::memory_order_relaxed);
+		bytes_allocated.store(0, std::memory_order_relaxed);
+		bytes_deallocated.store(0, std::memory_order_relaxed);
+		reallocations.store(0, std::memory_order_relaxed);
+		bytes_copied.store(0, std::memory_order_relaxed);
+		copies.store(0, std::memory_order_relaxed);
+		moves.store(0, std::memory_order_relaxed);
+		max_size.store(0, std::memory_order_relaxed);
+	}
+
+	void instrument_registry::add(instrument_counters* c) {
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		// 接在尾部, dump的顺序就是第一次使用的顺序
+		instrument_counters** p = &head;
+		while(*p)
+			p = &(*p)->next;
+		*p = c;
+	}
+
+	instrument_counters* instrument_registry::find(const char* name) {
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		for(instrument_counters* c = head; c; c = c->next) {
+			if(strcmp(c->name, name) == 0)
+				return c;
+		}
+		return 0;
+	}
+
+	void instrument_registry::dump(FILE* f) {
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		fprintf(f, "%-24s %12s %12s %14s %14s %12s %14s %12s %12s %10s\n",
+		        "name", "allocs", "deallocs", "bytes_alloc", "bytes_dealloc",
+		        "reallocs", "bytes_copied", "copies", "moves", "max_size");
+		for(instrument_counters* c = head; c; c = c->next) {
+			fprintf(f, "%-24s %12zu %12zu %14zu %14zu %12zu %14zu %12zu %12zu %10zu\n",
+			        c->name, get(c->allocations), get(c->deallocations),
+			        get(c->bytes_allocated), get(c->bytes_deallocated),
+			        get(c->reallocations), get(c->bytes_copied),
+			        get(c->copies), get(c->moves), get(c->max_size));
+		}
+		fflush(f);
+	}
+
+	bool instrument_registry::dump(const char* path) {
+		FILE* f = fopen(path, "w");
+		if(!f)
+			return false;
+		dump(f);
+		return fclose(f) == 0;
+	}
+
+	void instrument_registry::reset() {
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		for(instrument_counters* c = head; c; c = c->next)
+			c->reset();
+	}
+}
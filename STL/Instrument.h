@@ -0,0 +1,116 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+
+// 容器的计数策略, 作为vector/list/deque的最后一个模板参数
+//
+// 容器在关键的地方调用策略的静态函数:
+//   on_allocate / on_deallocate  取得/归还一块内存(vector的缓冲区, list的节点, deque的缓冲区和map)
+//   on_reallocate                vector扩容或deque的map搬家, 参数是搬过去的字节数
+//   on_copy                      因复制容器而复制的元素个数, 以及vector扩容时移动构造可能抛异常、只好复制的元素个数
+//   on_move                      移动构造/赋值时直接接管的元素个数, 以及vector扩容、插入删除时移动的元素个数
+//   on_size                      插入后的元素个数, 用于记录最大值(list只在策略不是null_instrument时才计数, 见List.h)
+// 默认的null_instrument全是空的内联函数, 编译后什么也不剩, 容器的大小和代码都与没有策略时相同.
+//
+// counted_instrument<Tag>把这些事件累加到以Tag::tag()命名的一组计数器上, 同一个Tag的容器共用一组.
+// 计数器登记在instrument_registry中, 可以随时dump; 用到counted_instrument时需要链接Instrument.cpp
+//
+//   CCSTL_INSTRUMENT_TAG(order_book);
+//   CCSTL::vector<order, CCSTL::allocator<order>, CCSTL::counted_instrument<order_book>> orders;
+//   ...
+//   CCSTL::instrument_registry::dump(stderr);
+namespace CCSTL {
+	struct null_instrument {
+		static void on_allocate(size_t) {}
+		static void on_deallocate(size_t) {}
+		static void on_reallocate(size_t) {}
+		static void on_copy(size_t) {}
+		static void on_move(size_t) {}
+		static void on_size(size_t) {}
+	};
+
+	// 一个Tag的计数器. 计数用relaxed原子操作, 不同线程里的同名容器可以同时累加
+	struct instrument_counters {
+		const char* name;
+		std::atomic<size_t> allocations;
+		std::atomic<size_t> deallocations;
+		std::atomic<size_t> bytes_allocated;
+		std::atomic<size_t> bytes_deallocated;
+		std::atomic<size_t> reallocations;
+		std::atomic<size_t> bytes_copied;     // 扩容时搬动的字节数
+		std::atomic<size_t> copies;
+		std::atomic<size_t> moves;
+		std::atomic<size_t> max_size;
+		instrument_counters* next;
+
+		// 构造时登记到instrument_registry
+		explicit instrument_counters(const char* name);
+
+		void reset();
+
+	private:
+		instrument_counters(const instrument_counters&);
+		instrument_counters& operator=(const instrument_counters&);
+	};
+
+	class instrument_registry {
+	public:
+		// 按名字查找, 没有时返回0
+		static instrument_counters* find(const char* name);
+
+		// 每个Tag一行: 名字和各项计数
+		static void dump(FILE* f);
+		static bool dump(const char* path);
+
+		// 所有计数清零
+		static void reset();
+
+	private:
+		static void add(instrument_counters* c);
+		friend struct instrument_counters;
+	};
+
+	template <class Tag>
+	struct counted_instrument {
+		// 第一次用到时构造并登记, 早于main的全局容器也能用
+		static instrument_counters& counters() {
+			static instrument_counters c(Tag::tag());
+			return c;
+		}
+
+		static void on_allocate(size_t bytes) {
+			instrument_counters& c = counters();
+			c.allocations.fetch_add(1, std::memory_order_relaxed);
+			c.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+		}
+		static void on_deallocate(size_t bytes) {
+			instrument_counters& c = counters();
+			c.deallocations.fetch_add(1, std::memory_order_relaxed);
+			c.bytes_deallocated.fetch_add(bytes, std::memory_order_relaxed);
+		}
+		static void on_reallocate(size_t bytes) {
+			instrument_counters& c = counters();
+			c.reallocations.fetch_add(1, std::memory_order_relaxed);
+			c.bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+		}
+		static void on_copy(size_t n) {
+			counters().copies.fetch_add(n, std::memory_order_relaxed);
+		}
+		static void on_move(size_t n) {
+			counters().moves.fetch_add(n, std::memory_order_relaxed);
+		}
+		// 绝大多数时候不超过最大值, 只有一次读
+		static void on_size(size_t n) {
+			std::atomic<size_t>& m = counters().max_size;
+			size_t cur = m.load(std::memory_order_relaxed);
+			while(n > cur && !m.compare_exchange_weak(cur, n, std::memory_order_relaxed)) {}
+		}
+	};
+}
+
+// 定义一个名为id的Tag, 计数器也以id命名
+#define CCSTL_INSTRUMENT_TAG(id) \
+	struct id { static const char* tag() { return #id; } }
+#endif
@@ -2,8 +2,11 @@
 #define LIST_H
 #include "Allocator.h"
 #include "Trait.h"
+#include "Instrument.h"
 #include <initializer_list>
 #include <memory>
+#include <new>
+#include <utility>
 namespace CCSTL{
 
     template <class T>
@@ -59,23 +62,69 @@ namespace CCSTL{
         pointer operator->() const { return &(operator*()); }
     };
 
-    template <class T, class Alloc = allocator<T>>
-    class list {
+    // list本身不保存长度. 策略需要记录最大长度(Instrument::on_size)时才由这个基类计数,
+    // null_instrument的特化是空类, 作为基类不占空间, 也不产生任何代码
+    template <class Instrument>
+    struct __list_length {
+        size_t length;
+
+        __list_length(): length(0) {}
+
+        void added(size_t n) {
+            length += n;
+            Instrument::on_size(length);
+        }
+        void removed(size_t n) { length -= n; }
+        void reset() { length = 0; }
+        void swap_length(__list_length& x) { std::swap(length, x.length); }
+
+        // [first, last)从x移到这个list(splice), 同一个list内部移动时长度不变
+        template <class Iterator>
+        void moved_from(__list_length& x, Iterator first, Iterator last) {
+            if(&x == this)
+                return;
+            size_t n = 0;
+            for(; first != last; ++first)
+                ++n;
+            x.length -= n;
+            added(n);
+        }
+    };
+
+    template <>
+    struct __list_length<null_instrument> {
+        void added(size_t) {}
+        void removed(size_t) {}
+        void reset() {}
+        void swap_length(__list_length&) {}
+        template <class Iterator>
+        void moved_from(__list_length&, Iterator, Iterator) {}
+    };
+
+    // Instrument见Instrument.h, 默认的null_instrument没有任何开销
+    template <class T, class Alloc = allocator<T>, class Instrument = null_instrument>
+    class list: private __list_length<Instrument> {
     private:
-        typedef list_node<T> list_node;
-        typedef allocator<list_node> list_node_allocator;
+        typedef list_node<T> node_type;
+        typedef allocator<node_type> list_node_allocator;
     public:
         typedef T value_type;
         typedef value_type* pointer;
         typedef const value_type* const_pointer;
         typedef value_type& reference;
         typedef const value_type& const_reference;
-        typedef list_node* link_type;
+        typedef node_type* link_type;
         typedef size_t size_type;
         typedef ptrdiff_t difference_type;
     private:
-        link_type get_node() { return list_node_allocator::allocate(1); }
-        void put_node(link_type p) { list_node_allocator::deallocate(p, 1); }
+        link_type get_node() {
+            Instrument::on_allocate(sizeof(node_type));
+            return list_node_allocator::allocate(1);
+        }
+        void put_node(link_type p) {
+            Instrument::on_deallocate(sizeof(node_type));
+            list_node_allocator::deallocate(p, 1);
+        }
         link_type create_node(const T& x) {
             link_type p = get_node();
             list_node_allocator::construct(p, x);
@@ -137,8 +186,13 @@ namespace CCSTL{
             range_initialize(li.begin(), li.end());
         }
 
-        list(const list<T, Alloc>& x) {
-            range_initialize(x.begin(), x.end());
+        // const_iterator是list_iterator<const T>, 节点类型不同, 不能从const的x取迭代器, 直接沿节点复制
+        list(const list& x) {
+            empty_initialize();
+            size_type n = 0;
+            for(link_type p = x.node->next; p != x.node; p = p->next, ++n)
+                push_back(p->data);
+            Instrument::on_copy(n);
         }
         ~list() {
             clear();
@@ -150,12 +204,26 @@ namespace CCSTL{
         iterator end() { return node; }
         const_iterator end() const { return node; }
         bool empty() const { return node->next == node; }
+        // 没有记录长度, 与SGI的list一样要走一遍, O(n)
+        size_type size() const {
+            size_type n = 0;
+            for(link_type p = node->next; p != node; p = p->next)
+                ++n;
+            return n;
+        }
+
+        reference front() { return node->next->data; }
+        const_reference front() const { return node->next->data; }
+        reference back() { return node->prev->data; }
+        const_reference back() const { return node->prev->data; }
+
         iterator insert(iterator position, const T& x) {
             link_type tmp = create_node(x);
             tmp->next = position.node;
             tmp->prev = position.node->prev;
             position.node->prev->next = tmp;
             position.node->prev = tmp;
+            this->added(1);
             return tmp;
         }
 
@@ -166,14 +234,37 @@ namespace CCSTL{
         template <class InputIterator>
         void insert(iterator positionm, InputIterator first, InputIterator last);
 
+        // 在节点里直接构造元素, 不经过T的复制
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args) {
+            link_type tmp = get_node();
+            try {
+                new(static_cast<void*>(&tmp->data)) T(std::forward<Args>(args)...);
+            } catch(...) {
+                put_node(tmp);
+                throw;
+            }
+            tmp->next = position.node;
+            tmp->prev = position.node->prev;
+            position.node->prev->next = tmp;
+            position.node->prev = tmp;
+            this->added(1);
+            return tmp;
+        }
+
         void push_front(const T& x) { insert(begin(), x); }
         void push_back(const T& x) { insert(end(), x); }
+        template <class... Args>
+        void emplace_front(Args&&... args) { emplace(begin(), std::forward<Args>(args)...); }
+        template <class... Args>
+        void emplace_back(Args&&... args) { emplace(end(), std::forward<Args>(args)...); }
         iterator erase(iterator position) {
             link_type next_node = position.node->next;
             link_type prev_node = position.node->prev;
             prev_node->next = next_node;
             next_node->prev = prev_node;
             destroy_node(position.node);
+            this->removed(1);
             return iterator(next_node);
         }
 
@@ -190,42 +281,56 @@ namespace CCSTL{
         void unique();
         void clear();
 
-        void splice(iterator position, list&, iterator first, iterator last) {
-            if(first != last)
+        void splice(iterator position, list& x, iterator first, iterator last) {
+            if(first != last) {
+                this->moved_from(x, first, last);
                 transfer(position, first, last);
+            }
+        }
+
+        void swap(list& x) {
+            std::swap(node, x.node);
+            this->swap_length(x);
+        }
+
+        // 按顺序对每个元素调用f. 与复制构造函数一样直接沿节点走, const的list也可以用(见Serialize.h)
+        template <class F>
+        void for_each_element(F f) const {
+            for(link_type p = node->next; p != node; p = p->next)
+                f(static_cast<const T&>(p->data));
         }
 
     private:
         link_type node;
     };
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Instrument>
     template <class InputIterator>
-    void list<T, Alloc>::insert(iterator position,
-                                InputIterator first, InputIterator last) {
+    void list<T, Alloc, Instrument>::insert(iterator position,
+                                            InputIterator first, InputIterator last) {
         for(; first != last; ++first) {
             insert(position, *first);
         }
     }
 
-    template <class T, class Alloc>
-    void list<T, Alloc>::insert(iterator position, size_type n, const T& x) {
+    template <class T, class Alloc, class Instrument>
+    void list<T, Alloc, Instrument>::insert(iterator position, size_type n, const T& x) {
         for(; n>0; --n)
             insert(position, x);
     }
 
-    template <class T, class Alloc>
-    void list<T, Alloc>::insert(iterator position, int n, const T& x) {
+    template <class T, class Alloc, class Instrument>
+    void list<T, Alloc, Instrument>::insert(iterator position, int n, const T& x) {
         insert(position, (size_type)n, x);
     }
 
-    template <class T, class Alloc>
-    void list<T, Alloc>::insert(iterator position, long n, const T& x) {
+    template <class T, class Alloc, class Instrument>
+    void list<T, Alloc, Instrument>::insert(iterator position, long n, const T& x) {
         insert(position, (size_type)n, x);
     }
 
-    template <class T, class Alloc>
-    void list<T, Alloc>::remove(const T& value) {
+    template <class T, class Alloc, class Instrument>
+    void list<T, Alloc, Instrument>::remove(const T& value) {
         iterator first = begin();
         iterator last = end();
         while(first != last) {
@@ -237,8 +342,8 @@ namespace CCSTL{
         }
     }
 
-    template <class T, class Alloc>
-    void list<T, Alloc>::unique() {
+    template <class T, class Alloc, class Instrument>
+    void list<T, Alloc, Instrument>::unique() {
         iterator first = begin();
         iterator last = end();
         if(first == last)
@@ -253,8 +358,8 @@ namespace CCSTL{
         }
     }
 
-    template <class T, class Alloc>
-    void list<T, Alloc>::clear() {
+    template <class T, class Alloc, class Instrument>
+    void list<T, Alloc, Instrument>::clear() {
         link_type cur = node->next;
         while(cur != node) {
             link_type tmp = cur;
@@ -264,6 +369,7 @@ namespace CCSTL{
 
         node->prev = node;
         node->next = node;
+        this->reset();
     }
 }
 
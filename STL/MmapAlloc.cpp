@@ -0,0 +1,247 @@
+#include "MmapAlloc.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CCSTL {
+	namespace {
+		void throw_errno(const char* what) {
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+
+		int to_madvise(mapped_file::advice a) {
+			switch(a) {
+			case mapped_file::ADVISE_SEQUENTIAL: return MADV_SEQUENTIAL;
+			case mapped_file::ADVISE_RANDOM:     return MADV_RANDOM;
+			case mapped_file::ADVISE_WILLNEED:   return MADV_WILLNEED;
+			case mapped_file::ADVISE_DONTNEED:   return MADV_DONTNEED;
+			default:                             return MADV_NORMAL;
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------
+	// mmap_alloc
+	// ---------------------------------------------------------------
+	size_t mmap_alloc::page_size() {
+		static const size_t size = size_t(sysconf(_SC_PAGESIZE));
+		return size;
+	}
+
+	void* mmap_alloc::allocate(size_t n) {
+		if(n == 0)
+			return 0;
+		void* p = mmap(0, round_to_page(n), PROT_READ | PROT_WRITE,
+		               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(p == MAP_FAILED)
+			throw std::bad_alloc();
+		return p;
+	}
+
+	void mmap_alloc::deallocate(void* p, size_t n) {
+		if(p)
+			munmap(p, round_to_page(n));
+	}
+
+	void* mmap_alloc::reallocate(void* p, size_t old_sz, size_t new_sz) {
+		if(!p)
+			return allocate(new_sz);
+		if(new_sz == 0) {
+			deallocate(p, old_sz);
+			return 0;
+		}
+		void* q = mremap(p, round_to_page(old_sz), round_to_page(new_sz), MREMAP_MAYMOVE);
+		if(q == MAP_FAILED)
+			throw std::bad_alloc();
+		return q;
+	}
+
+	// ---------------------------------------------------------------
+	// huge_page_arena
+	// ---------------------------------------------------------------
+	char* huge_page_arena::cur = 0;
+	char* huge_page_arena::end = 0;
+	size_t huge_page_arena::region_size = huge_page_arena::huge_page_size;
+	size_t huge_page_arena::reserved_bytes = 0;
+
+	bool huge_page_arena::available() {
+		static int state = -1;
+		if(state < 0) {
+			state = 0;
+			FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+			if(f) {
+				char buf[128] = {0};
+				if(fgets(buf, sizeof(buf), f))
+					state = strstr(buf, "[never]") ? 0 : 1;
+				fclose(f);
+			}
+		}
+		return state == 1;
+	}
+
+	// 多映射一个大页的长度, 再把首尾不对齐的部分还回去
+	char* huge_page_arena::map_region(size_t size) {
+		size_t len = size + huge_page_size;
+		void* p = mmap(0, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(p == MAP_FAILED)
+			return 0;
+		char* raw = static_cast<char*>(p);
+		char* aligned = reinterpret_cast<char*>(
+			(reinterpret_cast<uintptr_t>(raw) + huge_page_size - 1) & ~(huge_page_size - 1));
+		if(aligned != raw)
+			munmap(raw, aligned - raw);
+		size_t tail = (raw + len) - (aligned + size);
+		if(tail)
+			munmap(aligned + size, tail);
+#ifdef MADV_HUGEPAGE
+		// 内核不支持时失败, 区域仍然可以按普通页使用
+		madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+		reserved_bytes += size;
+		return aligned;
+	}
+
+	void* huge_page_arena::allocate(size_t n) {
+		if(!available())
+			return malloc(n);
+		n = (n + 15) & ~size_t(15);
+		if(size_t(end - cur) < n) {
+			size_t size = region_size;
+			while(size < n)
+				size += huge_page_size;
+			char* region = map_region(size);
+			if(!region)
+				return malloc(n);
+			cur = region;
+			end = region + size;
+			if(region_size < (size_t(64) << 20))
+				region_size *= 2;
+		}
+		char* result = cur;
+		cur += n;
+		return result;
+	}
+
+	// ---------------------------------------------------------------
+	// mapped_file
+	// ---------------------------------------------------------------
+	void mapped_file::map(size_t size) {
+		length = size;
+		if(size == 0) {
+			addr = 0;
+			return;
+		}
+		int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+		addr = mmap(0, size, prot, MAP_SHARED, fd, 0);
+		if(addr == MAP_FAILED) {
+			addr = 0;
+			length = 0;
+			throw_errno("mmap");
+		}
+	}
+
+	void mapped_file::create(const char* path, size_t size) {
+		close();
+		fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if(fd < 0)
+			throw_errno("open");
+		writable = true;
+		if(ftruncate(fd, off_t(size)) != 0) {
+			int e = errno;
+			close();
+			throw std::system_error(e, std::generic_category(), "ftruncate");
+		}
+		try {
+			map(size);
+		} catch(...) {
+			close();
+			throw;
+		}
+	}
+
+	void mapped_file::open(const char* path, bool w) {
+		close();
+		fd = ::open(path, (w ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+		if(fd < 0)
+			throw_errno("open");
+		writable = w;
+		struct stat st;
+		if(fstat(fd, &st) != 0) {
+			int e = errno;
+			close();
+			throw std::system_error(e, std::generic_category(), "fstat");
+		}
+		try {
+			map(size_t(st.st_size));
+		} catch(...) {
+			close();
+			throw;
+		}
+	}
+
+	void mapped_file::close() {
+		if(addr)
+			munmap(addr, length);
+		if(fd >= 0)
+			::close(fd);
+		fd = -1;
+		addr = 0;
+		length = 0;
+		writable = false;
+	}
+
+	void mapped_file::resize(size_t size) {
+		if(size == length)
+			return;
+		if(ftruncate(fd, off_t(size)) != 0)
+			throw_errno("ftruncate");
+		if(!addr) {
+			map(size);
+			return;
+		}
+		if(size == 0) {
+			munmap(addr, length);
+			addr = 0;
+			length = 0;
+			return;
+		}
+		void* p = mremap(addr, length, size, MREMAP_MAYMOVE);
+		if(p == MAP_FAILED)
+			throw_errno("mremap");
+		addr = p;
+		length = size;
+	}
+
+	void mapped_file::sync(bool async) {
+		sync(0, length, async);
+	}
+
+	void mapped_file::sync(size_t offset, size_t len, bool async) {
+		if(!addr || len == 0)
+			return;
+		// msync要求起始地址按页对齐
+		size_t begin = offset & ~(mmap_alloc::page_size() - 1);
+		if(msync(data() + begin, len + (offset - begin), async ? MS_ASYNC : MS_SYNC) != 0)
+			throw_errno("msync");
+	}
+
+	void mapped_file::advise(advice a) {
+		advise(a, 0, length);
+	}
+
+	void mapped_file::advise(advice a, size_t offset, size_t len) {
+		if(!addr || len == 0)
+			return;
+		size_t begin = offset & ~(mmap_alloc::page_size() - 1);
+		if(madvise(data() + begin, len + (offset - begin), to_madvise(a)) != 0)
+			throw_errno("madvise");
+	}
+}
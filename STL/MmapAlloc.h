@@ -0,0 +1,102 @@
+#ifndef MMAPALLOC_H
+#define MMAPALLOC_H
+#include <cstddef>
+#include <utility>
+
+namespace CCSTL {
+	// 直接向内核申请匿名映射的分配器, 接口与alloc相同
+	// 适合很大的数组: 空间按页分配, 归还时立即还给系统,
+	// reallocate用mremap完成, 不需要复制数据
+	class mmap_alloc {
+	public:
+		static void* allocate(size_t n);
+		static void deallocate(void* p, size_t n);
+		static void* reallocate(void* p, size_t old_sz, size_t new_sz);
+
+		static size_t page_size();
+		static size_t round_to_page(size_t n) {
+			return (n + page_size() - 1) & ~(page_size() - 1);
+		}
+	};
+
+	// 内存池的大页chunk来源, 可用alloc::set_chunk_provider(huge_page_arena::allocate)安装
+	//
+	// 每次向系统映射2MiB对齐的一大段区域, 用madvise(MADV_HUGEPAGE)请求透明大页,
+	// 再从中依次切出chunk. 池子里的小对象于是集中在少数几个2MiB的页上,
+	// 链表、散列表这类随机访问的容器TLB缺失会少很多.
+	// 区域的大小从2MiB起每次翻倍, 最大64MiB; 区域尾部放不下下一个chunk的部分直接丢弃,
+	// 只占地址空间, 不会被访问, 也就不占物理内存.
+	// 系统关闭了THP(enabled为[never])或映射失败时退回malloc. 与alloc一样不是线程安全的
+	class huge_page_arena {
+	public:
+		static const size_t huge_page_size = size_t(2) << 20;
+
+		static void* allocate(size_t n);
+		// 读取/sys/kernel/mm/transparent_hugepage/enabled, 只读一次
+		static bool available();
+		// 已经映射的字节数
+		static size_t reserved() { return reserved_bytes; }
+
+	private:
+		static char* map_region(size_t size);
+
+		static char* cur;
+		static char* end;
+		static size_t region_size;
+		static size_t reserved_bytes;
+	};
+
+	// 文件映射, 是mapped_vector的存储
+	// 所有失败都抛出std::system_error
+	class mapped_file {
+	public:
+		// 对应madvise的几种提示
+		enum advice {
+			ADVISE_NORMAL,
+			ADVISE_SEQUENTIAL,
+			ADVISE_RANDOM,
+			ADVISE_WILLNEED,
+			ADVISE_DONTNEED
+		};
+
+		mapped_file(): fd(-1), addr(0), length(0), writable(false) {}
+		~mapped_file() { close(); }
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		// 新建(或截断)文件并映射size字节
+		void create(const char* path, size_t size);
+		// 映射已有文件的全部内容, 不读取任何数据
+		void open(const char* path, bool writable = true);
+		void close();
+		void swap(mapped_file& f) {
+			std::swap(fd, f.fd);
+			std::swap(addr, f.addr);
+			std::swap(length, f.length);
+			std::swap(writable, f.writable);
+		}
+
+		// ftruncate + mremap, 映射的地址可能改变
+		void resize(size_t size);
+		// 把脏页写回文件, async为true时不等待写完
+		void sync(bool async = false);
+		void sync(size_t offset, size_t len, bool async = false);
+		void advise(advice a);
+		void advise(advice a, size_t offset, size_t len);
+
+		bool is_open() const { return fd >= 0; }
+		bool is_writable() const { return writable; }
+		char* data() const { return static_cast<char*>(addr); }
+		size_t size() const { return length; }
+
+	private:
+		void map(size_t size);
+
+		int fd;
+		void* addr;
+		size_t length;
+		bool writable;
+	};
+}
+#endif
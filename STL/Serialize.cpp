@@ -0,0 +1,192 @@
+#include "Serialize.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <unistd.h>
+
+namespace CCSTL {
+namespace serial {
+	namespace {
+		void throw_errno(const char* what) {
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+
+		bool host_big_endian() {
+			const uint16_t one = 1;
+			unsigned char b;
+			memcpy(&b, &one, 1);
+			return b == 0;
+		}
+
+		// 头部的字段按字节拼出小端, 与机器的字节序无关
+		void put_le(unsigned char* p, uint64_t v, int bytes) {
+			for(int i = 0; i < bytes; ++i)
+				p[i] = (unsigned char)(v >> (8 * i));
+		}
+
+		uint64_t get_le(const unsigned char* p, int bytes) {
+			uint64_t v = 0;
+			for(int i = 0; i < bytes; ++i)
+				v |= uint64_t(p[i]) << (8 * i);
+			return v;
+		}
+
+		const unsigned char magic[4] = {'C', 'C', 'S', 'R'};
+	}
+
+	size_t encode_header(unsigned char* out, container_kind kind, size_t elem_size, size_t elem_align, uint64_t count) {
+		size_t size = (base_header_size + elem_align - 1) / elem_align * elem_align;
+		memset(out, 0, size);
+		memcpy(out, magic, 4);
+		put_le(out + 4, format_version, 2);
+		out[6] = (unsigned char)kind;
+		out[7] = host_big_endian() ? flag_big_endian : 0;
+		put_le(out + 8, elem_size, 4);
+		put_le(out + 12, size, 4);
+		put_le(out + 16, count, 8);
+		put_le(out + 24, count * elem_size, 8);
+		return size;
+	}
+
+	header decode_header(const void* buf, size_t len) {
+		const unsigned char* p = static_cast<const unsigned char*>(buf);
+		if(len < base_header_size)
+			throw serialize_error("serialized header truncated");
+		if(memcmp(p, magic, 4) != 0)
+			throw serialize_error("bad serialization magic");
+		header h;
+		h.version = uint16_t(get_le(p + 4, 2));
+		h.kind = p[6];
+		h.flags = p[7];
+		h.elem_size = uint32_t(get_le(p + 8, 4));
+		h.header_size = uint32_t(get_le(p + 12, 4));
+		h.count = get_le(p + 16, 8);
+		h.payload_bytes = get_le(p + 24, 8);
+		if(h.version == 0 || h.version > format_version)
+			throw serialize_error("unsupported serialization version");
+		if(h.header_size < base_header_size || h.header_size > max_header_size)
+			throw serialize_error("bad serialization header size");
+		if(len < h.header_size)
+			throw serialize_error("serialized header truncated");
+		return h;
+	}
+
+	void __check_header(const header& h, size_t elem_size) {
+		if(h.elem_size != elem_size)
+			throw serialize_error("serialized element size mismatch");
+		if(((h.flags & flag_big_endian) != 0) != host_big_endian())
+			throw serialize_error("serialized data has foreign byte order");
+		// 防止count * elem_size溢出后绕过长度检查
+		if(elem_size != 0 && h.count > UINT64_MAX / elem_size)
+			throw serialize_error("serialized element count overflow");
+		if(h.payload_bytes != h.count * elem_size)
+			throw serialize_error("serialized payload size mismatch");
+		if(h.payload_bytes > SIZE_MAX)
+			throw serialize_error("serialized payload too large");
+	}
+
+	void read_exact(int fd, void* p, size_t n) {
+		char* dst = static_cast<char*>(p);
+		while(n) {
+			ssize_t r = ::read(fd, dst, n > size_t(SSIZE_MAX) ? size_t(SSIZE_MAX) : n);
+			if(r < 0) {
+				if(errno == EINTR)
+					continue;
+				throw_errno("read");
+			}
+			if(r == 0)
+				throw serialize_error("unexpected end of serialized data");
+			dst += r;
+			n -= size_t(r);
+		}
+	}
+
+	header read_header(int fd) {
+		// 先读固定的部分, 得到头部的长度后再读对齐的填充
+		unsigned char buf[max_header_size];
+		read_exact(fd, buf, base_header_size);
+		size_t size = size_t(get_le(buf + 12, 4));
+		if(size <= base_header_size || size > max_header_size)
+			return decode_header(buf, base_header_size);
+		read_exact(fd, buf + base_header_size, size - base_header_size);
+		return decode_header(buf, size);
+	}
+
+	// ---------------------------------------------------------------
+	// writer
+	// ---------------------------------------------------------------
+	writer::writer(int fd): fd(fd), niov(0), stage(0), stage_used(0), written(0) {}
+
+	writer::~writer() {
+		free(stage);
+	}
+
+	void writer::gather(const void* p, size_t n) {
+		if(n == 0)
+			return;
+		if(niov == max_iov)
+			flush();
+		iov[niov].iov_base = const_cast<void*>(p);
+		iov[niov].iov_len = n;
+		++niov;
+	}
+
+	void writer::copy(const void* p, size_t n) {
+		const unsigned char* src = static_cast<const unsigned char*>(p);
+		while(n) {
+			if(!stage) {
+				stage = static_cast<unsigned char*>(malloc(stage_size));
+				if(!stage)
+					throw std::bad_alloc();
+			}
+			// 先腾出位置, 下面的gather就不会在复制之后再flush
+			if(stage_used == stage_size || niov == max_iov)
+				flush();
+			// 暂存区里还没交给iov的部分
+			size_t take = stage_size - stage_used;
+			if(take > n)
+				take = n;
+			unsigned char* dst = stage + stage_used;
+			memcpy(dst, src, take);
+			// 紧接着上一段暂存的内容时合并成一个iovec
+			if(niov && static_cast<unsigned char*>(iov[niov - 1].iov_base) + iov[niov - 1].iov_len == dst)
+				iov[niov - 1].iov_len += take;
+			else
+				gather(dst, take);
+			stage_used += take;
+			src += take;
+			n -= take;
+		}
+	}
+
+	void writer::flush() {
+		struct iovec* v = iov;
+		int left = niov;
+		while(left) {
+			ssize_t r = ::writev(fd, v, left < IOV_MAX ? left : IOV_MAX);
+			if(r < 0) {
+				if(errno == EINTR)
+					continue;
+				throw_errno("writev");
+			}
+			written += uint64_t(r);
+			// 部分写入: 跳过写完的iovec, 调整写了一半的那个
+			size_t done = size_t(r);
+			while(left && done >= v->iov_len) {
+				done -= v->iov_len;
+				++v;
+				--left;
+			}
+			if(left) {
+				v->iov_base = static_cast<char*>(v->iov_base) + done;
+				v->iov_len -= done;
+			}
+		}
+		niov = 0;
+		stage_used = 0;
+	}
+}
+}
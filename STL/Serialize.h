@@ -0,0 +1,245 @@
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+#include <cstddef>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <sys/uio.h>
+#include "List.h"
+#include "deque.h"
+#include "vector.h"
+
+// 可以平凡复制的元素组成的vector/deque/list的二进制序列化
+//
+// 格式: 一个头部, 紧接着是全部元素按内存原样排列的负载. 头部的字段都是小端:
+//   0  magic        'C' 'C' 'S' 'R'
+//   4  version      u16, 当前为1; 读取时拒绝更高的版本
+//   6  kind         u8, 写出的容器(kind_vector/kind_deque/kind_list), 只作记录
+//   7  flags        u8, flag_big_endian表示负载是大端机器写出的
+//   8  elem_size    u32, sizeof(T)
+//   12 header_size  u32, 负载的偏移, 32向上取整到alignof(T)
+//   16 count        u64, 元素个数
+//   24 payload      u64, 负载字节数 = count * elem_size
+// 三种容器的负载格式相同, 可以互相读取. 负载按写出机器的字节序存放, 字节序不同时读取失败.
+//
+// 写出都经过writer, 尽量用一次writev:
+//   vector  头部和整个缓冲区两段
+//   deque   头部加上每个缓冲区一段(deque::for_each_segment), 不经过迭代器
+//   list    先数出元素个数写进头部, 再把元素逐个复制进暂存区, 攒满一次写出
+// 读取有两种: read把数据读进容器; view直接在mmap的文件或收到的报文上校验头部,
+// 返回指向其中元素的vector_view, 不复制任何数据.
+//
+// I/O失败抛出std::system_error, 数据不合法(magic/版本/元素大小/长度/对齐)抛出serialize_error
+namespace CCSTL {
+namespace serial {
+	class serialize_error: public std::runtime_error {
+	public:
+		explicit serialize_error(const char* what): std::runtime_error(what) {}
+	};
+
+	enum container_kind {
+		kind_vector = 1,
+		kind_deque  = 2,
+		kind_list   = 3
+	};
+
+	enum {
+		flag_big_endian = 1
+	};
+
+	static const uint16_t format_version = 1;
+	static const size_t base_header_size = 32;
+	// 头部最多按64字节对齐
+	static const size_t max_header_size = 64;
+
+	struct header {
+		uint16_t version;
+		uint8_t kind;
+		uint8_t flags;
+		uint32_t elem_size;
+		uint32_t header_size;
+		uint64_t count;
+		uint64_t payload_bytes;
+
+		// 整条记录的字节数, 连续存放多条记录时用来找到下一条
+		uint64_t record_size() const { return header_size + payload_bytes; }
+	};
+
+	// 把头部编码进out(至少max_header_size字节), 返回头部的字节数
+	size_t encode_header(unsigned char* out, container_kind kind, size_t elem_size, size_t elem_align, uint64_t count);
+	// 从内存中解析头部, 检查magic、版本和长度, 不检查负载是否完整
+	header decode_header(const void* buf, size_t len);
+	// 从fd读出头部(包括对齐的填充)
+	header read_header(int fd);
+	// 从fd读满n字节, 提前结束时抛出serialize_error
+	void read_exact(int fd, void* p, size_t n);
+
+	// 收集要写出的内存段, 满了或flush时用writev写出, 处理部分写入和EINTR
+	class writer {
+	public:
+		explicit writer(int fd);
+		~writer();
+
+		writer(const writer&) = delete;
+		writer& operator=(const writer&) = delete;
+
+		// 只记录地址, 不复制; 在flush之前p必须保持有效
+		void gather(const void* p, size_t n);
+		// 复制进暂存区, 用于零散的小块; 暂存区满时自动flush
+		void copy(const void* p, size_t n);
+		// 写出全部收集的内容. 析构函数不会flush(那里不能抛异常)
+		void flush();
+
+		uint64_t bytes_written() const { return written; }
+
+	private:
+		static const int max_iov = 256;
+		static const size_t stage_size = 64 * 1024;
+
+		int fd;
+		struct iovec iov[max_iov];
+		int niov;
+		unsigned char* stage;
+		size_t stage_used;
+		uint64_t written;
+	};
+
+	// 元素的要求和头部的检查
+	template <class T>
+	struct __check_element {
+		static_assert(std::is_trivially_copyable<T>::value, "serialized elements must be trivially copyable");
+		static_assert(alignof(T) <= max_header_size, "element alignment too large for the header");
+	};
+
+	void __check_header(const header& h, size_t elem_size);
+
+	template <class T>
+	inline size_t __encode_header(unsigned char* out, container_kind kind, uint64_t count) {
+		__check_element<T> check;
+		(void)check;
+		return encode_header(out, kind, sizeof(T), alignof(T), count);
+	}
+
+	// 写出
+	template <class T, class Alloc, class Instrument>
+	void write(int fd, const vector<T, Alloc, Instrument>& v) {
+		unsigned char h[max_header_size];
+		writer w(fd);
+		w.gather(h, __encode_header<T>(h, kind_vector, v.size()));
+		if(!v.empty())
+			w.gather(v.begin(), v.size() * sizeof(T));
+		w.flush();
+	}
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void write(int fd, const deque<T, Alloc, BufSiz, Instrument>& d) {
+		unsigned char h[max_header_size];
+		writer w(fd);
+		w.gather(h, __encode_header<T>(h, kind_deque, d.size()));
+		d.for_each_segment([&w](const T* p, size_t n) { w.gather(p, n * sizeof(T)); });
+		w.flush();
+	}
+
+	template <class T, class Alloc, class Instrument>
+	void write(int fd, const list<T, Alloc, Instrument>& l) {
+		// list没有保存长度, 先数一遍
+		uint64_t count = 0;
+		l.for_each_element([&count](const T&) { ++count; });
+		unsigned char h[max_header_size];
+		writer w(fd);
+		w.copy(h, __encode_header<T>(h, kind_list, count));
+		l.for_each_element([&w](const T& x) { w.copy(&x, sizeof(T)); });
+		w.flush();
+	}
+
+	// 读取, 成功后替换掉容器原有的内容; 失败时容器不变
+	template <class T, class Alloc, class Instrument>
+	void read(int fd, vector<T, Alloc, Instrument>& v) {
+		__check_element<T> check;
+		(void)check;
+		header h = read_header(fd);
+		__check_header(h, sizeof(T));
+		vector<T, Alloc, Instrument> tmp;
+		tmp.resize(size_t(h.count), T());
+		if(h.count)
+			read_exact(fd, tmp.begin(), size_t(h.payload_bytes));
+		v.swap(tmp);
+	}
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void read(int fd, deque<T, Alloc, BufSiz, Instrument>& d) {
+		__check_element<T> check;
+		(void)check;
+		header h = read_header(fd);
+		__check_header(h, sizeof(T));
+		// 先按个数建好缓冲区, 再逐段读进去
+		deque<T, Alloc, BufSiz, Instrument> tmp(size_t(h.count));
+		tmp.for_each_segment([fd](T* p, size_t n) { read_exact(fd, p, n * sizeof(T)); });
+		d.swap(tmp);
+	}
+
+	template <class T, class Alloc, class Instrument>
+	void read(int fd, list<T, Alloc, Instrument>& l) {
+		__check_element<T> check;
+		(void)check;
+		header h = read_header(fd);
+		__check_header(h, sizeof(T));
+		list<T, Alloc, Instrument> tmp;
+		// 成块读进暂存区再逐个插入
+		const size_t batch = 64 * 1024 / sizeof(T) + 1;
+		vector<T> stage(batch, T());
+		for(uint64_t left = h.count; left != 0; ) {
+			size_t n = left < batch ? size_t(left) : batch;
+			read_exact(fd, stage.begin(), n * sizeof(T));
+			for(size_t i = 0; i < n; ++i)
+				tmp.push_back(stage[i]);
+			left -= n;
+		}
+		l.swap(tmp);
+	}
+
+	// 序列化数据上的只读视图, 元素就在原来的缓冲区里, 缓冲区必须比视图活得久
+	template <class T>
+	class vector_view {
+	public:
+		typedef T value_type;
+		typedef const T* const_iterator;
+		typedef const_iterator iterator;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+
+		vector_view(): ptr(0), n(0) {}
+		vector_view(const T* p, size_type count): ptr(p), n(count) {}
+
+		const_iterator begin() const { return ptr; }
+		const_iterator end() const { return ptr + n; }
+		const T* data() const { return ptr; }
+		size_type size() const { return n; }
+		bool empty() const { return n == 0; }
+		const_reference operator[](size_type i) const { return ptr[i]; }
+		const_reference front() const { return ptr[0]; }
+		const_reference back() const { return ptr[n - 1]; }
+
+	private:
+		const T* ptr;
+		size_type n;
+	};
+
+	// buf指向一条完整的记录(可以是mmap的文件或收到的报文), 校验后直接返回其中的元素.
+	// 负载必须按alignof(T)对齐: 记录放在页或缓冲区的开头时总是满足, 头部的长度保证了这一点
+	template <class T>
+	vector_view<T> view(const void* buf, size_t len) {
+		__check_element<T> check;
+		(void)check;
+		header h = decode_header(buf, len);
+		__check_header(h, sizeof(T));
+		if(len - h.header_size < h.payload_bytes)
+			throw serialize_error("serialized payload truncated");
+		const unsigned char* p = static_cast<const unsigned char*>(buf) + h.header_size;
+		if(reinterpret_cast<uintptr_t>(p) % alignof(T) != 0)
+			throw serialize_error("serialized payload misaligned for element type");
+		return vector_view<T>(reinterpret_cast<const T*>(p), size_t(h.count));
+	}
+}
+}
+#endif
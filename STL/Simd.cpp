@@ -0,0 +1,754 @@
+#include "Simd.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CCSTL_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#define CCSTL_AVX2 __attribute__((target("avx2")))
+
+namespace CCSTL {
+namespace simd {
+namespace {
+	template <class U>
+	inline U load(const unsigned char* p) {
+		U v;
+		memcpy(&v, p, sizeof(U));
+		return v;
+	}
+
+	// ---------------------------------------------------------------
+	// scalar
+	// ---------------------------------------------------------------
+	template <class U>
+	size_t scalar_find(const void* p, size_t n, U value) {
+		const unsigned char* s = static_cast<const unsigned char*>(p);
+		for(size_t i = 0; i < n; ++i) {
+			if(load<U>(s + i * sizeof(U)) == value)
+				return i;
+		}
+		return n;
+	}
+
+	template <class U>
+	size_t scalar_count(const void* p, size_t n, U value) {
+		const unsigned char* s = static_cast<const unsigned char*>(p);
+		size_t c = 0;
+		for(size_t i = 0; i < n; ++i)
+			c += load<U>(s + i * sizeof(U)) == value;
+		return c;
+	}
+
+	size_t scalar_mismatch(const void* a, const void* b, size_t n) {
+		const unsigned char* x = static_cast<const unsigned char*>(a);
+		const unsigned char* y = static_cast<const unsigned char*>(b);
+		size_t i = 0;
+		for(; i + 8 <= n; i += 8) {
+			if(load<uint64_t>(x + i) != load<uint64_t>(y + i))
+				break;
+		}
+		for(; i < n; ++i) {
+			if(x[i] != y[i])
+				return i;
+		}
+		return n;
+	}
+
+	// 子串查找, 调用者保证 2 <= m <= n. 用memchr找首字节再比较其余部分
+	size_t scalar_find_bytes(const void* h, size_t n, const void* nd, size_t m) {
+		const unsigned char* s = static_cast<const unsigned char*>(h);
+		const unsigned char* t = static_cast<const unsigned char*>(nd);
+		const unsigned char* p = s;
+		const unsigned char* last = s + (n - m);
+		while(p <= last) {
+			p = static_cast<const unsigned char*>(memchr(p, t[0], last - p + 1));
+			if(p == 0)
+				return n;
+			if(memcmp(p + 1, t + 1, m - 1) == 0)
+				return p - s;
+			++p;
+		}
+		return n;
+	}
+
+	template <class T>
+	size_t scalar_min_index(const T* p, size_t n) {
+		size_t r = 0;
+		for(size_t i = 1; i < n; ++i) {
+			if(p[i] < p[r])
+				r = i;
+		}
+		return r;
+	}
+
+	template <class T>
+	size_t scalar_max_index(const T* p, size_t n) {
+		size_t r = 0;
+		for(size_t i = 1; i < n; ++i) {
+			if(p[r] < p[i])
+				r = i;
+		}
+		return r;
+	}
+
+	template <class T>
+	T scalar_sum(const T* p, size_t n) {
+		T s = 0;
+		for(size_t i = 0; i < n; ++i)
+			s += p[i];
+		return s;
+	}
+
+	// 位图的按字运算. op是函数对象, 编译器能把它内联进循环
+	struct and_op { uint64_t operator()(uint64_t a, uint64_t b) const { return a & b; } };
+	struct or_op { uint64_t operator()(uint64_t a, uint64_t b) const { return a | b; } };
+	struct xor_op { uint64_t operator()(uint64_t a, uint64_t b) const { return a ^ b; } };
+	struct andnot_op { uint64_t operator()(uint64_t a, uint64_t b) const { return a & ~b; } };
+
+	template <class Op>
+	void scalar_words(uint64_t* dst, const uint64_t* src, size_t n) {
+		Op op;
+		for(size_t i = 0; i < n; ++i)
+			dst[i] = op(dst[i], src[i]);
+	}
+
+	// 不假定有popcnt指令, 用逐步折半相加的办法
+	inline size_t popcount64(uint64_t x) {
+		x = x - ((x >> 1) & 0x5555555555555555ull);
+		x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return size_t((x * 0x0101010101010101ull) >> 56);
+	}
+
+	size_t scalar_popcount(const uint64_t* p, size_t n) {
+		size_t c = 0;
+		for(size_t i = 0; i < n; ++i)
+			c += popcount64(p[i]);
+		return c;
+	}
+
+	size_t scalar_find_nonzero(const uint64_t* p, size_t n) {
+		for(size_t i = 0; i < n; ++i) {
+			if(p[i])
+				return i;
+		}
+		return n;
+	}
+
+#ifdef CCSTL_SIMD_X86
+	// ---------------------------------------------------------------
+	// SSE2 (x86_64上总是可用)
+	// ---------------------------------------------------------------
+	template <size_t W> struct sse2_ops;
+
+	template <> struct sse2_ops<1> {
+		static __m128i set1(uint8_t v) { return _mm_set1_epi8(char(v)); }
+		static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+	};
+	template <> struct sse2_ops<2> {
+		static __m128i set1(uint16_t v) { return _mm_set1_epi16(short(v)); }
+		static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+	};
+	template <> struct sse2_ops<4> {
+		static __m128i set1(uint32_t v) { return _mm_set1_epi32(int(v)); }
+		static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+	};
+	template <> struct sse2_ops<8> {
+		static __m128i set1(uint64_t v) { return _mm_set1_epi64x((long long)v); }
+		// SSE2没有64位比较, 用两个32位比较的结果相与
+		static __m128i eq(__m128i a, __m128i b) {
+			__m128i c = _mm_cmpeq_epi32(a, b);
+			return _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+	};
+
+	template <class U>
+	size_t sse2_find(const void* p, size_t n, U value) {
+		const unsigned char* s = static_cast<const unsigned char*>(p);
+		const size_t per = 16 / sizeof(U);
+		const __m128i v = sse2_ops<sizeof(U)>::set1(value);
+		size_t i = 0;
+		for(; i + per <= n; i += per) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(s + i * sizeof(U)));
+			int mask = _mm_movemask_epi8(sse2_ops<sizeof(U)>::eq(x, v));
+			if(mask)
+				return i + __builtin_ctz(mask) / sizeof(U);
+		}
+		return i + scalar_find(s + i * sizeof(U), n - i, value);
+	}
+
+	// 相等的lane在比较结果中每个字节都是0xFF, 按字节减去它就是按字节计数,
+	// 每255个向量用_mm_sad_epu8把字节计数汇总一次, 避免溢出; 最后除以元素宽度
+	template <class U>
+	size_t sse2_count(const void* p, size_t n, U value) {
+		const unsigned char* s = static_cast<const unsigned char*>(p);
+		const size_t per = 16 / sizeof(U);
+		const __m128i v = sse2_ops<sizeof(U)>::set1(value);
+		const __m128i zero = _mm_setzero_si128();
+		__m128i total = zero;
+		size_t i = 0;
+		while(i + per <= n) {
+			__m128i acc = zero;
+			for(int k = 0; k < 255 && i + per <= n; ++k, i += per) {
+				__m128i x = _mm_loadu_si128((const __m128i*)(s + i * sizeof(U)));
+				acc = _mm_sub_epi8(acc, sse2_ops<sizeof(U)>::eq(x, v));
+			}
+			total = _mm_add_epi64(total, _mm_sad_epu8(acc, zero));
+		}
+		uint64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, total);
+		return (lanes[0] + lanes[1]) / sizeof(U) + scalar_count(s + i * sizeof(U), n - i, value);
+	}
+
+	size_t sse2_mismatch(const void* a, const void* b, size_t n) {
+		const unsigned char* x = static_cast<const unsigned char*>(a);
+		const unsigned char* y = static_cast<const unsigned char*>(b);
+		size_t i = 0;
+		for(; i + 16 <= n; i += 16) {
+			__m128i va = _mm_loadu_si128((const __m128i*)(x + i));
+			__m128i vb = _mm_loadu_si128((const __m128i*)(y + i));
+			unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+			if(mask != 0xFFFF)
+				return i + __builtin_ctz(~mask);
+		}
+		return i + scalar_mismatch(x + i, y + i, n - i);
+	}
+
+	// 一次检查16个起点: 首字节和末字节都相等的位置才去比较中间部分,
+	// 自然语言文本里两端同时相等的很少, 大部分起点不用逐个比较
+	size_t sse2_find_bytes(const void* h, size_t n, const void* nd, size_t m) {
+		const unsigned char* s = static_cast<const unsigned char*>(h);
+		const unsigned char* t = static_cast<const unsigned char*>(nd);
+		const __m128i first = _mm_set1_epi8(char(t[0]));
+		const __m128i last = _mm_set1_epi8(char(t[m - 1]));
+		size_t i = 0;
+		for(; i + m - 1 + 16 <= n; i += 16) {
+			__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + i)), first);
+			__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + i + m - 1)), last);
+			unsigned mask = _mm_movemask_epi8(_mm_and_si128(a, b));
+			while(mask) {
+				size_t k = i + __builtin_ctz(mask);
+				if(memcmp(s + k + 1, t + 1, m - 2) == 0)
+					return k;
+				mask &= mask - 1;
+			}
+		}
+		size_t r = scalar_find_bytes(s + i, n - i, t, m);
+		return r == n - i ? n : i + r;
+	}
+
+	// SSE2没有32位的min/max, 用比较+选择模拟; 无符号数先翻转符号位
+	template <bool Max>
+	inline __m128i sse2_select_i32(__m128i a, __m128i b) {
+		__m128i gt = Max ? _mm_cmpgt_epi32(b, a) : _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+	}
+
+	template <bool Max, bool Unsigned>
+	size_t sse2_extreme_index(const uint32_t* p, size_t n) {
+		if(n < 8)
+			return Max ? (Unsigned ? scalar_max_index(p, n)
+			                       : scalar_max_index((const int32_t*)p, n))
+			           : (Unsigned ? scalar_min_index(p, n)
+			                       : scalar_min_index((const int32_t*)p, n));
+		const __m128i flip = _mm_set1_epi32(Unsigned ? int(0x80000000u) : 0);
+		__m128i acc = _mm_xor_si128(_mm_loadu_si128((const __m128i*)p), flip);
+		size_t i = 4;
+		for(; i + 4 <= n; i += 4) {
+			__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p + i)), flip);
+			acc = sse2_select_i32<Max>(acc, x);
+		}
+		int32_t lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, acc);
+		int32_t best = lanes[0];
+		for(int k = 1; k < 4; ++k) {
+			if(Max ? lanes[k] > best : lanes[k] < best)
+				best = lanes[k];
+		}
+		for(; i < n; ++i) {
+			int32_t x = int32_t(p[i] ^ (Unsigned ? 0x80000000u : 0u));
+			if(Max ? x > best : x < best)
+				best = x;
+		}
+		return sse2_find<uint32_t>(p, n, uint32_t(best) ^ (Unsigned ? 0x80000000u : 0u));
+	}
+
+	uint32_t sse2_sum_u32(const uint32_t* p, size_t n) {
+		__m128i acc = _mm_setzero_si128();
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4)
+			acc = _mm_add_epi32(acc, _mm_loadu_si128((const __m128i*)(p + i)));
+		uint32_t lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, acc);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_sum(p + i, n - i);
+	}
+
+	uint64_t sse2_sum_u64(const uint64_t* p, size_t n) {
+		__m128i acc = _mm_setzero_si128();
+		size_t i = 0;
+		for(; i + 2 <= n; i += 2)
+			acc = _mm_add_epi64(acc, _mm_loadu_si128((const __m128i*)(p + i)));
+		uint64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, acc);
+		return lanes[0] + lanes[1] + scalar_sum(p + i, n - i);
+	}
+
+	template <class Op> struct sse2_word_op;
+	template <> struct sse2_word_op<and_op> {
+		static __m128i apply(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+	};
+	template <> struct sse2_word_op<or_op> {
+		static __m128i apply(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+	};
+	template <> struct sse2_word_op<xor_op> {
+		static __m128i apply(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+	};
+	template <> struct sse2_word_op<andnot_op> {
+		// _mm_andnot_si128(a, b)是~a & b
+		static __m128i apply(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+	};
+
+	template <class Op>
+	void sse2_words(uint64_t* dst, const uint64_t* src, size_t n) {
+		size_t i = 0;
+		for(; i + 2 <= n; i += 2) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+			_mm_storeu_si128((__m128i*)(dst + i), sse2_word_op<Op>::apply(a, b));
+		}
+		scalar_words<Op>(dst + i, src + i, n - i);
+	}
+
+	// 与popcount64相同的折半相加, 两个字并行, 最后用_mm_sad_epu8把字节加起来
+	size_t sse2_popcount(const uint64_t* p, size_t n) {
+		const __m128i m1 = _mm_set1_epi8(0x55);
+		const __m128i m2 = _mm_set1_epi8(0x33);
+		const __m128i m4 = _mm_set1_epi8(0x0F);
+		const __m128i zero = _mm_setzero_si128();
+		__m128i total = zero;
+		size_t i = 0;
+		for(; i + 2 <= n; i += 2) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+			x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), m1));
+			x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi16(x, 2), m2));
+			x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), m4);
+			total = _mm_add_epi64(total, _mm_sad_epu8(x, zero));
+		}
+		uint64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, total);
+		return size_t(lanes[0] + lanes[1]) + scalar_popcount(p + i, n - i);
+	}
+
+	size_t sse2_find_nonzero(const uint64_t* p, size_t n) {
+		const __m128i zero = _mm_setzero_si128();
+		size_t i = 0;
+		for(; i + 2 <= n; i += 2) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)) != 0xFFFF)
+				return p[i] ? i : i + 1;
+		}
+		return i + scalar_find_nonzero(p + i, n - i);
+	}
+
+	// ---------------------------------------------------------------
+	// AVX2
+	// ---------------------------------------------------------------
+	template <size_t W> struct avx2_ops;
+
+	template <> struct avx2_ops<1> {
+		CCSTL_AVX2 static __m256i set1(uint8_t v) { return _mm256_set1_epi8(char(v)); }
+		CCSTL_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+	};
+	template <> struct avx2_ops<2> {
+		CCSTL_AVX2 static __m256i set1(uint16_t v) { return _mm256_set1_epi16(short(v)); }
+		CCSTL_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+	};
+	template <> struct avx2_ops<4> {
+		CCSTL_AVX2 static __m256i set1(uint32_t v) { return _mm256_set1_epi32(int(v)); }
+		CCSTL_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+	};
+	template <> struct avx2_ops<8> {
+		CCSTL_AVX2 static __m256i set1(uint64_t v) { return _mm256_set1_epi64x((long long)v); }
+		CCSTL_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+	};
+
+	template <class U>
+	CCSTL_AVX2 size_t avx2_find(const void* p, size_t n, U value) {
+		const unsigned char* s = static_cast<const unsigned char*>(p);
+		const size_t per = 32 / sizeof(U);
+		const __m256i v = avx2_ops<sizeof(U)>::set1(value);
+		size_t i = 0;
+		// 每次处理两个向量, 减少分支
+		for(; i + 2 * per <= n; i += 2 * per) {
+			__m256i x0 = _mm256_loadu_si256((const __m256i*)(s + i * sizeof(U)));
+			__m256i x1 = _mm256_loadu_si256((const __m256i*)(s + (i + per) * sizeof(U)));
+			__m256i e0 = avx2_ops<sizeof(U)>::eq(x0, v);
+			__m256i e1 = avx2_ops<sizeof(U)>::eq(x1, v);
+			if(!_mm256_testz_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e0, e1))) {
+				unsigned m0 = unsigned(_mm256_movemask_epi8(e0));
+				if(m0)
+					return i + __builtin_ctz(m0) / sizeof(U);
+				unsigned m1 = unsigned(_mm256_movemask_epi8(e1));
+				return i + per + __builtin_ctz(m1) / sizeof(U);
+			}
+		}
+		for(; i + per <= n; i += per) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(s + i * sizeof(U)));
+			unsigned mask = unsigned(_mm256_movemask_epi8(avx2_ops<sizeof(U)>::eq(x, v)));
+			if(mask)
+				return i + __builtin_ctz(mask) / sizeof(U);
+		}
+		return i + scalar_find(s + i * sizeof(U), n - i, value);
+	}
+
+	template <class U>
+	CCSTL_AVX2 size_t avx2_count(const void* p, size_t n, U value) {
+		const unsigned char* s = static_cast<const unsigned char*>(p);
+		const size_t per = 32 / sizeof(U);
+		const __m256i v = avx2_ops<sizeof(U)>::set1(value);
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i total = zero;
+		size_t i = 0;
+		while(i + per <= n) {
+			__m256i acc = zero;
+			for(int k = 0; k < 255 && i + per <= n; ++k, i += per) {
+				__m256i x = _mm256_loadu_si256((const __m256i*)(s + i * sizeof(U)));
+				acc = _mm256_sub_epi8(acc, avx2_ops<sizeof(U)>::eq(x, v));
+			}
+			total = _mm256_add_epi64(total, _mm256_sad_epu8(acc, zero));
+		}
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, total);
+		return (lanes[0] + lanes[1] + lanes[2] + lanes[3]) / sizeof(U) +
+		       scalar_count(s + i * sizeof(U), n - i, value);
+	}
+
+	CCSTL_AVX2 size_t avx2_mismatch(const void* a, const void* b, size_t n) {
+		const unsigned char* x = static_cast<const unsigned char*>(a);
+		const unsigned char* y = static_cast<const unsigned char*>(b);
+		size_t i = 0;
+		for(; i + 32 <= n; i += 32) {
+			__m256i va = _mm256_loadu_si256((const __m256i*)(x + i));
+			__m256i vb = _mm256_loadu_si256((const __m256i*)(y + i));
+			unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+			if(mask != 0xFFFFFFFFu)
+				return i + __builtin_ctz(~mask);
+		}
+		return i + sse2_mismatch(x + i, y + i, n - i);
+	}
+
+	CCSTL_AVX2 size_t avx2_find_bytes(const void* h, size_t n, const void* nd, size_t m) {
+		const unsigned char* s = static_cast<const unsigned char*>(h);
+		const unsigned char* t = static_cast<const unsigned char*>(nd);
+		const __m256i first = _mm256_set1_epi8(char(t[0]));
+		const __m256i last = _mm256_set1_epi8(char(t[m - 1]));
+		size_t i = 0;
+		for(; i + m - 1 + 32 <= n; i += 32) {
+			__m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i)), first);
+			__m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i + m - 1)), last);
+			unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_and_si256(a, b)));
+			while(mask) {
+				size_t k = i + __builtin_ctz(mask);
+				if(memcmp(s + k + 1, t + 1, m - 2) == 0)
+					return k;
+				mask &= mask - 1;
+			}
+		}
+		size_t r = sse2_find_bytes(s + i, n - i, t, m);
+		return r == n - i ? n : i + r;
+	}
+
+	template <bool Max, bool Unsigned>
+	inline bool better_u32(uint32_t x, uint32_t best) {
+		if(Unsigned)
+			return Max ? x > best : x < best;
+		return Max ? int32_t(x) > int32_t(best) : int32_t(x) < int32_t(best);
+	}
+
+	template <bool Max, bool Unsigned>
+	CCSTL_AVX2 inline __m256i avx2_select_i32(__m256i a, __m256i b) {
+		return Max ? (Unsigned ? _mm256_max_epu32(a, b) : _mm256_max_epi32(a, b))
+		           : (Unsigned ? _mm256_min_epu32(a, b) : _mm256_min_epi32(a, b));
+	}
+
+	template <bool Max, bool Unsigned>
+	CCSTL_AVX2 size_t avx2_extreme_index(const uint32_t* p, size_t n) {
+		if(n < 16)
+			return sse2_extreme_index<Max, Unsigned>(p, n);
+		__m256i acc = _mm256_loadu_si256((const __m256i*)p);
+		size_t i = 8;
+		for(; i + 8 <= n; i += 8)
+			acc = avx2_select_i32<Max, Unsigned>(acc, _mm256_loadu_si256((const __m256i*)(p + i)));
+		uint32_t lanes[8];
+		_mm256_storeu_si256((__m256i*)lanes, acc);
+		uint32_t best = lanes[0];
+		for(int k = 1; k < 8; ++k) {
+			if(better_u32<Max, Unsigned>(lanes[k], best))
+				best = lanes[k];
+		}
+		for(; i < n; ++i) {
+			if(better_u32<Max, Unsigned>(p[i], best))
+				best = p[i];
+		}
+		return avx2_find<uint32_t>(p, n, best);
+	}
+
+	CCSTL_AVX2 uint32_t avx2_sum_u32(const uint32_t* p, size_t n) {
+		__m256i acc = _mm256_setzero_si256();
+		size_t i = 0;
+		for(; i + 8 <= n; i += 8)
+			acc = _mm256_add_epi32(acc, _mm256_loadu_si256((const __m256i*)(p + i)));
+		uint32_t lanes[8];
+		_mm256_storeu_si256((__m256i*)lanes, acc);
+		uint32_t s = 0;
+		for(int k = 0; k < 8; ++k)
+			s += lanes[k];
+		return s + scalar_sum(p + i, n - i);
+	}
+
+	CCSTL_AVX2 uint64_t avx2_sum_u64(const uint64_t* p, size_t n) {
+		__m256i acc = _mm256_setzero_si256();
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4)
+			acc = _mm256_add_epi64(acc, _mm256_loadu_si256((const __m256i*)(p + i)));
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, acc);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_sum(p + i, n - i);
+	}
+
+	template <class Op> struct avx2_word_op;
+	template <> struct avx2_word_op<and_op> {
+		CCSTL_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+	};
+	template <> struct avx2_word_op<or_op> {
+		CCSTL_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+	};
+	template <> struct avx2_word_op<xor_op> {
+		CCSTL_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+	};
+	template <> struct avx2_word_op<andnot_op> {
+		CCSTL_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+	};
+
+	// 每次处理8个字(两个向量), 位图通常很长, 循环开销要尽量小
+	template <class Op>
+	CCSTL_AVX2 void avx2_words(uint64_t* dst, const uint64_t* src, size_t n) {
+		size_t i = 0;
+		for(; i + 8 <= n; i += 8) {
+			__m256i a0 = _mm256_loadu_si256((const __m256i*)(dst + i));
+			__m256i a1 = _mm256_loadu_si256((const __m256i*)(dst + i + 4));
+			__m256i b0 = _mm256_loadu_si256((const __m256i*)(src + i));
+			__m256i b1 = _mm256_loadu_si256((const __m256i*)(src + i + 4));
+			_mm256_storeu_si256((__m256i*)(dst + i), avx2_word_op<Op>::apply(a0, b0));
+			_mm256_storeu_si256((__m256i*)(dst + i + 4), avx2_word_op<Op>::apply(a1, b1));
+		}
+		sse2_words<Op>(dst + i, src + i, n - i);
+	}
+
+	// 按半字节查表(vpshufb)得到每个字节的1的个数, 再用vpsadbw按64位累加
+	CCSTL_AVX2 size_t avx2_popcount(const uint64_t* p, size_t n) {
+		const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low = _mm256_set1_epi8(0x0F);
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i total = zero;
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+			__m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(x, low));
+			__m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), low));
+			total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), zero));
+		}
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, total);
+		return size_t(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + scalar_popcount(p + i, n - i);
+	}
+
+	CCSTL_AVX2 size_t avx2_find_nonzero(const uint64_t* p, size_t n) {
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+			if(!_mm256_testz_si256(x, x))
+				break;
+		}
+		return i + scalar_find_nonzero(p + i, n - i);
+	}
+#endif // CCSTL_SIMD_X86
+
+	size_t scalar_min_i32(const int32_t* p, size_t n) { return scalar_min_index(p, n); }
+	size_t scalar_max_i32(const int32_t* p, size_t n) { return scalar_max_index(p, n); }
+	size_t scalar_min_u32(const uint32_t* p, size_t n) { return scalar_min_index(p, n); }
+	size_t scalar_max_u32(const uint32_t* p, size_t n) { return scalar_max_index(p, n); }
+	uint32_t scalar_sum_u32(const uint32_t* p, size_t n) { return scalar_sum(p, n); }
+	uint64_t scalar_sum_u64(const uint64_t* p, size_t n) { return scalar_sum(p, n); }
+
+#ifdef CCSTL_SIMD_X86
+	size_t sse2_min_i32(const int32_t* p, size_t n) { return sse2_extreme_index<false, false>((const uint32_t*)p, n); }
+	size_t sse2_max_i32(const int32_t* p, size_t n) { return sse2_extreme_index<true, false>((const uint32_t*)p, n); }
+	size_t sse2_min_u32(const uint32_t* p, size_t n) { return sse2_extreme_index<false, true>(p, n); }
+	size_t sse2_max_u32(const uint32_t* p, size_t n) { return sse2_extreme_index<true, true>(p, n); }
+	CCSTL_AVX2 size_t avx2_min_i32(const int32_t* p, size_t n) { return avx2_extreme_index<false, false>((const uint32_t*)p, n); }
+	CCSTL_AVX2 size_t avx2_max_i32(const int32_t* p, size_t n) { return avx2_extreme_index<true, false>((const uint32_t*)p, n); }
+	CCSTL_AVX2 size_t avx2_min_u32(const uint32_t* p, size_t n) { return avx2_extreme_index<false, true>(p, n); }
+	CCSTL_AVX2 size_t avx2_max_u32(const uint32_t* p, size_t n) { return avx2_extreme_index<true, true>(p, n); }
+#endif
+
+	// ---------------------------------------------------------------
+	// 分派表
+	// ---------------------------------------------------------------
+	struct kernels {
+		size_t (*find8)(const void*, size_t, uint8_t);
+		size_t (*find16)(const void*, size_t, uint16_t);
+		size_t (*find32)(const void*, size_t, uint32_t);
+		size_t (*find64)(const void*, size_t, uint64_t);
+		size_t (*count8)(const void*, size_t, uint8_t);
+		size_t (*count16)(const void*, size_t, uint16_t);
+		size_t (*count32)(const void*, size_t, uint32_t);
+		size_t (*count64)(const void*, size_t, uint64_t);
+		size_t (*mismatch)(const void*, const void*, size_t);
+		size_t (*find_bytes)(const void*, size_t, const void*, size_t);
+		size_t (*min_i32)(const int32_t*, size_t);
+		size_t (*max_i32)(const int32_t*, size_t);
+		size_t (*min_u32)(const uint32_t*, size_t);
+		size_t (*max_u32)(const uint32_t*, size_t);
+		uint32_t (*sum_u32)(const uint32_t*, size_t);
+		uint64_t (*sum_u64)(const uint64_t*, size_t);
+		void (*and_words)(uint64_t*, const uint64_t*, size_t);
+		void (*or_words)(uint64_t*, const uint64_t*, size_t);
+		void (*xor_words)(uint64_t*, const uint64_t*, size_t);
+		void (*andnot_words)(uint64_t*, const uint64_t*, size_t);
+		size_t (*popcount)(const uint64_t*, size_t);
+		size_t (*find_nonzero)(const uint64_t*, size_t);
+	};
+
+	const kernels scalar_kernels = {
+		scalar_find<uint8_t>, scalar_find<uint16_t>, scalar_find<uint32_t>, scalar_find<uint64_t>,
+		scalar_count<uint8_t>, scalar_count<uint16_t>, scalar_count<uint32_t>, scalar_count<uint64_t>,
+		scalar_mismatch, scalar_find_bytes,
+		scalar_min_i32, scalar_max_i32, scalar_min_u32, scalar_max_u32,
+		scalar_sum_u32, scalar_sum_u64,
+		scalar_words<and_op>, scalar_words<or_op>, scalar_words<xor_op>, scalar_words<andnot_op>,
+		scalar_popcount, scalar_find_nonzero
+	};
+
+#ifdef CCSTL_SIMD_X86
+	const kernels sse2_kernels = {
+		sse2_find<uint8_t>, sse2_find<uint16_t>, sse2_find<uint32_t>, sse2_find<uint64_t>,
+		sse2_count<uint8_t>, sse2_count<uint16_t>, sse2_count<uint32_t>, sse2_count<uint64_t>,
+		sse2_mismatch, sse2_find_bytes,
+		sse2_min_i32, sse2_max_i32, sse2_min_u32, sse2_max_u32,
+		sse2_sum_u32, sse2_sum_u64,
+		sse2_words<and_op>, sse2_words<or_op>, sse2_words<xor_op>, sse2_words<andnot_op>,
+		sse2_popcount, sse2_find_nonzero
+	};
+
+	const kernels avx2_kernels = {
+		avx2_find<uint8_t>, avx2_find<uint16_t>, avx2_find<uint32_t>, avx2_find<uint64_t>,
+		avx2_count<uint8_t>, avx2_count<uint16_t>, avx2_count<uint32_t>, avx2_count<uint64_t>,
+		avx2_mismatch, avx2_find_bytes,
+		avx2_min_i32, avx2_max_i32, avx2_min_u32, avx2_max_u32,
+		avx2_sum_u32, avx2_sum_u64,
+		avx2_words<and_op>, avx2_words<or_op>, avx2_words<xor_op>, avx2_words<andnot_op>,
+		avx2_popcount, avx2_find_nonzero
+	};
+#endif
+
+	const kernels* table_for(cpu_level level) {
+#ifdef CCSTL_SIMD_X86
+		if(level >= CPU_AVX2)
+			return &avx2_kernels;
+		if(level >= CPU_SSE2)
+			return &sse2_kernels;
+#endif
+		return &scalar_kernels;
+	}
+
+	cpu_level detect() {
+#ifdef CCSTL_SIMD_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2"))
+			return CPU_AVX2;
+		if(__builtin_cpu_supports("sse2"))
+			return CPU_SSE2;
+#endif
+		return CPU_SCALAR;
+	}
+
+	// 常量初始化, 不依赖其它编译单元的静态初始化顺序.
+	// 多个线程可能同时第一次调用内核(线程池、工作线程里的bitset运算), 所以都是原子变量:
+	// 同时初始化的线程写入的是相同的值, 先写级别再用release发布表指针
+	std::atomic<const kernels*> active(0);
+	std::atomic<int> active_level(CPU_SCALAR);
+
+	inline const kernels& table() {
+		const kernels* k = active.load(std::memory_order_acquire);
+		if(k == 0) {
+			cpu_level level = detect_cpu();
+			k = table_for(level);
+			active_level.store(level, std::memory_order_relaxed);
+			active.store(k, std::memory_order_release);
+		}
+		return *k;
+	}
+}
+
+	cpu_level detect_cpu() {
+		static const cpu_level level = detect();
+		return level;
+	}
+
+	cpu_level cpu() {
+		table();
+		return cpu_level(active_level.load(std::memory_order_relaxed));
+	}
+
+	void set_cpu_level(cpu_level level) {
+		if(level > detect_cpu())
+			level = detect_cpu();
+		active_level.store(level, std::memory_order_relaxed);
+		active.store(table_for(level), std::memory_order_release);
+	}
+
+	size_t find8(const void* p, size_t n, uint8_t value) { return table().find8(p, n, value); }
+	size_t find16(const void* p, size_t n, uint16_t value) { return table().find16(p, n, value); }
+	size_t find32(const void* p, size_t n, uint32_t value) { return table().find32(p, n, value); }
+	size_t find64(const void* p, size_t n, uint64_t value) { return table().find64(p, n, value); }
+
+	size_t count8(const void* p, size_t n, uint8_t value) { return table().count8(p, n, value); }
+	size_t count16(const void* p, size_t n, uint16_t value) { return table().count16(p, n, value); }
+	size_t count32(const void* p, size_t n, uint32_t value) { return table().count32(p, n, value); }
+	size_t count64(const void* p, size_t n, uint64_t value) { return table().count64(p, n, value); }
+
+	size_t mismatch_bytes(const void* a, const void* b, size_t nbytes) {
+		return table().mismatch(a, b, nbytes);
+	}
+
+	size_t find_bytes(const void* haystack, size_t n, const void* needle, size_t m) {
+		if(m == 0)
+			return 0;
+		if(m > n)
+			return n;
+		if(m == 1)
+			return table().find8(haystack, n, *static_cast<const uint8_t*>(needle));
+		return table().find_bytes(haystack, n, needle, m);
+	}
+
+	size_t min_index_i32(const int32_t* p, size_t n) { return n ? table().min_i32(p, n) : 0; }
+	size_t max_index_i32(const int32_t* p, size_t n) { return n ? table().max_i32(p, n) : 0; }
+	size_t min_index_u32(const uint32_t* p, size_t n) { return n ? table().min_u32(p, n) : 0; }
+	size_t max_index_u32(const uint32_t* p, size_t n) { return n ? table().max_u32(p, n) : 0; }
+
+	uint32_t sum_u32(const uint32_t* p, size_t n) { return table().sum_u32(p, n); }
+	uint64_t sum_u64(const uint64_t* p, size_t n) { return table().sum_u64(p, n); }
+
+	void and_words(uint64_t* dst, const uint64_t* src, size_t n) { table().and_words(dst, src, n); }
+	void or_words(uint64_t* dst, const uint64_t* src, size_t n) { table().or_words(dst, src, n); }
+	void xor_words(uint64_t* dst, const uint64_t* src, size_t n) { table().xor_words(dst, src, n); }
+	void andnot_words(uint64_t* dst, const uint64_t* src, size_t n) { table().andnot_words(dst, src, n); }
+
+	size_t popcount_words(const uint64_t* p, size_t n) { return table().popcount(p, n); }
+	size_t find_nonzero_word(const uint64_t* p, size_t n) { return table().find_nonzero(p, n); }
+}
+}
@@ -0,0 +1,66 @@
+#ifndef SIMD_H
+#define SIMD_H
+#include <cstddef>
+#include <cstdint>
+
+// 连续内存上的查找/比较内核
+// 每个内核都有 scalar / SSE2 / AVX2 三个版本, 第一次调用时根据CPU特性选择,
+// 之后通过函数指针表分派. 上层的算法(algorithm.h)只在区间是原生指针且
+// 元素是算术类型时才会走到这里, 其余情况仍然是逐个元素的通用实现.
+namespace CCSTL {
+namespace simd {
+	enum cpu_level {
+		CPU_SCALAR = 0,
+		CPU_SSE2   = 1,
+		CPU_AVX2   = 2
+	};
+
+	// 当前CPU支持的最高等级
+	cpu_level detect_cpu();
+	// 当前正在使用的等级
+	cpu_level cpu();
+	// 强制使用某个等级(不会超过detect_cpu()), 用于基准测试和排查问题
+	void set_cpu_level(cpu_level level);
+
+	// 按位相等查找, 返回第一个匹配元素的下标, 找不到返回n
+	size_t find8(const void* p, size_t n, uint8_t value);
+	size_t find16(const void* p, size_t n, uint16_t value);
+	size_t find32(const void* p, size_t n, uint32_t value);
+	size_t find64(const void* p, size_t n, uint64_t value);
+
+	// 按位相等计数
+	size_t count8(const void* p, size_t n, uint8_t value);
+	size_t count16(const void* p, size_t n, uint16_t value);
+	size_t count32(const void* p, size_t n, uint32_t value);
+	size_t count64(const void* p, size_t n, uint64_t value);
+
+	// 返回第一个不相等字节的下标, 全部相等返回nbytes
+	size_t mismatch_bytes(const void* a, const void* b, size_t nbytes);
+
+	// 在n个字节中查找长度为m的字节串, 返回第一次出现的位置, 找不到返回n; m为0时返回0
+	size_t find_bytes(const void* haystack, size_t n, const void* needle, size_t m);
+
+	// 返回第一个最小/最大元素的下标, n为0时返回0
+	size_t min_index_i32(const int32_t* p, size_t n);
+	size_t max_index_i32(const int32_t* p, size_t n);
+	size_t min_index_u32(const uint32_t* p, size_t n);
+	size_t max_index_u32(const uint32_t* p, size_t n);
+
+	// 按2^32 / 2^64取模求和
+	uint32_t sum_u32(const uint32_t* p, size_t n);
+	uint64_t sum_u64(const uint64_t* p, size_t n);
+
+	// 位图(dynamic_bitset)的按字运算, 结果写回dst:
+	// dst &= src, dst |= src, dst ^= src, dst &= ~src
+	void and_words(uint64_t* dst, const uint64_t* src, size_t n);
+	void or_words(uint64_t* dst, const uint64_t* src, size_t n);
+	void xor_words(uint64_t* dst, const uint64_t* src, size_t n);
+	void andnot_words(uint64_t* dst, const uint64_t* src, size_t n);
+
+	// n个字中1的总个数
+	size_t popcount_words(const uint64_t* p, size_t n);
+	// 第一个不为0的字的下标, 全为0返回n
+	size_t find_nonzero_word(const uint64_t* p, size_t n);
+}
+}
+#endif
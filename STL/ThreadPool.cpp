@@ -0,0 +1,228 @@
+#include "ThreadPool.h"
+#include <thread>
+
+namespace CCSTL {
+    // ---------------------------------------------------------------
+    // work_stealing_deque
+    // ---------------------------------------------------------------
+    work_stealing_deque::~work_stealing_deque() {
+        ring* r = array.load(std::memory_order_relaxed);
+        while(r) {
+            ring* next = r->retired;
+            delete r;
+            r = next;
+        }
+    }
+
+    void work_stealing_deque::push(task* t) {
+        long b = bottom.load(std::memory_order_relaxed);
+        long tp = top.load(std::memory_order_acquire);
+        ring* a = array.load(std::memory_order_relaxed);
+        if(b - tp > a->capacity - 1) {
+            a = a->grow(b, tp);
+            array.store(a, std::memory_order_release);
+        }
+        a->put(b, t);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    task* work_stealing_deque::pop() {
+        long b = bottom.load(std::memory_order_relaxed) - 1;
+        ring* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long tp = top.load(std::memory_order_relaxed);
+        if(tp > b) {
+            // 队列为空
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return 0;
+        }
+        task* t = a->get(b);
+        if(tp == b) {
+            // 只剩最后一个, 与窃取者竞争
+            if(!top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed))
+                t = 0;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return t;
+    }
+
+    task* work_stealing_deque::steal() {
+        long tp = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long b = bottom.load(std::memory_order_acquire);
+        if(tp >= b)
+            return 0;
+        ring* a = array.load(std::memory_order_acquire);
+        task* t = a->get(tp);
+        if(!top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed))
+            return 0;
+        return t;
+    }
+
+    // ---------------------------------------------------------------
+    // thread_pool
+    // ---------------------------------------------------------------
+    struct thread_pool::worker {
+        work_stealing_deque queue;
+        std::thread thread;
+    };
+
+    namespace {
+        // 当前线程所属的线程池和工作线程下标
+        thread_local thread_pool* tls_pool = 0;
+        thread_local size_t tls_index = 0;
+
+        // 窃取时的随机起点, xorshift足够
+        inline size_t next_victim(size_t n) {
+            thread_local unsigned seed = unsigned(reinterpret_cast<size_t>(&seed));
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed % n;
+        }
+    }
+
+    thread_pool::thread_pool(size_t concurrency)
+        : nworkers(0), workers(0), inject_count(0), stopping(false), sleeping(0) {
+        if(concurrency == 0)
+            concurrency = std::thread::hardware_concurrency();
+        if(concurrency == 0)
+            concurrency = 1;
+        nworkers = concurrency - 1;
+        workers = new worker[nworkers ? nworkers : 1];
+        for(size_t i = 0; i < nworkers; ++i)
+            workers[i].thread = std::thread(&thread_pool::worker_loop, this, i);
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping.store(true);
+        }
+        sleep_cv.notify_all();
+        for(size_t i = 0; i < nworkers; ++i)
+            workers[i].thread.join();
+        delete[] workers;
+    }
+
+    thread_pool& thread_pool::instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    void thread_pool::submit(task* t) {
+        if(tls_pool == this) {
+            workers[tls_index].queue.push(t);
+        } else {
+            std::lock_guard<std::mutex> lock(inject_mutex);
+            injected.push_back(t);
+            inject_count.fetch_add(1, std::memory_order_release);
+        }
+        if(sleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            sleep_cv.notify_one();
+        }
+    }
+
+    task* thread_pool::take_injected() {
+        if(inject_count.load(std::memory_order_acquire) == 0)
+            return 0;
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        if(injected.empty())
+            return 0;
+        task* t = injected.front();
+        injected.pop_front();
+        inject_count.fetch_sub(1, std::memory_order_relaxed);
+        return t;
+    }
+
+    // 先取自己队列的bottom(最近提交的, cache最热), 再取外部提交的任务,
+    // 最后从随机的其它工作线程的top窃取(最早提交的, 通常也是最大的一块)
+    task* thread_pool::take(size_t self) {
+        task* t = 0;
+        if(self < nworkers && (t = workers[self].queue.pop()))
+            return t;
+        if((t = take_injected()))
+            return t;
+        if(nworkers == 0)
+            return 0;
+        size_t start = next_victim(nworkers);
+        for(size_t k = 0; k < nworkers; ++k) {
+            size_t victim = (start + k) % nworkers;
+            if(victim == self)
+                continue;
+            if((t = workers[victim].queue.steal()))
+                return t;
+        }
+        return 0;
+    }
+
+    void thread_pool::execute(task* t) {
+        t->invoke(t);
+    }
+
+    bool thread_pool::run_one() {
+        task* t = take(tls_pool == this ? tls_index : nworkers);
+        if(!t)
+            return false;
+        execute(t);
+        return true;
+    }
+
+    void thread_pool::worker_loop(size_t index) {
+        tls_pool = this;
+        tls_index = index;
+        int idle = 0;
+        while(!stopping.load(std::memory_order_acquire)) {
+            task* t = take(index);
+            if(t) {
+                execute(t);
+                idle = 0;
+                continue;
+            }
+            // 先自旋让出CPU, 仍然没有任务再睡眠; 定时醒来是为了兜住错过的通知
+            if(++idle < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            if(!stopping.load(std::memory_order_acquire))
+                sleep_cv.wait_for(lock, std::chrono::milliseconds(1));
+            sleeping.fetch_sub(1, std::memory_order_seq_cst);
+            idle = 0;
+        }
+    }
+
+    // ---------------------------------------------------------------
+    // task_group
+    // ---------------------------------------------------------------
+    void task_group::set_error(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if(!error)
+            error = e;
+    }
+
+    void task_group::wait_no_throw() {
+        while(pending.load(std::memory_order_acquire) != 0) {
+            if(!pool.run_one())
+                std::this_thread::yield();
+        }
+    }
+
+    void task_group::wait() {
+        wait_no_throw();
+        std::exception_ptr e;
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            e = error;
+            error = std::exception_ptr();
+        }
+        if(e)
+            std::rethrow_exception(e);
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+
+namespace CCSTL {
+    class thread_pool;
+    class task_group;
+
+    // 任务节点, 由task_group::run()分配, 执行完后自行释放
+    struct task {
+        void (*invoke)(task*);
+        task_group* group;
+    };
+
+    // Chase-Lev 工作窃取双端队列 (Lê, Pop, Cohen, Zappa Nardelli 2013 的弱内存序版本)
+    // 只有所属的工作线程可以在bottom端push/pop, 其它线程只能在top端steal
+    // 环形数组满了就扩大一倍, 旧数组挂在retired链上, 等队列析构时再释放,
+    // 因为窃取者可能还在读旧数组
+    class work_stealing_deque {
+    private:
+        struct ring {
+            long capacity;
+            std::atomic<task*>* slots;
+            ring* retired;
+
+            explicit ring(long cap): capacity(cap), slots(new std::atomic<task*>[cap]), retired(0) {}
+            ~ring() { delete[] slots; }
+
+            task* get(long i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+            void put(long i, task* t) { slots[i & (capacity - 1)].store(t, std::memory_order_relaxed); }
+
+            ring* grow(long bottom, long top) {
+                ring* r = new ring(capacity * 2);
+                for(long i = top; i != bottom; ++i)
+                    r->put(i, get(i));
+                r->retired = this;
+                return r;
+            }
+        };
+
+        // top与bottom之间、与前后的对象之间都隔开至少一条cache line, 避免窃取者与所有者互相干扰.
+        // 用填充而不是alignas(64): C++11的new不保证超过16字节的对齐, 而工作线程的数组是new[]出来的
+        static const size_t cache_line = 64;
+        char pad_front[cache_line];
+        std::atomic<long> top;
+        char pad_top[cache_line - sizeof(std::atomic<long>)];
+        std::atomic<long> bottom;
+        char pad_bottom[cache_line - sizeof(std::atomic<long>)];
+        std::atomic<ring*> array;
+        char pad_back[cache_line - sizeof(std::atomic<ring*>)];
+
+    public:
+        explicit work_stealing_deque(long capacity = 256): top(0), bottom(0), array(new ring(capacity)) {}
+        ~work_stealing_deque();
+
+        work_stealing_deque(const work_stealing_deque&) = delete;
+        work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+        // 只能由所有者调用
+        void push(task* t);
+        task* pop();
+        // 任何线程都可以调用, 失败(队列空或与别人竞争失败)返回0
+        task* steal();
+
+        bool empty() const {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+    };
+
+    // 工作窃取线程池
+    // concurrency为参与计算的线程总数: 池中启动concurrency-1个工作线程,
+    // 调用task_group::wait()的线程也会执行任务, 算作最后一个
+    class thread_pool {
+    public:
+        explicit thread_pool(size_t concurrency = 0);
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        size_t concurrency() const { return nworkers + 1; }
+
+        // 按硬件线程数创建的全局线程池
+        static thread_pool& instance();
+
+        void submit(task* t);
+        // 找一个任务并执行, 没有可执行的任务返回false
+        bool run_one();
+
+    private:
+        struct worker;
+
+        void worker_loop(size_t index);
+        task* take(size_t self);
+        task* take_injected();
+        static void execute(task* t);
+
+        size_t nworkers;
+        worker* workers;
+
+        // 非工作线程提交的任务先放在这里
+        std::mutex inject_mutex;
+        std::deque<task*> injected;
+        std::atomic<size_t> inject_count;
+
+        std::atomic<bool> stopping;
+        std::atomic<int> sleeping;
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cv;
+    };
+
+    // 一组可以等待的任务, fork-join式的并行都通过它完成
+    // wait()会在等待期间执行池中的任务, 所以在任务中嵌套使用task_group不会死锁
+    class task_group {
+    public:
+        explicit task_group(thread_pool& p): pool(p), pending(0), error() {}
+        ~task_group() { wait_no_throw(); }
+
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+
+        template <class F>
+        void run(const F& f) {
+            func_task<F>* t = new func_task<F>(f);
+            t->invoke = &func_task<F>::call;
+            t->group = this;
+            pending.fetch_add(1, std::memory_order_relaxed);
+            pool.submit(t);
+        }
+
+        // 等待所有任务完成; 如果有任务抛出了异常, 重新抛出第一个
+        void wait();
+
+    private:
+        friend class thread_pool;
+
+        template <class F>
+        struct func_task: public task {
+            F f;
+            explicit func_task(const F& x): f(x) {}
+            static void call(task* t) {
+                func_task* self = static_cast<func_task*>(t);
+                try {
+                    self->f();
+                } catch(...) {
+                    self->group->set_error(std::current_exception());
+                }
+                task_group* g = self->group;
+                delete self;
+                g->pending.fetch_sub(1, std::memory_order_release);
+            }
+        };
+
+        void set_error(std::exception_ptr e);
+        void wait_no_throw();
+
+        thread_pool& pool;
+        std::atomic<size_t> pending;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+}
+#endif
@@ -2,6 +2,15 @@
 #define TRAIT_H
 #include <cstddef>
 #include "Iterator.h"
+
+// C++14起constexpr函数才可以修改对象, array和static_vector的非const成员用它标注,
+// 在C++11下就是普通的成员函数
+#if __cplusplus >= 201402L
+#define CCSTL_CONSTEXPR14 constexpr
+#else
+#define CCSTL_CONSTEXPR14
+#endif
+
 namespace CCSTL{
 	template <class Iterator>
 	struct iterator_traits {
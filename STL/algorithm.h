@@ -0,0 +1,368 @@
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "Trait.h"
+#include "Simd.h"
+
+namespace CCSTL {
+    // 连续区间的判定: 只有原生指针(包括vector的iterator)才被认为是连续的,
+    // 再按元素类型决定能否交给Simd.h中的内核:
+    //   __simd_width<T>::value 为1/2/4/8表示可以按位比较的整数(或指针/枚举),
+    //   为0表示只能走逐个元素的版本(浮点数的-0.0/NaN不能按位比较)
+    template <class T>
+    struct __simd_width {
+        typedef typename std::remove_cv<T>::type type;
+        static const size_t value =
+            (std::is_integral<type>::value || std::is_enum<type>::value ||
+             std::is_pointer<type>::value) &&
+            (sizeof(type) == 1 || sizeof(type) == 2 ||
+             sizeof(type) == 4 || sizeof(type) == 8) ? sizeof(type) : 0;
+    };
+
+    template <size_t W> struct __simd_tag {};
+
+    template <size_t W> struct __simd_uint;
+    template <> struct __simd_uint<1> { typedef uint8_t type; };
+    template <> struct __simd_uint<2> { typedef uint16_t type; };
+    template <> struct __simd_uint<4> { typedef uint32_t type; };
+    template <> struct __simd_uint<8> { typedef uint64_t type; };
+
+    template <class T>
+    inline typename __simd_uint<sizeof(T)>::type __simd_bits(const T& x) {
+        typename __simd_uint<sizeof(T)>::type r;
+        memcpy(&r, &x, sizeof(T));
+        return r;
+    }
+
+    inline size_t __simd_find(const void* p, size_t n, uint8_t v) { return simd::find8(p, n, v); }
+    inline size_t __simd_find(const void* p, size_t n, uint16_t v) { return simd::find16(p, n, v); }
+    inline size_t __simd_find(const void* p, size_t n, uint32_t v) { return simd::find32(p, n, v); }
+    inline size_t __simd_find(const void* p, size_t n, uint64_t v) { return simd::find64(p, n, v); }
+    inline size_t __simd_count(const void* p, size_t n, uint8_t v) { return simd::count8(p, n, v); }
+    inline size_t __simd_count(const void* p, size_t n, uint16_t v) { return simd::count16(p, n, v); }
+    inline size_t __simd_count(const void* p, size_t n, uint32_t v) { return simd::count32(p, n, v); }
+    inline size_t __simd_count(const void* p, size_t n, uint64_t v) { return simd::count64(p, n, v); }
+
+    // 把要查找的值转换成元素类型; 如果转换后与原值不相等(例如在char数组中找300),
+    // 那么区间里不可能有元素与之相等
+    template <class T, class U>
+    inline bool __simd_convert(const U& value, T& out, std::true_type) {
+        out = static_cast<T>(value);
+        return out == value;
+    }
+
+    template <class T, class U>
+    inline bool __simd_convert(const U&, T&, std::false_type) {
+        return false;
+    }
+
+    template <class T, class U>
+    struct __simd_convertible: public std::integral_constant<bool,
+        (std::is_arithmetic<U>::value && std::is_arithmetic<typename std::remove_cv<T>::type>::value) ||
+        std::is_same<U, typename std::remove_cv<T>::type>::value> {};
+
+    // ---------------------------------------------------------------
+    // find
+    // ---------------------------------------------------------------
+    template <class InputIterator, class T>
+    InputIterator find(InputIterator first, InputIterator last, const T& value) {
+        while(first != last && !(*first == value))
+            ++first;
+        return first;
+    }
+
+    template <class T, class U, size_t W>
+    T* __find(T* first, T* last, const U& value, __simd_tag<W>) {
+        typename std::remove_cv<T>::type v;
+        if(!__simd_convert(value, v, __simd_convertible<T, U>()))
+            return CCSTL::find<T*, U>(first, last, value);
+        return first + __simd_find(first, last - first, __simd_bits(v));
+    }
+
+    template <class T, class U>
+    T* __find(T* first, T* last, const U& value, __simd_tag<0>) {
+        return CCSTL::find<T*, U>(first, last, value);
+    }
+
+    template <class T, class U>
+    inline T* find(T* first, T* last, const U& value) {
+        return __find(first, last, value, __simd_tag<__simd_width<T>::value>());
+    }
+
+    template <class InputIterator, class Predicate>
+    InputIterator find_if(InputIterator first, InputIterator last, Predicate pred) {
+        while(first != last && !pred(*first))
+            ++first;
+        return first;
+    }
+
+    // ---------------------------------------------------------------
+    // count
+    // ---------------------------------------------------------------
+    template <class InputIterator, class T>
+    typename iterator_traits<InputIterator>::difference_type
+    count(InputIterator first, InputIterator last, const T& value) {
+        typename iterator_traits<InputIterator>::difference_type n = 0;
+        for(; first != last; ++first) {
+            if(*first == value)
+                ++n;
+        }
+        return n;
+    }
+
+    template <class T, class U, size_t W>
+    ptrdiff_t __count(T* first, T* last, const U& value, __simd_tag<W>) {
+        typename std::remove_cv<T>::type v;
+        if(!__simd_convert(value, v, __simd_convertible<T, U>()))
+            return CCSTL::count<T*, U>(first, last, value);
+        return ptrdiff_t(__simd_count(first, last - first, __simd_bits(v)));
+    }
+
+    template <class T, class U>
+    ptrdiff_t __count(T* first, T* last, const U& value, __simd_tag<0>) {
+        return CCSTL::count<T*, U>(first, last, value);
+    }
+
+    template <class T, class U>
+    inline ptrdiff_t count(T* first, T* last, const U& value) {
+        return __count(first, last, value, __simd_tag<__simd_width<T>::value>());
+    }
+
+    template <class InputIterator, class Predicate>
+    typename iterator_traits<InputIterator>::difference_type
+    count_if(InputIterator first, InputIterator last, Predicate pred) {
+        typename iterator_traits<InputIterator>::difference_type n = 0;
+        for(; first != last; ++first) {
+            if(pred(*first))
+                ++n;
+        }
+        return n;
+    }
+
+    // ---------------------------------------------------------------
+    // mismatch / equal
+    // ---------------------------------------------------------------
+    template <class InputIterator1, class InputIterator2>
+    std::pair<InputIterator1, InputIterator2>
+    mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+        while(first1 != last1 && *first1 == *first2) {
+            ++first1;
+            ++first2;
+        }
+        return std::pair<InputIterator1, InputIterator2>(first1, first2);
+    }
+
+    template <class InputIterator1, class InputIterator2, class BinaryPredicate>
+    std::pair<InputIterator1, InputIterator2>
+    mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+             BinaryPredicate pred) {
+        while(first1 != last1 && pred(*first1, *first2)) {
+            ++first1;
+            ++first2;
+        }
+        return std::pair<InputIterator1, InputIterator2>(first1, first2);
+    }
+
+    // 两个区间的元素类型相同, 并且可以按位比较时才走内核
+    template <class T1, class T2>
+    struct __simd_same_width {
+        static const size_t value =
+            std::is_same<typename std::remove_cv<T1>::type,
+                         typename std::remove_cv<T2>::type>::value ? __simd_width<T1>::value : 0;
+    };
+
+    template <class T1, class T2, size_t W>
+    inline std::pair<T1*, T2*> __mismatch(T1* first1, T1* last1, T2* first2, __simd_tag<W>) {
+        size_t n = last1 - first1;
+        size_t i = simd::mismatch_bytes(first1, first2, n * W) / W;
+        return std::pair<T1*, T2*>(first1 + i, first2 + i);
+    }
+
+    template <class T1, class T2>
+    inline std::pair<T1*, T2*> __mismatch(T1* first1, T1* last1, T2* first2, __simd_tag<0>) {
+        return CCSTL::mismatch<T1*, T2*>(first1, last1, first2);
+    }
+
+    template <class T1, class T2>
+    inline std::pair<T1*, T2*> mismatch(T1* first1, T1* last1, T2* first2) {
+        return __mismatch(first1, last1, first2, __simd_tag<__simd_same_width<T1, T2>::value>());
+    }
+
+    template <class InputIterator1, class InputIterator2>
+    inline bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+        return CCSTL::mismatch(first1, last1, first2).first == last1;
+    }
+
+    template <class InputIterator1, class InputIterator2, class BinaryPredicate>
+    inline bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                      BinaryPredicate pred) {
+        return CCSTL::mismatch(first1, last1, first2, pred).first == last1;
+    }
+
+    // 可以按位比较的连续区间直接用memcmp, 它通常比mismatch内核更快;
+    // 空区间的指针可能是空指针, 不能交给memcmp
+    template <class T1, class T2, size_t W>
+    inline bool __equal(T1* first1, T1* last1, T2* first2, __simd_tag<W>) {
+        if(first1 == last1)
+            return true;
+        return memcmp(first1, first2, (last1 - first1) * W) == 0;
+    }
+
+    template <class T1, class T2>
+    inline bool __equal(T1* first1, T1* last1, T2* first2, __simd_tag<0>) {
+        return CCSTL::mismatch<T1*, T2*>(first1, last1, first2).first == last1;
+    }
+
+    template <class T1, class T2>
+    inline bool equal(T1* first1, T1* last1, T2* first2) {
+        return __equal(first1, last1, first2, __simd_tag<__simd_same_width<T1, T2>::value>());
+    }
+
+    // ---------------------------------------------------------------
+    // min_element / max_element
+    // ---------------------------------------------------------------
+    template <class ForwardIterator>
+    ForwardIterator min_element(ForwardIterator first, ForwardIterator last) {
+        if(first == last)
+            return first;
+        ForwardIterator result = first;
+        while(++first != last) {
+            if(*first < *result)
+                result = first;
+        }
+        return result;
+    }
+
+    template <class ForwardIterator, class Compare>
+    ForwardIterator min_element(ForwardIterator first, ForwardIterator last, Compare comp) {
+        if(first == last)
+            return first;
+        ForwardIterator result = first;
+        while(++first != last) {
+            if(comp(*first, *result))
+                result = first;
+        }
+        return result;
+    }
+
+    template <class ForwardIterator>
+    ForwardIterator max_element(ForwardIterator first, ForwardIterator last) {
+        if(first == last)
+            return first;
+        ForwardIterator result = first;
+        while(++first != last) {
+            if(*result < *first)
+                result = first;
+        }
+        return result;
+    }
+
+    template <class ForwardIterator, class Compare>
+    ForwardIterator max_element(ForwardIterator first, ForwardIterator last, Compare comp) {
+        if(first == last)
+            return first;
+        ForwardIterator result = first;
+        while(++first != last) {
+            if(comp(*result, *first))
+                result = first;
+        }
+        return result;
+    }
+
+    // 内核只覆盖32位整数, 其它类型仍是逐个比较
+    template <class T>
+    struct __minmax_kind {
+        typedef typename std::remove_cv<T>::type type;
+        static const int value =
+            !std::is_integral<type>::value || sizeof(type) != 4 ? 0 :
+            std::is_signed<type>::value ? 1 : 2;
+    };
+
+    template <class T>
+    inline T* __min_element(T* first, T* last, std::integral_constant<int, 0>) {
+        return CCSTL::min_element<T*>(first, last);
+    }
+    template <class T>
+    inline T* __min_element(T* first, T* last, std::integral_constant<int, 1>) {
+        return first + simd::min_index_i32((const int32_t*)first, last - first);
+    }
+    template <class T>
+    inline T* __min_element(T* first, T* last, std::integral_constant<int, 2>) {
+        return first + simd::min_index_u32((const uint32_t*)first, last - first);
+    }
+
+    template <class T>
+    inline T* min_element(T* first, T* last) {
+        return __min_element(first, last, std::integral_constant<int, __minmax_kind<T>::value>());
+    }
+
+    template <class T>
+    inline T* __max_element(T* first, T* last, std::integral_constant<int, 0>) {
+        return CCSTL::max_element<T*>(first, last);
+    }
+    template <class T>
+    inline T* __max_element(T* first, T* last, std::integral_constant<int, 1>) {
+        return first + simd::max_index_i32((const int32_t*)first, last - first);
+    }
+    template <class T>
+    inline T* __max_element(T* first, T* last, std::integral_constant<int, 2>) {
+        return first + simd::max_index_u32((const uint32_t*)first, last - first);
+    }
+
+    template <class T>
+    inline T* max_element(T* first, T* last) {
+        return __max_element(first, last, std::integral_constant<int, __minmax_kind<T>::value>());
+    }
+
+    // ---------------------------------------------------------------
+    // accumulate
+    // ---------------------------------------------------------------
+    template <class InputIterator, class T>
+    T accumulate(InputIterator first, InputIterator last, T init) {
+        for(; first != last; ++first)
+            init = init + *first;
+        return init;
+    }
+
+    template <class InputIterator, class T, class BinaryOperation>
+    T accumulate(InputIterator first, InputIterator last, T init, BinaryOperation op) {
+        for(; first != last; ++first)
+            init = op(init, *first);
+        return init;
+    }
+
+    // 只有init与元素是同一种32/64位整数时才用内核: 此时逐个相加与按模求和结果一致.
+    // 浮点数的加法不满足结合律, 重新排列会改变结果, 所以不做向量化
+    template <class E, class T>
+    struct __accumulate_width {
+        static const size_t value =
+            std::is_integral<T>::value && std::is_same<typename std::remove_cv<E>::type, T>::value &&
+            (sizeof(T) == 4 || sizeof(T) == 8) ? sizeof(T) : 0;
+    };
+
+    template <class E, class T>
+    inline T __accumulate(E* first, E* last, T init, __simd_tag<0>) {
+        return CCSTL::accumulate<E*, T>(first, last, init);
+    }
+
+    template <class E, class T>
+    inline T __accumulate(E* first, E* last, T init, __simd_tag<4>) {
+        uint32_t s = simd::sum_u32((const uint32_t*)first, last - first) + uint32_t(init);
+        return T(s);
+    }
+
+    template <class E, class T>
+    inline T __accumulate(E* first, E* last, T init, __simd_tag<8>) {
+        uint64_t s = simd::sum_u64((const uint64_t*)first, last - first) + uint64_t(init);
+        return T(s);
+    }
+
+    template <class E, class T>
+    inline T accumulate(E* first, E* last, T init) {
+        return __accumulate(first, last, init, __simd_tag<__accumulate_width<E, T>::value>());
+    }
+}
+#endif
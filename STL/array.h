@@ -0,0 +1,109 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <cstddef>
+#include <utility>
+#include "Trait.h"
+
+namespace CCSTL {
+    // 定长数组, 元素直接放在对象里, 不经过任何分配器.
+    // 是聚合类型, 用 array<int, 3> a = {1, 2, 3}; 初始化; T可以平凡复制时array也可以,
+    // 可以直接memcpy或放进共享内存. const成员在C++11下就是constexpr, 修改元素的成员要C++14.
+    // N为0时仍占一个元素的位置(T要能默认构造), size()是0, front/back没有意义
+    template <class T, size_t N>
+    struct array {
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        T elems[N ? N : 1];
+
+        // 迭代器
+        CCSTL_CONSTEXPR14 iterator begin() { return elems; }
+        constexpr const_iterator begin() const { return elems; }
+        CCSTL_CONSTEXPR14 iterator end() { return elems + N; }
+        constexpr const_iterator end() const { return elems + N; }
+        constexpr const_iterator cbegin() const { return elems; }
+        constexpr const_iterator cend() const { return elems + N; }
+
+        // 容量
+        constexpr size_type size() const { return N; }
+        constexpr size_type max_size() const { return N; }
+        constexpr bool empty() const { return N == 0; }
+
+        // 访问元素, 与vector一样不检查下标
+        CCSTL_CONSTEXPR14 reference operator[](size_type n) { return elems[n]; }
+        constexpr const_reference operator[](size_type n) const { return elems[n]; }
+        CCSTL_CONSTEXPR14 reference front() { return elems[0]; }
+        constexpr const_reference front() const { return elems[0]; }
+        CCSTL_CONSTEXPR14 reference back() { return elems[N - 1]; }
+        constexpr const_reference back() const { return elems[N - 1]; }
+        CCSTL_CONSTEXPR14 pointer data() { return elems; }
+        constexpr const_pointer data() const { return elems; }
+
+        // 修改. 循环而不是std::fill/std::swap, 后者在C++14中还不是constexpr
+        CCSTL_CONSTEXPR14 void fill(const T& x) {
+            for(size_type i = 0; i < N; ++i)
+                elems[i] = x;
+        }
+        CCSTL_CONSTEXPR14 void swap(array& a) {
+            for(size_type i = 0; i < N; ++i) {
+                T tmp = std::move(elems[i]);
+                elems[i] = std::move(a.elems[i]);
+                a.elems[i] = std::move(tmp);
+            }
+        }
+    };
+
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 bool operator==(const array<T, N>& a, const array<T, N>& b) {
+        for(size_t i = 0; i < N; ++i) {
+            if(!(a[i] == b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 bool operator!=(const array<T, N>& a, const array<T, N>& b) {
+        return !(a == b);
+    }
+
+    // 字典序
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 bool operator<(const array<T, N>& a, const array<T, N>& b) {
+        for(size_t i = 0; i < N; ++i) {
+            if(a[i] < b[i])
+                return true;
+            if(b[i] < a[i])
+                return false;
+        }
+        return false;
+    }
+
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 void swap(array<T, N>& a, array<T, N>& b) {
+        a.swap(b);
+    }
+
+    // 编译期下标, 越界时编译失败
+    template <size_t I, class T, size_t N>
+    constexpr T& get(array<T, N>& a) {
+        static_assert(I < N, "array index out of range");
+        return a.elems[I];
+    }
+
+    template <size_t I, class T, size_t N>
+    constexpr const T& get(const array<T, N>& a) {
+        static_assert(I < N, "array index out of range");
+        return a.elems[I];
+    }
+}
+
+#endif
@@ -0,0 +1,503 @@
+#ifndef BASIC_STRING_H
+#define BASIC_STRING_H
+
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include "Allocator.h"
+#include "string_view.h"
+#include "uninitialized.h"
+
+namespace CCSTL {
+    // 带短字符串优化(SSO)的字符串, 对象本身24字节(64位平台):
+    //   短字符串  字符直接存放在对象里, char最多22个, 加上结尾的'\0'和最后一个字节的长度
+    //   长字符串  {指针, 长度, 容量}, 缓冲区经由Alloc从内存池取得, 最后一个字节的最高位作为标记
+    // 最后一个字节在短字符串时就是长度(最高位为0), 长字符串时落在容量字段里, 编码容量时把这一位置1,
+    // 所以判断长短只要看一个字节. 扩容与vector共用uninitialized.h的策略, 至少翻倍;
+    // 查找和比较交给string_view.h, 较长的串上找子串时走Simd.cpp的向量内核
+    template <class CharT, class Traits = std::char_traits<CharT>, class Alloc = allocator<CharT>>
+    class basic_string {
+    public:
+        typedef CharT value_type;
+        typedef Traits traits_type;
+        typedef CharT* iterator;
+        typedef const CharT* const_iterator;
+        typedef CharT& reference;
+        typedef const CharT& const_reference;
+        typedef CharT* pointer;
+        typedef const CharT* const_pointer;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef basic_string_view<CharT, Traits> view_type;
+
+        static const size_type npos = size_type(-1);
+
+    private:
+        typedef Alloc data_allocator;
+
+        struct long_rep {
+            CharT* ptr;
+            size_type size;
+            size_type cap;      // 经过encode_cap, 不含结尾的'\0'
+        };
+
+        static const size_type rep_bytes = sizeof(long_rep);
+        static const size_type short_chars = (rep_bytes - 1) / sizeof(CharT);
+
+    public:
+        // 短字符串最多容纳的字符个数, 另外还要留一个给'\0'
+        static const size_type sso_capacity = short_chars - 1;
+
+    private:
+        union rep {
+            long_rep l;
+            CharT s[short_chars];
+            unsigned char raw[rep_bytes];
+        } r;
+
+        static const unsigned char long_flag = 0x80;
+
+        // 标记位要落在raw的最后一个字节上: 小端是容量的最高字节, 大端是最低字节
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        static size_type encode_cap(size_type cap) { return (cap << 8) | long_flag; }
+        static size_type decode_cap(size_type v) { return v >> 8; }
+#else
+        static size_type encode_cap(size_type cap) {
+            return cap | (size_type(long_flag) << (8 * (sizeof(size_type) - 1)));
+        }
+        static size_type decode_cap(size_type v) {
+            return v & ~(size_type(long_flag) << (8 * (sizeof(size_type) - 1)));
+        }
+#endif
+
+        bool is_long() const { return (r.raw[rep_bytes - 1] & long_flag) != 0; }
+
+        void init_empty() {
+            r.l.ptr = 0;
+            r.l.size = 0;
+            r.l.cap = 0;
+        }
+
+        void set_size(size_type n) {
+            if(is_long()) {
+                r.l.size = n;
+                r.l.ptr[n] = CharT();
+            } else {
+                r.raw[rep_bytes - 1] = static_cast<unsigned char>(n);
+                r.s[n] = CharT();
+            }
+        }
+
+        void set_long(CharT* p, size_type n, size_type cap) {
+            r.l.ptr = p;
+            r.l.size = n;
+            r.l.cap = encode_cap(cap);
+            p[n] = CharT();
+        }
+
+        static CharT* allocate(size_type cap) { return data_allocator::allocate(cap + 1); }
+
+        // 归还长字符串的缓冲区, 之后r的内容由调用者重新设置
+        void release() {
+            if(is_long())
+                data_allocator::deallocate(r.l.ptr, capacity() + 1);
+        }
+
+        // 换成容量为cap的缓冲区, 原有字符搬过去. cap不超过sso_capacity时回到短字符串
+        void reallocate(size_type cap) {
+            size_type n = size();
+            CharT* old = data();
+            if(cap <= sso_capacity) {
+                if(is_long()) {
+                    long_rep l = r.l;
+                    Traits::copy(r.s, l.ptr, n);
+                    data_allocator::deallocate(l.ptr, decode_cap(l.cap) + 1);
+                    r.raw[rep_bytes - 1] = 0;
+                    set_size(n);
+                }
+                return;
+            }
+            CharT* p = allocate(cap);
+            __uninitialized_relocate(old, old + n, p);
+            release();
+            set_long(p, n, cap);
+        }
+
+        // 保证还能再放下n个字符, 与vector一样至少翻倍
+        void grow_by(size_type n) {
+            size_type sz = size();
+            if(n > capacity() - sz)
+                reallocate(__grow_capacity(capacity(), sz + n));
+        }
+
+        void init(const CharT* s, size_type n) {
+            if(n <= sso_capacity) {
+                init_empty();
+                Traits::copy(r.s, s, n);
+                set_size(n);
+            } else {
+                CharT* p = allocate(n);
+                Traits::copy(p, s, n);
+                set_long(p, n, n);
+            }
+        }
+
+        void init(size_type n, CharT c) {
+            if(n <= sso_capacity) {
+                init_empty();
+                Traits::assign(r.s, n, c);
+                set_size(n);
+            } else {
+                CharT* p = allocate(n);
+                Traits::assign(p, n, c);
+                set_long(p, n, n);
+            }
+        }
+
+        // s是否指向自己的字符(包括结尾的'\0')
+        bool aliases(const CharT* s) const {
+            return std::less_equal<const CharT*>()(data(), s) &&
+                   std::less_equal<const CharT*>()(s, data() + size());
+        }
+
+    public:
+        basic_string() { init_empty(); }
+        basic_string(const CharT* s) { init(s, Traits::length(s)); }
+        basic_string(const CharT* s, size_type n) { init(s, n); }
+        basic_string(size_type n, CharT c) { init(n, c); }
+        basic_string(const CharT* first, const CharT* last) { init(first, last - first); }
+        basic_string(std::initializer_list<CharT> il) { init(il.begin(), il.size()); }
+        explicit basic_string(view_type v) { init(v.data(), v.size()); }
+        basic_string(const basic_string& x) { init(x.data(), x.size()); }
+        // 直接接管整个表示, 短字符串也只是复制24字节. 不抛异常, vector扩容时才会移动而不是复制
+        basic_string(basic_string&& x) noexcept {
+            r = x.r;
+            x.init_empty();
+        }
+        ~basic_string() { release(); }
+
+        basic_string& operator=(const basic_string& x) {
+            if(this != &x)
+                assign(x.data(), x.size());
+            return *this;
+        }
+        basic_string& operator=(basic_string&& x) noexcept {
+            if(this != &x) {
+                release();
+                r = x.r;
+                x.init_empty();
+            }
+            return *this;
+        }
+        basic_string& operator=(const CharT* s) { return assign(s, Traits::length(s)); }
+        basic_string& operator=(view_type v) { return assign(v.data(), v.size()); }
+        basic_string& operator=(CharT c) { return assign(&c, 1); }
+
+        // 放得下时就地复制(s可以指向自己), 否则换一块正好大小的缓冲区
+        basic_string& assign(const CharT* s, size_type n) {
+            if(n <= capacity()) {
+                Traits::move(data(), s, n);
+                set_size(n);
+            } else {
+                CharT* p = allocate(n);
+                Traits::copy(p, s, n);
+                release();
+                set_long(p, n, n);
+            }
+            return *this;
+        }
+        basic_string& assign(size_type n, CharT c) {
+            clear();
+            return append(n, c);
+        }
+
+        // 迭代器与访问
+        iterator begin() { return data(); }
+        const_iterator begin() const { return data(); }
+        iterator end() { return data() + size(); }
+        const_iterator end() const { return data() + size(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        CharT* data() { return is_long() ? r.l.ptr : r.s; }
+        const CharT* data() const { return is_long() ? r.l.ptr : r.s; }
+        const CharT* c_str() const { return data(); }
+
+        reference operator[](size_type pos) { return data()[pos]; }
+        const_reference operator[](size_type pos) const { return data()[pos]; }
+        reference front() { return data()[0]; }
+        const_reference front() const { return data()[0]; }
+        reference back() { return data()[size() - 1]; }
+        const_reference back() const { return data()[size() - 1]; }
+
+        operator view_type() const { return view_type(data(), size()); }
+        view_type view() const { return view_type(data(), size()); }
+
+        // 容量
+        size_type size() const { return is_long() ? r.l.size : r.raw[rep_bytes - 1]; }
+        size_type length() const { return size(); }
+        bool empty() const { return size() == 0; }
+        size_type capacity() const { return is_long() ? decode_cap(r.l.cap) : sso_capacity; }
+        size_type max_size() const { return decode_cap(size_type(-1)) - 1; }
+        bool is_inline() const { return !is_long(); }
+
+        void reserve(size_type n) {
+            if(n > capacity())
+                reallocate(n);
+        }
+        void shrink_to_fit() {
+            if(is_long() && size() < capacity())
+                reallocate(size());
+        }
+
+        // 修改
+        void clear() { set_size(0); }
+
+        // 逐字符追加是最常见的写法, 长短两种表示各自直接写入, 只有放不下时才走reallocate
+        void push_back(CharT c) {
+            if(is_long()) {
+                size_type sz = r.l.size;
+                if(sz < decode_cap(r.l.cap)) {
+                    r.l.ptr[sz] = c;
+                    r.l.ptr[sz + 1] = CharT();
+                    r.l.size = sz + 1;
+                    return;
+                }
+            } else {
+                size_type sz = r.raw[rep_bytes - 1];
+                if(sz < sso_capacity) {
+                    r.s[sz] = c;
+                    r.s[sz + 1] = CharT();
+                    r.raw[rep_bytes - 1] = static_cast<unsigned char>(sz + 1);
+                    return;
+                }
+            }
+            size_type sz = size();
+            reallocate(__grow_capacity(sz, sz + 1));
+            r.l.ptr[sz] = c;
+            set_size(sz + 1);
+        }
+        void pop_back() { set_size(size() - 1); }
+
+        // s可以指向自己: 扩容时旧缓冲区在复制完之后才释放
+        basic_string& append(const CharT* s, size_type n) {
+            size_type sz = size();
+            if(n > capacity() - sz) {
+                size_type cap = __grow_capacity(capacity(), sz + n);
+                CharT* p = allocate(cap);
+                CharT* old = data();
+                __uninitialized_relocate(old, old + sz, p);
+                Traits::copy(p + sz, s, n);
+                release();
+                set_long(p, sz + n, cap);
+            } else {
+                Traits::move(data() + sz, s, n);
+                set_size(sz + n);
+            }
+            return *this;
+        }
+        basic_string& append(const CharT* s) { return append(s, Traits::length(s)); }
+        basic_string& append(const basic_string& x) { return append(x.data(), x.size()); }
+        basic_string& append(view_type v) { return append(v.data(), v.size()); }
+        basic_string& append(size_type n, CharT c) {
+            grow_by(n);
+            size_type sz = size();
+            Traits::assign(data() + sz, n, c);
+            set_size(sz + n);
+            return *this;
+        }
+
+        basic_string& operator+=(const basic_string& x) { return append(x.data(), x.size()); }
+        basic_string& operator+=(const CharT* s) { return append(s); }
+        basic_string& operator+=(view_type v) { return append(v.data(), v.size()); }
+        basic_string& operator+=(CharT c) {
+            push_back(c);
+            return *this;
+        }
+
+        // 在pos处插入, pos不能超过size()
+        basic_string& insert(size_type pos, const CharT* s, size_type n) {
+            if(n == 0)
+                return *this;
+            if(aliases(s)) {
+                basic_string tmp(s, n);
+                return insert(pos, tmp.data(), n);
+            }
+            grow_by(n);
+            size_type sz = size();
+            CharT* p = data();
+            Traits::move(p + pos + n, p + pos, sz - pos);
+            Traits::copy(p + pos, s, n);
+            set_size(sz + n);
+            return *this;
+        }
+        basic_string& insert(size_type pos, const CharT* s) { return insert(pos, s, Traits::length(s)); }
+        basic_string& insert(size_type pos, view_type v) { return insert(pos, v.data(), v.size()); }
+        basic_string& insert(size_type pos, size_type n, CharT c) {
+            grow_by(n);
+            size_type sz = size();
+            CharT* p = data();
+            Traits::move(p + pos + n, p + pos, sz - pos);
+            Traits::assign(p + pos, n, c);
+            set_size(sz + n);
+            return *this;
+        }
+
+        // 删除从pos开始的n个字符, n超出时删到结尾
+        basic_string& erase(size_type pos = 0, size_type n = npos) {
+            size_type sz = size();
+            if(n > sz - pos)
+                n = sz - pos;
+            CharT* p = data();
+            Traits::move(p + pos, p + pos + n, sz - pos - n);
+            set_size(sz - n);
+            return *this;
+        }
+        iterator erase(const_iterator position) {
+            size_type pos = position - begin();
+            erase(pos, 1);
+            return begin() + pos;
+        }
+
+        void resize(size_type n, CharT c = CharT()) {
+            size_type sz = size();
+            if(n > sz)
+                append(n - sz, c);
+            else
+                set_size(n);
+        }
+
+        void swap(basic_string& x) noexcept {
+            rep tmp = r;
+            r = x.r;
+            x.r = tmp;
+        }
+
+        // 查找, 找不到返回npos
+        size_type find(CharT c, size_type pos = 0) const { return view().find(c, pos); }
+        size_type find(view_type v, size_type pos = 0) const { return view().find(v, pos); }
+        size_type find(const CharT* s, size_type pos = 0) const { return view().find(view_type(s), pos); }
+        size_type find(const basic_string& x, size_type pos = 0) const { return view().find(x.view(), pos); }
+        size_type rfind(CharT c, size_type pos = npos) const { return view().rfind(c, pos); }
+        size_type rfind(view_type v, size_type pos = npos) const { return view().rfind(v, pos); }
+        bool contains(view_type v) const { return view().find(v) != npos; }
+        bool contains(CharT c) const { return view().find(c) != npos; }
+        bool starts_with(view_type v) const { return view().starts_with(v); }
+        bool ends_with(view_type v) const { return view().ends_with(v); }
+
+        int compare(view_type v) const {
+            return __str_compare<CharT, Traits>(data(), size(), v.data(), v.size());
+        }
+        int compare(const basic_string& x) const { return compare(x.view()); }
+        int compare(const CharT* s) const { return compare(view_type(s)); }
+
+        basic_string substr(size_type pos = 0, size_type n = npos) const {
+            view_type v = view().substr(pos, n);
+            return basic_string(v.data(), v.size());
+        }
+    };
+
+    template <class CharT, class Traits, class Alloc>
+    const typename basic_string<CharT, Traits, Alloc>::size_type basic_string<CharT, Traits, Alloc>::npos;
+    template <class CharT, class Traits, class Alloc>
+    const typename basic_string<CharT, Traits, Alloc>::size_type basic_string<CharT, Traits, Alloc>::sso_capacity;
+
+    // 拼接, 左侧是右值时直接在它上面追加
+    template <class CharT, class Traits, class Alloc>
+    basic_string<CharT, Traits, Alloc> operator+(const basic_string<CharT, Traits, Alloc>& a,
+                                                 const basic_string<CharT, Traits, Alloc>& b) {
+        basic_string<CharT, Traits, Alloc> r;
+        r.reserve(a.size() + b.size());
+        r.append(a.data(), a.size());
+        r.append(b.data(), b.size());
+        return r;
+    }
+    template <class CharT, class Traits, class Alloc>
+    basic_string<CharT, Traits, Alloc> operator+(basic_string<CharT, Traits, Alloc>&& a,
+                                                 const basic_string<CharT, Traits, Alloc>& b) {
+        a.append(b.data(), b.size());
+        return std::move(a);
+    }
+    template <class CharT, class Traits, class Alloc>
+    basic_string<CharT, Traits, Alloc> operator+(const basic_string<CharT, Traits, Alloc>& a, const CharT* b) {
+        basic_string<CharT, Traits, Alloc> r(a);
+        r.append(b);
+        return r;
+    }
+    template <class CharT, class Traits, class Alloc>
+    basic_string<CharT, Traits, Alloc> operator+(basic_string<CharT, Traits, Alloc>&& a, const CharT* b) {
+        a.append(b);
+        return std::move(a);
+    }
+    template <class CharT, class Traits, class Alloc>
+    basic_string<CharT, Traits, Alloc> operator+(const basic_string<CharT, Traits, Alloc>& a, CharT c) {
+        basic_string<CharT, Traits, Alloc> r(a);
+        r.push_back(c);
+        return r;
+    }
+    template <class CharT, class Traits, class Alloc>
+    basic_string<CharT, Traits, Alloc> operator+(basic_string<CharT, Traits, Alloc>&& a, CharT c) {
+        a.push_back(c);
+        return std::move(a);
+    }
+
+    // 比较, 相等先比长度
+    template <class CharT, class Traits, class Alloc>
+    bool operator==(const basic_string<CharT, Traits, Alloc>& a, const basic_string<CharT, Traits, Alloc>& b) {
+        return a.size() == b.size() && Traits::compare(a.data(), b.data(), a.size()) == 0;
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator==(const basic_string<CharT, Traits, Alloc>& a, const CharT* b) {
+        return a.compare(b) == 0;
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator==(const CharT* a, const basic_string<CharT, Traits, Alloc>& b) {
+        return b.compare(a) == 0;
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator!=(const basic_string<CharT, Traits, Alloc>& a, const basic_string<CharT, Traits, Alloc>& b) {
+        return !(a == b);
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator!=(const basic_string<CharT, Traits, Alloc>& a, const CharT* b) {
+        return !(a == b);
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator!=(const CharT* a, const basic_string<CharT, Traits, Alloc>& b) {
+        return !(a == b);
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator<(const basic_string<CharT, Traits, Alloc>& a, const basic_string<CharT, Traits, Alloc>& b) {
+        return a.compare(b) < 0;
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator>(const basic_string<CharT, Traits, Alloc>& a, const basic_string<CharT, Traits, Alloc>& b) {
+        return a.compare(b) > 0;
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator<=(const basic_string<CharT, Traits, Alloc>& a, const basic_string<CharT, Traits, Alloc>& b) {
+        return a.compare(b) <= 0;
+    }
+    template <class CharT, class Traits, class Alloc>
+    bool operator>=(const basic_string<CharT, Traits, Alloc>& a, const basic_string<CharT, Traits, Alloc>& b) {
+        return a.compare(b) >= 0;
+    }
+
+    template <class CharT, class Traits, class Alloc>
+    void swap(basic_string<CharT, Traits, Alloc>& a, basic_string<CharT, Traits, Alloc>& b) {
+        a.swap(b);
+    }
+
+    template <class CharT, class Traits, class Alloc>
+    std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
+                                                  const basic_string<CharT, Traits, Alloc>& s) {
+        return os.write(s.data(), s.size());
+    }
+
+    typedef basic_string<char> string;
+    typedef basic_string<wchar_t> wstring;
+}
+
+#endif
@@ -0,0 +1,252 @@
+// stack/queue在各种底层容器上的吞吐量和内存占用, 与std::stack/std::queue(默认std::deque)对比
+//   g++ -O2 -std=c++11 -I.. adapter_bench.cpp ../Alloc.cpp ../Simd.cpp -o adapter_bench
+//   ./adapter_bench [元素个数]
+// fill+drain  先push n个再全部pop出来, 每次都从空容器开始, 包含扩容/分配缓冲区的开销
+// steady      队列里保持n个元素, 反复push一个pop一个: 容量稳定之后的常态
+// bulk        push_range一次压入n个(随机访问区间, 能预留的容器先预留好)再全部pop
+// 每行是平摊到每个元素(或每对push+pop)的纳秒数.
+// footprint是装着n个元素时底层容器持有的字节数平摊到每个元素: CCSTL容器按容量/缓冲区/节点大小算出,
+// std容器用计数分配器统计请求的字节数(都不含malloc自身的头部)
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <queue>
+#include <stack>
+#include <vector>
+#include "bench.h"
+#include "../List.h"
+#include "../deque.h"
+#include "../queue.h"
+#include "../ring_buffer.h"
+#include "../stack.h"
+#include "../vector.h"
+
+static size_t nelems = 1 << 20;
+
+static void report(const char* op, const char* impl, double sec, size_t per) {
+	printf("%-12s %-24s %10.3f ns\n", op, impl, sec * 1e9 / per);
+}
+
+static void report_bytes(const char* impl, size_t bytes) {
+	printf("%-12s %-24s %10.2f bytes/elem\n", "footprint", impl, double(bytes) / nelems);
+}
+
+// ---------------------------------------------------------------
+// 吞吐量
+// ---------------------------------------------------------------
+template <class Stack>
+static double stack_fill_drain() {
+	return bench::measure([] {
+		Stack s;
+		for(size_t i = 0; i < nelems; ++i)
+			s.push(long(i));
+		long sum = 0;
+		while(!s.empty()) {
+			sum += s.top();
+			s.pop();
+		}
+		bench::keep(sum);
+	});
+}
+
+template <class Stack>
+static double stack_steady() {
+	Stack s;
+	for(size_t i = 0; i < nelems; ++i)
+		s.push(long(i));
+	return bench::measure([&] {
+		long sum = 0;
+		for(size_t i = 0; i < nelems; ++i) {
+			s.push(long(i));
+			sum += s.top();
+			s.pop();
+		}
+		bench::keep(sum);
+	});
+}
+
+template <class Stack>
+static double stack_bulk(const CCSTL::vector<long>& src) {
+	return bench::measure([&] {
+		Stack s;
+		s.push_range(src);
+		long sum = 0;
+		while(!s.empty()) {
+			sum += s.top();
+			s.pop();
+		}
+		bench::keep(sum);
+	});
+}
+
+template <class Queue>
+static double queue_fill_drain() {
+	return bench::measure([] {
+		Queue q;
+		for(size_t i = 0; i < nelems; ++i)
+			q.push(long(i));
+		long sum = 0;
+		while(!q.empty()) {
+			sum += q.front();
+			q.pop();
+		}
+		bench::keep(sum);
+	});
+}
+
+template <class Queue>
+static double queue_steady() {
+	Queue q;
+	for(size_t i = 0; i < nelems; ++i)
+		q.push(long(i));
+	return bench::measure([&] {
+		long sum = 0;
+		for(size_t i = 0; i < nelems; ++i) {
+			q.push(long(i));
+			sum += q.front();
+			q.pop();
+		}
+		bench::keep(sum);
+	});
+}
+
+template <class Queue>
+static double queue_bulk(const CCSTL::vector<long>& src) {
+	return bench::measure([&] {
+		Queue q;
+		q.push_range(src);
+		long sum = 0;
+		while(!q.empty()) {
+			sum += q.front();
+			q.pop();
+		}
+		bench::keep(sum);
+	});
+}
+
+// ---------------------------------------------------------------
+// 内存占用
+// ---------------------------------------------------------------
+static size_t counted_bytes = 0;
+
+// 只为统计std容器申请的字节数
+template <class T>
+struct counting_allocator {
+	typedef T value_type;
+
+	counting_allocator() {}
+	template <class U>
+	counting_allocator(const counting_allocator<U>&) {}
+
+	T* allocate(size_t n) {
+		counted_bytes += n * sizeof(T);
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+	void deallocate(T* p, size_t n) {
+		counted_bytes -= n * sizeof(T);
+		::operator delete(p);
+	}
+
+	template <class U>
+	bool operator==(const counting_allocator<U>&) const { return true; }
+	template <class U>
+	bool operator!=(const counting_allocator<U>&) const { return false; }
+};
+
+template <class Container>
+static void std_footprint(const char* impl) {
+	size_t before = counted_bytes;
+	{
+		Container c;
+		for(size_t i = 0; i < nelems; ++i)
+			c.push_back(long(i));
+		report_bytes(impl, counted_bytes - before);
+	}
+}
+
+// 取得deque的缓冲区个数和map的大小
+struct deque_probe: CCSTL::deque<long> {
+	size_t bytes() const {
+		size_t buffers = size_t(finish.node - start.node) + 1;
+		return buffers * buffer_size() * sizeof(long) + map_size * sizeof(long*);
+	}
+};
+
+static void ccstl_footprint() {
+	{
+		CCSTL::vector<long> v;
+		for(size_t i = 0; i < nelems; ++i)
+			v.push_back(long(i));
+		report_bytes("CCSTL vector", size_t(v.capacity()) * sizeof(long));
+	}
+	{
+		deque_probe d;
+		for(size_t i = 0; i < nelems; ++i)
+			d.push_back(long(i));
+		report_bytes("CCSTL deque", d.bytes());
+	}
+	{
+		// 节点从alloc的内存池里取, 按8字节对齐, 没有额外的头部
+		size_t node_bytes = (sizeof(CCSTL::list_node<long>) + 7) & ~size_t(7);
+		report_bytes("CCSTL list", nelems * node_bytes);
+	}
+	{
+		CCSTL::ring_buffer<long> r;
+		for(size_t i = 0; i < nelems; ++i)
+			r.push_back(long(i));
+		report_bytes("CCSTL ring_buffer", r.capacity() * sizeof(long));
+	}
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		nelems = strtoull(argv[1], 0, 10);
+	printf("%zu elements of %zu bytes\n", nelems, sizeof(long));
+
+	CCSTL::vector<long> src;
+	for(size_t i = 0; i < nelems; ++i)
+		src.push_back(long(i));
+
+	typedef CCSTL::stack<long> stack_vector;
+	typedef CCSTL::stack<long, CCSTL::deque<long> > stack_deque;
+	typedef CCSTL::stack<long, CCSTL::list<long> > stack_list;
+	typedef std::stack<long> std_stack;
+
+	report("fill+drain", "stack<vector>", stack_fill_drain<stack_vector>(), nelems);
+	report("fill+drain", "stack<deque>", stack_fill_drain<stack_deque>(), nelems);
+	report("fill+drain", "stack<list>", stack_fill_drain<stack_list>(), nelems);
+	report("fill+drain", "std::stack", stack_fill_drain<std_stack>(), nelems);
+	report("steady", "stack<vector>", stack_steady<stack_vector>(), nelems);
+	report("steady", "stack<deque>", stack_steady<stack_deque>(), nelems);
+	report("steady", "stack<list>", stack_steady<stack_list>(), nelems);
+	report("steady", "std::stack", stack_steady<std_stack>(), nelems);
+	report("bulk", "stack<vector>", stack_bulk<stack_vector>(src), nelems);
+	report("bulk", "stack<deque>", stack_bulk<stack_deque>(src), nelems);
+	report("bulk", "stack<list>", stack_bulk<stack_list>(src), nelems);
+	printf("\n");
+
+	// queue<vector>每次pop都要移动其余元素, 是O(n^2), 这里不测
+	typedef CCSTL::queue<long> queue_ring;
+	typedef CCSTL::queue<long, CCSTL::deque<long> > queue_deque;
+	typedef CCSTL::queue<long, CCSTL::list<long> > queue_list;
+	typedef std::queue<long> std_queue;
+
+	report("fill+drain", "queue<ring_buffer>", queue_fill_drain<queue_ring>(), nelems);
+	report("fill+drain", "queue<deque>", queue_fill_drain<queue_deque>(), nelems);
+	report("fill+drain", "queue<list>", queue_fill_drain<queue_list>(), nelems);
+	report("fill+drain", "std::queue", queue_fill_drain<std_queue>(), nelems);
+	report("steady", "queue<ring_buffer>", queue_steady<queue_ring>(), nelems);
+	report("steady", "queue<deque>", queue_steady<queue_deque>(), nelems);
+	report("steady", "queue<list>", queue_steady<queue_list>(), nelems);
+	report("steady", "std::queue", queue_steady<std_queue>(), nelems);
+	report("bulk", "queue<ring_buffer>", queue_bulk<queue_ring>(src), nelems);
+	report("bulk", "queue<deque>", queue_bulk<queue_deque>(src), nelems);
+	report("bulk", "queue<list>", queue_bulk<queue_list>(src), nelems);
+	printf("\n");
+
+	ccstl_footprint();
+	std_footprint<std::vector<long, counting_allocator<long> > >("std::vector");
+	std_footprint<std::deque<long, counting_allocator<long> > >("std::deque");
+	std_footprint<std::list<long, counting_allocator<long> > >("std::list");
+	return 0;
+}
@@ -0,0 +1,86 @@
+// algorithm.h 中各个内核的微基准: 每个内核 x 每种元素宽度 x 每个CPU等级
+//   g++ -O2 -std=c++11 -I.. algorithm_bench.cpp ../Alloc.cpp ../Simd.cpp -o algorithm_bench
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "bench.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+static const size_t BYTES = 1 << 20;     // 1 MiB, 落在L2/L3中
+static const char* LEVEL_NAME[] = { "scalar", "sse2", "avx2" };
+
+static void report(const char* kernel, size_t width, int level, double sec) {
+	printf("%-14s %2zu-byte %-7s %8.2f GB/s\n",
+	       kernel, width, LEVEL_NAME[level], BYTES / sec / 1e9);
+}
+
+template <class T>
+static void bench_width(int level) {
+	const size_t n = BYTES / sizeof(T);
+	std::vector<T> a(n), b(n);
+	for(size_t i = 0; i < n; ++i)
+		a[i] = b[i] = T(rand() % 100);
+	// 目标值放在最后, 让find/mismatch扫完整个区间
+	a[n - 1] = T(101);
+	b[n - 1] = T(102);
+	T* first = &a[0];
+	T* last = first + n;
+
+	report("find", sizeof(T), level, bench::measure([&] {
+		bench::keep(CCSTL::find(first, last, T(101)));
+	}));
+	report("count", sizeof(T), level, bench::measure([&] {
+		bench::keep(CCSTL::count(first, last, T(7)));
+	}));
+	report("mismatch", sizeof(T), level, bench::measure([&] {
+		bench::keep(CCSTL::mismatch(first, last, &b[0]).first);
+	}));
+}
+
+template <class T>
+static void bench_reduce(int level) {
+	const size_t n = BYTES / sizeof(T);
+	std::vector<T> a(n);
+	for(size_t i = 0; i < n; ++i)
+		a[i] = T(rand());
+	T* first = &a[0];
+	T* last = first + n;
+
+	report("accumulate", sizeof(T), level, bench::measure([&] {
+		bench::keep(CCSTL::accumulate(first, last, T(0)));
+	}));
+	if(sizeof(T) == 4) {
+		report("min_element", sizeof(T), level, bench::measure([&] {
+			bench::keep(CCSTL::min_element(first, last));
+		}));
+		report("max_element", sizeof(T), level, bench::measure([&] {
+			bench::keep(CCSTL::max_element(first, last));
+		}));
+	}
+}
+
+static void bench_vector_equal(int level) {
+	CCSTL::vector<int> a(BYTES / sizeof(int), 5);
+	CCSTL::vector<int> b(BYTES / sizeof(int), 5);
+	report("vector==", sizeof(int), level, bench::measure([&] {
+		bench::keep(a == b);
+	}));
+}
+
+int main() {
+	printf("detected cpu level: %s\n", LEVEL_NAME[simd::detect_cpu()]);
+	for(int level = simd::CPU_SCALAR; level <= simd::detect_cpu(); ++level) {
+		simd::set_cpu_level(simd::cpu_level(level));
+		bench_width<uint8_t>(level);
+		bench_width<uint16_t>(level);
+		bench_width<uint32_t>(level);
+		bench_width<uint64_t>(level);
+		bench_reduce<int32_t>(level);
+		bench_reduce<uint32_t>(level);
+		bench_reduce<int64_t>(level);
+		bench_vector_equal(level);
+	}
+	return 0;
+}
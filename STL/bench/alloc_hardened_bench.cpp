@@ -0,0 +1,84 @@
+// alloc加固模式的开销: 同一份代码分别按普通模式和CCSTL_ALLOC_HARDENED编译, 比较两次的输出
+//   g++ -O2 -std=c++11 -I.. alloc_hardened_bench.cpp ../Alloc.cpp ../Simd.cpp -o alloc_bench
+//   g++ -O2 -std=c++11 -DCCSTL_ALLOC_HARDENED -I.. alloc_hardened_bench.cpp ../Alloc.cpp ../Simd.cpp -o alloc_bench_hardened
+#include <cstdlib>
+#include "bench.h"
+#include "../Alloc.h"
+#include "../List.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+#ifdef CCSTL_ALLOC_HARDENED
+static const char* mode = "hardened";
+#else
+static const char* mode = "plain";
+#endif
+
+int main(int argc, char** argv) {
+	size_t n = argc > 1 ? strtoull(argv[1], 0, 10) : 100000;
+
+	// 固定大小的分配/释放, 全部命中free list
+	static const size_t sizes[] = {8, 24, 64, 128};
+	for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		size_t bytes = sizes[s];
+		void** ps = new void*[n];
+		double sec = bench::measure([&] {
+			for(size_t i = 0; i < n; ++i)
+				ps[i] = alloc::allocate(bytes);
+			for(size_t i = 0; i < n; ++i)
+				alloc::deallocate(ps[i], bytes);
+		});
+		printf("%-9s allocate+deallocate %3zu B  %8.2f ns/pair\n", mode, bytes, sec / n * 1e9);
+		delete[] ps;
+	}
+
+	// 混合大小, 分配与释放交错
+	{
+		const size_t live = 1024;
+		void* ps[live] = {0};
+		size_t sz[live] = {0};
+		unsigned long long rng = 88172645463325252ull;
+		double sec = bench::measure([&] {
+			for(size_t i = 0; i < n; ++i) {
+				rng ^= rng << 13;
+				rng ^= rng >> 7;
+				rng ^= rng << 17;
+				size_t k = rng % live;
+				if(ps[k])
+					alloc::deallocate(ps[k], sz[k]);
+				sz[k] = 1 + (rng >> 32) % 128;
+				ps[k] = alloc::allocate(sz[k]);
+			}
+		});
+		printf("%-9s mixed sizes 1..128 B        %8.2f ns/op\n", mode, sec / n * 1e9);
+		for(size_t k = 0; k < live; ++k) {
+			if(ps[k])
+				alloc::deallocate(ps[k], sz[k]);
+		}
+	}
+
+	// 容器: 每个节点一次分配
+	{
+		double sec = bench::measure([&] {
+			list<long> l;
+			for(size_t i = 0; i < n; ++i)
+				l.push_back(long(i));
+			while(!l.empty())
+				l.pop_front();
+		});
+		printf("%-9s list push_back+pop_front    %8.2f ns/element\n", mode, sec / n * 1e9);
+	}
+	{
+		double sec = bench::measure([&] {
+			for(size_t i = 0; i < n / 16; ++i) {
+				vector<int> v;
+				for(int k = 0; k < 16; ++k)
+					v.push_back(k);
+				bench::keep(v[0]);
+			}
+		});
+		printf("%-9s small vector growth (16)   %8.2f ns/element\n", mode, sec / n * 1e9);
+	}
+	return 0;
+}
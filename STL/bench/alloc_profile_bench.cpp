@@ -0,0 +1,77 @@
+// alloc采样分析的开销: 同一份代码分别按普通模式和CCSTL_ALLOC_PROFILE编译, 比较两次的输出
+//   g++ -O2 -std=c++11 -I.. alloc_profile_bench.cpp ../Alloc.cpp ../Simd.cpp -o alloc_bench
+//   g++ -O2 -std=c++11 -rdynamic -DCCSTL_ALLOC_PROFILE -I.. alloc_profile_bench.cpp ../Alloc.cpp ../AllocProfile.cpp ../Simd.cpp -o alloc_bench_profile
+//   ./alloc_bench_profile [元素个数] [采样间隔字节数] [输出文件前缀]
+// 分析模式下会写出 前缀.heap(pprof) 和 前缀.live.folded / 前缀.cumulative.folded
+#include <cstdlib>
+#include <string>
+#include "bench.h"
+#include "../Alloc.h"
+#include "../AllocProfile.h"
+#include "../List.h"
+#include "../vector.h"
+#include "../deque.h"
+
+using namespace CCSTL;
+
+#ifdef CCSTL_ALLOC_PROFILE
+static const char* mode = "profile";
+#else
+static const char* mode = "plain";
+#endif
+
+// 调用栈上分开的几个函数, 折叠栈中可以看到各自的份额
+__attribute__((noinline)) static void list_churn(size_t n) {
+	list<long> l;
+	for(size_t i = 0; i < n; ++i)
+		l.push_back(long(i));
+	while(!l.empty())
+		l.pop_front();
+}
+
+__attribute__((noinline)) static void small_vectors(size_t n) {
+	for(size_t i = 0; i < n / 16; ++i) {
+		vector<int> v;
+		for(int k = 0; k < 16; ++k)
+			v.push_back(k);
+		bench::keep(v[0]);
+	}
+}
+
+__attribute__((noinline)) static void raw_pairs(size_t n) {
+	for(size_t i = 0; i < n; ++i) {
+		void* p = alloc::allocate(24);
+		bench::keep(p);
+		alloc::deallocate(p, 24);
+	}
+}
+
+int main(int argc, char** argv) {
+	size_t n = argc > 1 ? strtoull(argv[1], 0, 10) : 100000;
+#ifdef CCSTL_ALLOC_PROFILE
+	if(argc > 2)
+		alloc_profiler::set_sample_rate(strtoull(argv[2], 0, 10));
+	printf("sample rate %zu bytes\n", alloc_profiler::sample_rate());
+#endif
+
+	double sec = bench::measure([&] { raw_pairs(n); });
+	printf("%-8s allocate+deallocate 24 B  %8.2f ns/pair\n", mode, sec / n * 1e9);
+	sec = bench::measure([&] { list_churn(n); });
+	printf("%-8s list push_back+pop_front  %8.2f ns/element\n", mode, sec / n * 1e9);
+	sec = bench::measure([&] { small_vectors(n); });
+	printf("%-8s small vector growth (16)  %8.2f ns/element\n", mode, sec / n * 1e9);
+
+	// 留一些活着的对象, live profile中应当只剩下它们
+	deque<long> kept;
+	for(size_t i = 0; i < n; ++i)
+		kept.push_back(long(i));
+
+#ifdef CCSTL_ALLOC_PROFILE
+	std::string prefix = argc > 3 ? argv[3] : "/tmp/alloc_profile";
+	alloc_profiler::dump_pprof((prefix + ".heap").c_str());
+	alloc_profiler::dump_folded((prefix + ".live.folded").c_str(), alloc_profiler::LIVE);
+	alloc_profiler::dump_folded((prefix + ".cumulative.folded").c_str(), alloc_profiler::CUMULATIVE);
+	printf("%zu samples, profiles written to %s.*\n", alloc_profiler::samples(), prefix.c_str());
+#endif
+	return 0;
+}
@@ -0,0 +1,288 @@
+// 把alloc_trace记录的分配轨迹重放到不同的分配策略上,
+// 报告吞吐量、延迟分位数、峰值RSS和碎片率
+//   g++ -O2 -std=c++11 -I.. alloc_replay.cpp ../Alloc.cpp ../AllocTrace.cpp ../MmapAlloc.cpp -o alloc_replay
+//   ./alloc_replay 轨迹文件 [策略...]
+// 策略默认为全部: alloc, alloc_hugepage, malloc.
+// 增加一种策略只需仿照下面的xxx_policy写一个结构, 再加进policies表.
+//
+// 每种策略的吞吐量和延迟各在一个新进程中测量, 互不影响内存池的状态和RSS.
+// 轨迹按记录的顺序单线程重放(alloc不是线程安全的), 线程编号只做统计.
+// 碎片率 = 1 - 峰值存活字节数 / (峰值RSS - 重放前的RSS); 每个块分配后按页写一次, 让RSS反映真实占用
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "bench.h"
+#include "../Alloc.h"
+#include "../AllocTrace.h"
+#include "../MmapAlloc.h"
+
+using namespace CCSTL;
+
+// ---------------------------------------------------------------
+// 分配策略: 接口与alloc相同
+// ---------------------------------------------------------------
+struct alloc_policy {
+	static void setup() {}
+	static void* allocate(size_t n) { return alloc::allocate(n); }
+	static void deallocate(void* p, size_t n) { alloc::deallocate(p, n); }
+};
+
+struct alloc_hugepage_policy {
+	static void setup() { alloc::set_chunk_provider(huge_page_arena::allocate); }
+	static void* allocate(size_t n) { return alloc::allocate(n); }
+	static void deallocate(void* p, size_t n) { alloc::deallocate(p, n); }
+};
+
+struct malloc_policy {
+	static void setup() {}
+	static void* allocate(size_t n) { return malloc(n); }
+	static void deallocate(void* p, size_t) { free(p); }
+};
+
+// ---------------------------------------------------------------
+// 轨迹
+// ---------------------------------------------------------------
+struct replay_event {
+	uint64_t size;
+	uint32_t id;
+	uint8_t op;
+};
+
+struct trace_info {
+	std::vector<replay_event> events;
+	size_t max_id;
+	size_t threads;
+	size_t allocations;
+	size_t peak_live_bytes;
+	double duration_sec;   // 记录时的时长
+};
+
+static bool load_trace(const char* path, trace_info& t) {
+	alloc_trace::reader r;
+	if(!r.open(path))
+		return false;
+	std::vector<uint64_t> sizes;
+	std::vector<bool> threads;
+	alloc_trace::event e;
+	size_t live = 0;
+	uint64_t ns = 0;
+	t.max_id = t.threads = t.allocations = t.peak_live_bytes = 0;
+	while(r.next(e)) {
+		replay_event x;
+		x.size = e.size;
+		x.id = uint32_t(e.id);
+		x.op = e.op;
+		t.events.push_back(x);
+		ns += e.delta_ns;
+		if(e.id >= sizes.size())
+			sizes.resize(e.id + 1);
+		if(e.id + 1 > t.max_id)
+			t.max_id = e.id + 1;
+		if(e.thread >= threads.size())
+			threads.resize(e.thread + 1);
+		threads[e.thread] = true;
+		if(e.op == alloc_trace::ALLOCATE) {
+			++t.allocations;
+			sizes[e.id] = e.size;
+			live += e.size;
+			t.peak_live_bytes = std::max(t.peak_live_bytes, live);
+		} else {
+			live -= sizes[e.id];
+		}
+	}
+	t.threads = size_t(std::count(threads.begin(), threads.end(), true));
+	t.duration_sec = ns * 1e-9;
+	return true;
+}
+
+// ---------------------------------------------------------------
+// 计时
+// ---------------------------------------------------------------
+static inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return uint64_t(bench::now_sec() * 1e9);
+#endif
+}
+
+static double ns_per_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+	double s0 = bench::now_sec();
+	uint64_t t0 = ticks();
+	while(bench::now_sec() - s0 < 0.05) {}
+	return (bench::now_sec() - s0) * 1e9 / double(ticks() - t0);
+#else
+	return 1.0;
+#endif
+}
+
+// 计时本身的开销, 从每次测得的时间中减去
+static uint64_t tick_overhead() {
+	std::vector<uint64_t> v(1000);
+	for(size_t i = 0; i < v.size(); ++i) {
+		uint64_t t0 = ticks();
+		v[i] = ticks() - t0;
+	}
+	std::sort(v.begin(), v.end());
+	return v[v.size() / 2];
+}
+
+// 把malloc中已释放但仍驻留的内存还给系统, 否则重放时被重新使用, RSS不会增长
+static void trim_heap() {
+#ifdef __GLIBC__
+	malloc_trim(0);
+#endif
+}
+
+static long rss_kb() {
+	FILE* f = fopen("/proc/self/statm", "r");
+	long pages = 0, resident = 0;
+	if(f) {
+		if(fscanf(f, "%ld %ld", &pages, &resident) != 2)
+			resident = 0;
+		fclose(f);
+	}
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static inline void touch(void* p, size_t n) {
+	char* c = static_cast<char*>(p);
+	for(size_t off = 0; off < n; off += 4096)
+		c[off] = 1;
+}
+
+// ---------------------------------------------------------------
+// 重放
+// ---------------------------------------------------------------
+template <class Policy>
+static void replay_throughput(const char* name, const trace_info& t) {
+	Policy::setup();
+	std::vector<void*> objects(t.max_id, (void*)0);
+	trim_heap();
+	long base_kb = rss_kb();
+	double start = bench::now_sec();
+	for(size_t i = 0; i < t.events.size(); ++i) {
+		const replay_event& e = t.events[i];
+		if(e.op == alloc_trace::ALLOCATE) {
+			void* p = Policy::allocate(e.size);
+			touch(p, e.size);
+			objects[e.id] = p;
+		} else {
+			Policy::deallocate(objects[e.id], e.size);
+		}
+	}
+	double sec = bench::now_sec() - start;
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	double peak_mb = (ru.ru_maxrss - base_kb) / 1024.0;
+	double live_mb = t.peak_live_bytes / 1048576.0;
+	double frag = peak_mb > 0 ? 1.0 - live_mb / peak_mb : 0;
+	printf("%-15s %9.2f Mops/s  peak RSS +%8.1f MB  fragmentation %5.1f%%\n",
+	       name, t.events.size() / sec / 1e6, peak_mb, frag * 100);
+}
+
+static inline uint32_t elapsed(uint64_t t0, uint64_t t1, uint64_t overhead) {
+	uint64_t d = t1 - t0;
+	d = d > overhead ? d - overhead : 0;
+	return uint32_t(std::min<uint64_t>(d, 0xffffffffu));
+}
+
+static void print_percentiles(const char* name, const char* op, std::vector<uint32_t>& v, double scale) {
+	if(v.empty())
+		return;
+	std::sort(v.begin(), v.end());
+	const double qs[] = {0.5, 0.9, 0.99, 0.999};
+	printf("%-15s %-10s", name, op);
+	for(size_t i = 0; i < sizeof(qs) / sizeof(qs[0]); ++i)
+		printf("  p%-5g %7.0f", qs[i] * 100, v[size_t(qs[i] * (v.size() - 1))] * scale);
+	printf("  max %9.0f ns\n", v.back() * scale);
+}
+
+template <class Policy>
+static void replay_latency(const char* name, const trace_info& t) {
+	Policy::setup();
+	double scale = ns_per_tick();
+	uint64_t overhead = tick_overhead();
+	std::vector<void*> objects(t.max_id, (void*)0);
+	std::vector<uint32_t> alloc_ticks, free_ticks;
+	alloc_ticks.reserve(t.allocations);
+	free_ticks.reserve(t.events.size() - t.allocations);
+	for(size_t i = 0; i < t.events.size(); ++i) {
+		const replay_event& e = t.events[i];
+		if(e.op == alloc_trace::ALLOCATE) {
+			uint64_t t0 = ticks();
+			void* p = Policy::allocate(e.size);
+			uint64_t t1 = ticks();
+			alloc_ticks.push_back(elapsed(t0, t1, overhead));
+			touch(p, e.size);
+			objects[e.id] = p;
+		} else {
+			uint64_t t0 = ticks();
+			Policy::deallocate(objects[e.id], e.size);
+			uint64_t t1 = ticks();
+			free_ticks.push_back(elapsed(t0, t1, overhead));
+		}
+	}
+	print_percentiles(name, "allocate", alloc_ticks, scale);
+	print_percentiles(name, "deallocate", free_ticks, scale);
+}
+
+struct policy_entry {
+	const char* name;
+	void (*throughput)(const char*, const trace_info&);
+	void (*latency)(const char*, const trace_info&);
+};
+
+static const policy_entry policies[] = {
+	{"alloc", replay_throughput<alloc_policy>, replay_latency<alloc_policy>},
+	{"alloc_hugepage", replay_throughput<alloc_hugepage_policy>, replay_latency<alloc_hugepage_policy>},
+	{"malloc", replay_throughput<malloc_policy>, replay_latency<malloc_policy>},
+};
+
+static void in_child(void (*f)(const char*, const trace_info&), const char* name, const trace_info& t) {
+	fflush(stdout);
+	pid_t pid = fork();
+	if(pid == 0) {
+		f(name, t);
+		fflush(stdout);
+		_exit(0);
+	}
+	waitpid(pid, 0, 0);
+}
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		fprintf(stderr, "usage: %s trace [policy...]\n", argv[0]);
+		return 1;
+	}
+	trace_info t;
+	if(!load_trace(argv[1], t)) {
+		fprintf(stderr, "cannot read trace %s\n", argv[1]);
+		return 1;
+	}
+	printf("%s: %zu events, %zu allocations, %zu threads, peak live %.1f MB, recorded in %.3f s\n",
+	       argv[1], t.events.size(), t.allocations, t.threads, t.peak_live_bytes / 1048576.0, t.duration_sec);
+
+	const size_t npolicies = sizeof(policies) / sizeof(policies[0]);
+	for(size_t i = 0; i < npolicies; ++i) {
+		bool selected = argc == 2;
+		for(int a = 2; a < argc; ++a)
+			selected = selected || strcmp(argv[a], policies[i].name) == 0;
+		if(!selected)
+			continue;
+		in_child(policies[i].throughput, policies[i].name, t);
+		in_child(policies[i].latency, policies[i].name, t);
+	}
+	return 0;
+}
@@ -0,0 +1,101 @@
+// 生成常见容器用法的分配轨迹, 供alloc_replay重放.
+// 轨迹是在记录模式下实际运行CCSTL的容器得到的, 大小和顺序与真实代码一致
+//   g++ -O2 -std=c++11 -DCCSTL_ALLOC_TRACE -I.. alloc_trace_gen.cpp ../Alloc.cpp ../AllocTrace.cpp ../Simd.cpp -o alloc_trace_gen
+//   ./alloc_trace_gen [vector|list|deque|all] [输出文件前缀] [规模]
+// 输出 前缀.vector.trace 等文件
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "bench.h"
+#include "../AllocTrace.h"
+#include "../List.h"
+#include "../deque.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+static unsigned long long rng = 88172645463325252ull;
+static size_t next_rand() {
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return size_t(rng);
+}
+
+// 许多vector各自增长到随机的长度, 不时整个丢弃重建: 按两倍扩容的分配/释放序列
+static void vector_growth(size_t scale) {
+	const size_t slots = 256;
+	vector<long>* vs = new vector<long>[slots];
+	for(size_t i = 0; i < scale * 4; ++i) {
+		size_t k = next_rand() % slots;
+		if(next_rand() % 64 == 0)
+			vector<long>().swap(vs[k]);
+		size_t grow = 1 + next_rand() % 8;
+		for(size_t j = 0; j < grow; ++j)
+			vs[k].push_back(long(i));
+	}
+	delete[] vs;
+}
+
+// 链表在随机位置插入和删除, 节点数在scale附近波动: 大量同样大小的小块
+static void list_churn(size_t scale) {
+	const size_t lists = 16;
+	list<long> ls[lists];
+	size_t live = 0;
+	for(size_t i = 0; i < scale * 8; ++i) {
+		list<long>& l = ls[next_rand() % lists];
+		bool grow = live < scale / 2 || (live < scale * 2 && next_rand() % 2 == 0);
+		if(grow || l.empty()) {
+			if(next_rand() % 2)
+				l.push_back(long(i));
+			else
+				l.push_front(long(i));
+			++live;
+		} else {
+			if(next_rand() % 2)
+				l.pop_back();
+			else
+				l.pop_front();
+			--live;
+		}
+	}
+}
+
+// 队列的长度在0和scale之间来回变化: 整块缓冲区先进先出, map偶尔重新配置
+static void deque_fifo(size_t scale) {
+	deque<long> q;
+	for(int round = 0; round < 8; ++round) {
+		size_t target = scale / 2 + next_rand() % (scale / 2 + 1);
+		while(q.size() < target)
+			q.push_back(long(q.size()));
+		size_t keep = next_rand() % (scale / 8 + 1);
+		while(q.size() > keep)
+			q.pop_front();
+	}
+}
+
+static void generate(const std::string& prefix, const char* name, void (*f)(size_t), size_t scale) {
+	std::string path = prefix + "." + name + ".trace";
+	if(!alloc_trace::start(path.c_str())) {
+		fprintf(stderr, "cannot write %s\n", path.c_str());
+		exit(1);
+	}
+	double start = bench::now_sec();
+	f(scale);
+	alloc_trace::stop();
+	printf("%-8s %s (%.2f s)\n", name, path.c_str(), bench::now_sec() - start);
+}
+
+int main(int argc, char** argv) {
+	const char* which = argc > 1 ? argv[1] : "all";
+	std::string prefix = argc > 2 ? argv[2] : "/tmp/alloc";
+	size_t scale = argc > 3 ? strtoull(argv[3], 0, 10) : 200000;
+	bool all = strcmp(which, "all") == 0;
+	if(all || strcmp(which, "vector") == 0)
+		generate(prefix, "vector", vector_growth, scale);
+	if(all || strcmp(which, "list") == 0)
+		generate(prefix, "list", list_churn, scale);
+	if(all || strcmp(which, "deque") == 0)
+		generate(prefix, "deque", deque_fifo, scale);
+	return 0;
+}
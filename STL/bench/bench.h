@@ -0,0 +1,36 @@
+#ifndef BENCH_H
+#define BENCH_H
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+// 基准测试共用的小工具, 每个xxx_bench.cpp都是独立的可执行文件:
+//   g++ -O2 -std=c++11 -I.. xxx_bench.cpp ../Alloc.cpp ../Simd.cpp -o xxx_bench
+namespace bench {
+	inline double now_sec() {
+		return std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// 阻止编译器把结果当作死代码消除
+	template <class T>
+	inline void keep(const T& x) {
+		asm volatile("" : : "r,m"(x) : "memory");
+	}
+
+	// 至少运行min_sec秒, 返回每次调用的平均耗时(秒)
+	template <class F>
+	double measure(F f, double min_sec = 0.2) {
+		f();
+		size_t iters = 0;
+		double start = now_sec();
+		double elapsed = 0;
+		do {
+			f();
+			++iters;
+			elapsed = now_sec() - start;
+		} while(elapsed < min_sec);
+		return elapsed / iters;
+	}
+}
+#endif
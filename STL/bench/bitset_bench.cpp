@@ -0,0 +1,146 @@
+// dynamic_bitset与std::vector<bool>对比: 整段位运算、计数、遍历所有为1的位、逐位追加和resize
+//   g++ -O2 -std=c++11 -I.. bitset_bench.cpp ../Alloc.cpp ../Simd.cpp -o bitset_bench
+//   ./bitset_bench [位数] [密度]
+// 位运算和计数分别在scalar/SSE2/AVX2三个等级下测量, std::vector<bool>没有整段的位运算, 用逐位的写法.
+// 密度是随机位图中1的比例, 影响遍历的耗时
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "bench.h"
+#include "../dynamic_bitset.h"
+
+using namespace CCSTL;
+
+typedef dynamic_bitset<> bitset;
+
+static size_t nbits = 1 << 24;
+static double density = 0.01;
+
+static unsigned long long rng = 88172645463325252ull;
+static uint64_t next_rand() {
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return rng;
+}
+
+static void report(const char* op, const char* impl, double sec) {
+	printf("%-12s %-18s %9.3f ms  %7.2f Gbit/s\n", op, impl, sec * 1e3, nbits / sec / 1e9);
+}
+
+static void bench_bitset_ops(const bitset& a, const bitset& b) {
+	static const char* levels[] = {"bitset scalar", "bitset sse2", "bitset avx2"};
+	for(int level = simd::CPU_SCALAR; level <= simd::detect_cpu(); ++level) {
+		simd::set_cpu_level(simd::cpu_level(level));
+		bitset r(a);
+		report("and", levels[level], bench::measure([&] { r &= b; bench::keep(r.data()[0]); }));
+		report("or", levels[level], bench::measure([&] { r |= b; bench::keep(r.data()[0]); }));
+		report("xor", levels[level], bench::measure([&] { r ^= b; bench::keep(r.data()[0]); }));
+		report("andnot", levels[level], bench::measure([&] { r -= b; bench::keep(r.data()[0]); }));
+		report("count", levels[level], bench::measure([&] { bench::keep(a.count()); }));
+	}
+	simd::set_cpu_level(simd::detect_cpu());
+}
+
+static void bench_vector_bool_ops(const std::vector<bool>& a, const std::vector<bool>& b) {
+	std::vector<bool> r(a);
+	report("and", "std::vector<bool>", bench::measure([&] {
+		std::vector<bool>::const_iterator j = b.begin();
+		for(std::vector<bool>::iterator i = r.begin(); i != r.end(); ++i, ++j)
+			*i = *i && *j;
+		bench::keep(r.front());
+	}));
+	report("or", "std::vector<bool>", bench::measure([&] {
+		std::vector<bool>::const_iterator j = b.begin();
+		for(std::vector<bool>::iterator i = r.begin(); i != r.end(); ++i, ++j)
+			*i = *i || *j;
+		bench::keep(r.front());
+	}));
+	report("xor", "std::vector<bool>", bench::measure([&] {
+		std::vector<bool>::const_iterator j = b.begin();
+		for(std::vector<bool>::iterator i = r.begin(); i != r.end(); ++i, ++j)
+			*i = *i != *j;
+		bench::keep(r.front());
+	}));
+	report("andnot", "std::vector<bool>", bench::measure([&] {
+		std::vector<bool>::const_iterator j = b.begin();
+		for(std::vector<bool>::iterator i = r.begin(); i != r.end(); ++i, ++j)
+			*i = *i && !*j;
+		bench::keep(r.front());
+	}));
+	report("count", "std::vector<bool>", bench::measure([&] {
+		bench::keep(std::count(a.begin(), a.end(), true));
+	}));
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		nbits = strtoull(argv[1], 0, 10);
+	if(argc > 2)
+		density = atof(argv[2]);
+	printf("%zu bits, density %g, cpu level %d\n", nbits, density, int(simd::detect_cpu()));
+
+	// 两个随机位图, 一个按给定密度, 一个各半
+	const uint64_t threshold = uint64_t(density * 18446744073709551615.0);
+	bitset a(nbits), b(nbits);
+	std::vector<bool> va(nbits), vb(nbits);
+	for(size_t i = 0; i < nbits; ++i) {
+		bool x = next_rand() < threshold;
+		bool y = next_rand() & 1;
+		a[i] = x;
+		va[i] = x;
+		b[i] = y;
+		vb[i] = y;
+	}
+
+	bench_bitset_ops(a, b);
+	bench_vector_bool_ops(va, vb);
+
+	// 遍历所有为1的位
+	report("scan", "bitset find_next", bench::measure([&] {
+		size_t sum = 0;
+		for(size_t i = a.find_first(); i != bitset::npos; i = a.find_next(i))
+			sum += i;
+		bench::keep(sum);
+	}));
+	report("scan", "bitset each_set", bench::measure([&] {
+		size_t sum = 0;
+		a.for_each_set([&](size_t i) { sum += i; });
+		bench::keep(sum);
+	}));
+	report("scan", "std::vector<bool>", bench::measure([&] {
+		size_t sum = 0;
+		for(size_t i = 0; i < nbits; ++i) {
+			if(va[i])
+				sum += i;
+		}
+		bench::keep(sum);
+	}));
+
+	// 逐位追加与整段resize
+	report("push_back", "bitset", bench::measure([&] {
+		bitset r;
+		for(size_t i = 0; i < nbits; ++i)
+			r.push_back(i & 1);
+		bench::keep(r.data()[0]);
+	}));
+	report("push_back", "std::vector<bool>", bench::measure([&] {
+		std::vector<bool> r;
+		for(size_t i = 0; i < nbits; ++i)
+			r.push_back(i & 1);
+		bench::keep(r.front());
+	}));
+	report("resize", "bitset", bench::measure([&] {
+		bitset r;
+		r.resize(nbits / 2, true);
+		r.resize(nbits, false);
+		bench::keep(r.data()[0]);
+	}));
+	report("resize", "std::vector<bool>", bench::measure([&] {
+		std::vector<bool> r;
+		r.resize(nbits / 2, true);
+		r.resize(nbits, false);
+		bench::keep(r.front());
+	}));
+	return 0;
+}
@@ -0,0 +1,67 @@
+// 多线程追加: concurrent_vector 与 加互斥锁的vector 对比
+//   g++ -O2 -std=c++11 -I.. concurrent_vector_bench.cpp ../Alloc.cpp ../Simd.cpp -pthread -o concurrent_vector_bench
+//   ./concurrent_vector_bench [每个线程追加的元素个数] [最大线程数]
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "../vector.h"
+#include "../concurrent_vector.h"
+
+using namespace CCSTL;
+
+template <class F>
+static double run_threads(size_t threads, F f) {
+	std::vector<std::thread> pool;
+	double start = bench::now_sec();
+	for(size_t t = 0; t < threads; ++t)
+		pool.push_back(std::thread(f, t));
+	for(size_t t = 0; t < threads; ++t)
+		pool[t].join();
+	return bench::now_sec() - start;
+}
+
+int main(int argc, char** argv) {
+	size_t per_thread = argc > 1 ? strtoull(argv[1], 0, 10) : 2000000;
+	size_t max_threads = argc > 2 ? strtoull(argv[2], 0, 10) : std::thread::hardware_concurrency();
+	if(max_threads == 0)
+		max_threads = 1;
+
+	for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+		double total = double(per_thread * threads);
+
+		{
+			vector<long> v;
+			std::mutex m;
+			double sec = run_threads(threads, [&](size_t t) {
+				for(size_t i = 0; i < per_thread; ++i) {
+					std::lock_guard<std::mutex> lock(m);
+					v.push_back(long(t * per_thread + i));
+				}
+			});
+			printf("mutex + vector          %3zu threads %8.2f Mops/s\n", threads, total / sec / 1e6);
+		}
+		{
+			concurrent_vector<long> v;
+			double sec = run_threads(threads, [&](size_t t) {
+				for(size_t i = 0; i < per_thread; ++i)
+					v.push_back(long(t * per_thread + i));
+			});
+			printf("concurrent_vector       %3zu threads %8.2f Mops/s\n", threads, total / sec / 1e6);
+		}
+		{
+			// 每次占64个位置, 摊薄fetch_add的竞争
+			concurrent_vector<long> v;
+			double sec = run_threads(threads, [&](size_t t) {
+				for(size_t i = 0; i < per_thread; i += 64) {
+					size_t first = v.grow_by(64);
+					for(size_t k = 0; k < 64; ++k)
+						v[first + k] = long(t * per_thread + i + k);
+				}
+			});
+			printf("concurrent_vector grow  %3zu threads %8.2f Mops/s\n", threads, total / sec / 1e6);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,469 @@
+// vector / list / deque 与libstdc++对应容器的对比, 输出CSV, 可比较两次运行的结果找出性能回退
+//   g++ -O2 -std=c++11 -I.. container_bench.cpp ../Alloc.cpp ../Simd.cpp -o container_bench
+//   ./container_bench [--sizes 1000,100000] [--types int,pod64,string]
+//                     [--containers vector,list,deque] [--min-time 0.05] [--out result.csv]
+//   ./container_bench --compare old.csv new.csv [--threshold 10] [--noise 0.05]
+// CSV的列: container,impl,element,size,op,ns_per_element
+// 比较模式下, 新结果比旧结果慢threshold%以上的行标记为REGRESSION, 此时返回1.
+// 相差不到noise纳秒的不算变化: move等O(1)的操作平摊到每个元素只有零点几纳秒, 百分比没有意义.
+// 两次运行应在同一台机器上; 机器有噪声时加大--min-time
+//
+// 每个操作重复多次, 取中位数; 准备数据的时间不计入.
+// CCSTL容器没有的操作(deque的中间插入删除, list的移动构造)只测std的版本
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench.h"
+#include "../List.h"
+#include "../deque.h"
+#include "../vector.h"
+
+// ---------------------------------------------------------------
+// 元素类型
+// ---------------------------------------------------------------
+struct pod64 {
+	long v[8];
+};
+
+template <class T> struct element;
+
+template <> struct element<int> {
+	static const char* name() { return "int"; }
+	static int make(size_t i) { return int(i); }
+	static long value(const int& x) { return x; }
+};
+
+template <> struct element<pod64> {
+	static const char* name() { return "pod64"; }
+	static pod64 make(size_t i) {
+		pod64 p;
+		for(int k = 0; k < 8; ++k)
+			p.v[k] = long(i) + k;
+		return p;
+	}
+	static long value(const pod64& x) { return x.v[0]; }
+};
+
+// 超过libstdc++的SSO长度, 每个元素都有一次堆分配
+template <> struct element<std::string> {
+	static const char* name() { return "string"; }
+	static std::string make(size_t i) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "element-%012zu", i);
+		return buf;
+	}
+	static long value(const std::string& x) { return long(x.size()) + x[x.size() - 1]; }
+};
+
+// ---------------------------------------------------------------
+// 容器能做的操作
+// ---------------------------------------------------------------
+// random_access: 中间位置用begin() + k定位; 否则从头走到中间
+template <class C> struct caps {
+	static const bool push_front = true;
+	static const bool middle = true;
+	static const bool random_access = false;
+	static const bool move = true;
+};
+
+template <class T> struct caps<std::vector<T>> {
+	static const bool push_front = false;
+	static const bool middle = true;
+	static const bool random_access = true;
+	static const bool move = true;
+};
+
+template <class T> struct caps<std::deque<T>> {
+	static const bool push_front = true;
+	static const bool middle = true;
+	static const bool random_access = true;
+	static const bool move = true;
+};
+
+template <class T> struct caps<CCSTL::vector<T>> {
+	static const bool push_front = false;
+	static const bool middle = true;
+	static const bool random_access = true;
+	static const bool move = true;
+};
+
+template <class T> struct caps<CCSTL::list<T>> {
+	static const bool push_front = true;
+	static const bool middle = true;
+	static const bool random_access = false;
+	static const bool move = false;
+};
+
+template <class T> struct caps<CCSTL::deque<T>> {
+	static const bool push_front = true;
+	static const bool middle = false;
+	static const bool random_access = true;
+	static const bool move = true;
+};
+
+template <bool B> struct bool_tag {};
+
+template <class C>
+typename C::iterator middle_of(C& c, size_t size, bool_tag<true>) {
+	return c.begin() + (size / 2);
+}
+
+template <class C>
+typename C::iterator middle_of(C& c, size_t size, bool_tag<false>) {
+	typename C::iterator it = c.begin();
+	for(size_t i = 0; i < size / 2; ++i)
+		++it;
+	return it;
+}
+
+template <class C>
+typename C::iterator middle_of(C& c, size_t size) {
+	return middle_of(c, size, bool_tag<caps<C>::random_access>());
+}
+
+// 在中间连续插入: 顺序容器插入后迭代器失效, 每次重新定位; list保持同一个位置
+template <class C, class T>
+void insert_middle(C& c, size_t size, size_t count, const T& x, bool_tag<true>) {
+	for(size_t i = 0; i < count; ++i)
+		c.insert(c.begin() + ((size + i) / 2), x);
+}
+
+template <class C, class T>
+void insert_middle(C& c, size_t size, size_t count, const T& x, bool_tag<false>) {
+	typename C::iterator it = middle_of(c, size);
+	for(size_t i = 0; i < count; ++i)
+		it = c.insert(it, x);
+}
+
+template <class C>
+void erase_middle(C& c, size_t size, size_t count, bool_tag<true>) {
+	for(size_t i = 0; i < count; ++i)
+		c.erase(c.begin() + ((size - i) / 2));
+}
+
+template <class C>
+void erase_middle(C& c, size_t size, size_t count, bool_tag<false>) {
+	typename C::iterator it = middle_of(c, size);
+	for(size_t i = 0; i < count; ++i)
+		it = c.erase(it);
+}
+
+// ---------------------------------------------------------------
+// 计时
+// ---------------------------------------------------------------
+struct row {
+	std::string container, impl, element, op;
+	size_t size;
+	double ns_per_element;
+};
+
+static std::vector<row> rows;
+static double min_time = 0.05;
+
+// f()返回被计时部分的秒数. 至少重复3次并累计min_time秒, 取中位数
+template <class F>
+double median_time(F f) {
+	std::vector<double> t;
+	double total = 0;
+	while(t.size() < 3 || (total < min_time && t.size() < 1000)) {
+		double s = f();
+		t.push_back(s);
+		total += s;
+	}
+	std::sort(t.begin(), t.end());
+	return t[t.size() / 2];
+}
+
+static void report(const char* container, const char* impl, const char* elem,
+                   size_t size, const char* op, double sec, size_t per) {
+	row r;
+	r.container = container;
+	r.impl = impl;
+	r.element = elem;
+	r.size = size;
+	r.op = op;
+	r.ns_per_element = sec * 1e9 / double(per ? per : 1);
+	rows.push_back(r);
+	fprintf(stderr, "%-7s %-6s %-7s %8zu %-14s %10.2f ns\n", container, impl, elem, size, op, r.ns_per_element);
+}
+
+// CCSTL容器缺少的操作用bool_tag<false>的空版本跳过, 不实例化不存在的成员
+template <class C, class T>
+void run_push_front(const char*, const char*, size_t, bool_tag<false>) {}
+
+template <class C, class T>
+void run_push_front(const char* container, const char* impl, size_t n, bool_tag<true>) {
+	const T x = element<T>::make(7);
+	report(container, impl, element<T>::name(), n, "push_front", median_time([&] {
+		C* c = new C;
+		double s = bench::now_sec();
+		for(size_t i = 0; i < n; ++i)
+			c->push_front(x);
+		double sec = bench::now_sec() - s;
+		delete c;
+		return sec;
+	}), n);
+}
+
+template <class C, class T>
+void run_middle(const char*, const char*, size_t, bool_tag<false>) {}
+
+// 在中间位置连续插入/删除middle_ops个元素, 按每次操作计时.
+// 链表从中间向后删除, 最多删到尾部, 所以不超过n / 2次
+template <class C, class T>
+void run_middle(const char* container, const char* impl, size_t n, bool_tag<true>) {
+	const T x = element<T>::make(7);
+	const size_t middle_ops = std::min<size_t>(n / 2, 1000);
+	report(container, impl, element<T>::name(), n, "insert_middle", median_time([&] {
+		C c(n, x);
+		double s = bench::now_sec();
+		insert_middle(c, n, middle_ops, x, bool_tag<caps<C>::random_access>());
+		return bench::now_sec() - s;
+	}), middle_ops);
+
+	report(container, impl, element<T>::name(), n, "erase_middle", median_time([&] {
+		C c(n, x);
+		double s = bench::now_sec();
+		erase_middle(c, n, middle_ops, bool_tag<caps<C>::random_access>());
+		return bench::now_sec() - s;
+	}), middle_ops);
+}
+
+template <class C>
+void run_move(const char*, const char*, const char*, const C&, bool_tag<false>) {}
+
+template <class C>
+void run_move(const char* container, const char* impl, const char* en, const C& c, bool_tag<true>) {
+	size_t n = c.size();
+	report(container, impl, en, n, "move", median_time([&] {
+		C* src = new C(c);
+		double s = bench::now_sec();
+		C* d = new C(std::move(*src));
+		double sec = bench::now_sec() - s;
+		delete d;
+		delete src;
+		return sec;
+	}), n);
+}
+
+template <class C, class T>
+void run(const char* container, const char* impl, size_t n) {
+	typedef element<T> E;
+	const char* en = E::name();
+	const T x = E::make(7);
+
+	report(container, impl, en, n, "construct_fill", median_time([&] {
+		double s = bench::now_sec();
+		C* c = new C(n, x);
+		double sec = bench::now_sec() - s;
+		delete c;
+		return sec;
+	}), n);
+
+	report(container, impl, en, n, "push_back", median_time([&] {
+		C* c = new C;
+		double s = bench::now_sec();
+		for(size_t i = 0; i < n; ++i)
+			c->push_back(x);
+		double sec = bench::now_sec() - s;
+		delete c;
+		return sec;
+	}), n);
+
+	run_push_front<C, T>(container, impl, n, bool_tag<caps<C>::push_front>());
+	run_middle<C, T>(container, impl, n, bool_tag<caps<C>::middle>());
+
+	{
+		C c;
+		for(size_t i = 0; i < n; ++i)
+			c.push_back(E::make(i));
+
+		report(container, impl, en, n, "iterate", median_time([&] {
+			double s = bench::now_sec();
+			long sum = 0;
+			for(typename C::iterator it = c.begin(); it != c.end(); ++it)
+				sum += E::value(*it);
+			bench::keep(sum);
+			return bench::now_sec() - s;
+		}), n);
+
+		report(container, impl, en, n, "copy", median_time([&] {
+			double s = bench::now_sec();
+			C* d = new C(c);
+			double sec = bench::now_sec() - s;
+			delete d;
+			return sec;
+		}), n);
+
+		run_move<C>(container, impl, en, c, bool_tag<caps<C>::move>());
+	}
+
+	report(container, impl, en, n, "destroy", median_time([&] {
+		C* c = new C;
+		for(size_t i = 0; i < n; ++i)
+			c->push_back(E::make(i));
+		double s = bench::now_sec();
+		delete c;
+		return bench::now_sec() - s;
+	}), n);
+}
+
+template <class T>
+void run_element(const std::vector<std::string>& containers, size_t n) {
+	for(size_t i = 0; i < containers.size(); ++i) {
+		const std::string& c = containers[i];
+		if(c == "vector") {
+			run<CCSTL::vector<T>, T>("vector", "ccstl", n);
+			run<std::vector<T>, T>("vector", "std", n);
+		} else if(c == "list") {
+			run<CCSTL::list<T>, T>("list", "ccstl", n);
+			run<std::list<T>, T>("list", "std", n);
+		} else if(c == "deque") {
+			run<CCSTL::deque<T>, T>("deque", "ccstl", n);
+			run<std::deque<T>, T>("deque", "std", n);
+		}
+	}
+}
+
+// ---------------------------------------------------------------
+// CSV和比较
+// ---------------------------------------------------------------
+static std::vector<std::string> split(const std::string& s, char sep) {
+	std::vector<std::string> out;
+	size_t begin = 0;
+	for(;;) {
+		size_t end = s.find(sep, begin);
+		out.push_back(s.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+		if(end == std::string::npos)
+			return out;
+		begin = end + 1;
+	}
+}
+
+static void write_csv(FILE* f) {
+	fprintf(f, "container,impl,element,size,op,ns_per_element\n");
+	for(size_t i = 0; i < rows.size(); ++i) {
+		const row& r = rows[i];
+		fprintf(f, "%s,%s,%s,%zu,%s,%.3f\n", r.container.c_str(), r.impl.c_str(),
+		        r.element.c_str(), r.size, r.op.c_str(), r.ns_per_element);
+	}
+}
+
+// 键为前5列, 值为ns_per_element
+static bool read_csv(const char* path, std::map<std::string, double>& out) {
+	FILE* f = fopen(path, "r");
+	if(!f)
+		return false;
+	char line[512];
+	bool header = true;
+	while(fgets(line, sizeof(line), f)) {
+		std::string s(line);
+		while(!s.empty() && (s[s.size() - 1] == '\n' || s[s.size() - 1] == '\r'))
+			s.erase(s.size() - 1);
+		if(header || s.empty()) {
+			header = false;
+			continue;
+		}
+		size_t comma = s.rfind(',');
+		if(comma == std::string::npos)
+			continue;
+		out[s.substr(0, comma)] = atof(s.c_str() + comma + 1);
+	}
+	fclose(f);
+	return true;
+}
+
+static int compare(const char* old_path, const char* new_path, double threshold, double noise) {
+	std::map<std::string, double> before, after;
+	if(!read_csv(old_path, before) || !read_csv(new_path, after)) {
+		fprintf(stderr, "cannot read %s or %s\n", old_path, new_path);
+		return 2;
+	}
+	int regressions = 0;
+	printf("container,impl,element,size,op,old_ns,new_ns,change_percent,status\n");
+	for(std::map<std::string, double>::const_iterator it = after.begin(); it != after.end(); ++it) {
+		std::map<std::string, double>::const_iterator old = before.find(it->first);
+		if(old == before.end() || old->second <= 0)
+			continue;
+		double change = (it->second / old->second - 1.0) * 100.0;
+		bool significant = std::fabs(it->second - old->second) >= noise;
+		const char* status = "ok";
+		if(significant && change > threshold) {
+			status = "REGRESSION";
+			++regressions;
+		} else if(significant && change < -threshold) {
+			status = "improved";
+		}
+		printf("%s,%.3f,%.3f,%+.1f,%s\n", it->first.c_str(), old->second, it->second, change, status);
+	}
+	fprintf(stderr, "%d regression(s) above %.1f%%\n", regressions, threshold);
+	return regressions ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::string> sizes = split("1000,100000", ',');
+	std::vector<std::string> types = split("int,pod64,string", ',');
+	std::vector<std::string> containers = split("vector,list,deque", ',');
+	const char* out = 0;
+	double threshold = 10;
+	double noise = 0.05;
+
+	for(int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		bool has_value = i + 1 < argc;
+		if(a == "--compare" && i + 2 < argc) {
+			for(int j = i + 3; j + 1 < argc; ++j) {
+				if(strcmp(argv[j], "--threshold") == 0)
+					threshold = atof(argv[j + 1]);
+				else if(strcmp(argv[j], "--noise") == 0)
+					noise = atof(argv[j + 1]);
+			}
+			return compare(argv[i + 1], argv[i + 2], threshold, noise);
+		} else if(a == "--sizes" && has_value) {
+			sizes = split(argv[++i], ',');
+		} else if(a == "--types" && has_value) {
+			types = split(argv[++i], ',');
+		} else if(a == "--containers" && has_value) {
+			containers = split(argv[++i], ',');
+		} else if(a == "--min-time" && has_value) {
+			min_time = atof(argv[++i]);
+		} else if(a == "--out" && has_value) {
+			out = argv[++i];
+		} else {
+			fprintf(stderr, "unknown argument %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	for(size_t s = 0; s < sizes.size(); ++s) {
+		size_t n = strtoull(sizes[s].c_str(), 0, 10);
+		for(size_t t = 0; t < types.size(); ++t) {
+			if(types[t] == "int")
+				run_element<int>(containers, n);
+			else if(types[t] == "pod64")
+				run_element<pod64>(containers, n);
+			else if(types[t] == "string")
+				run_element<std::string>(containers, n);
+		}
+	}
+
+	if(out) {
+		FILE* f = fopen(out, "w");
+		if(!f) {
+			fprintf(stderr, "cannot write %s\n", out);
+			return 2;
+		}
+		write_csv(f);
+		fclose(f);
+	} else {
+		write_csv(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,52 @@
+// priority_queue的push/pop吞吐量: 叉数2/4/8 与 std::priority_queue 对比
+//   g++ -O2 -std=c++11 -I.. heap_bench.cpp ../Alloc.cpp ../Simd.cpp -o heap_bench
+#include <cstdint>
+#include <cstdlib>
+#include <queue>
+#include <vector>
+#include "bench.h"
+#include "../queue.h"
+
+static std::vector<uint64_t> keys;
+
+// 先push n个随机键, 再交替pop/push n次(调度器的稳定状态), 最后全部pop
+template <class Queue>
+static void run(const char* name, size_t n) {
+	double sec = bench::measure([&] {
+		Queue q;
+		for(size_t i = 0; i < n; ++i)
+			q.push(keys[i]);
+		uint64_t sum = 0;
+		for(size_t i = 0; i < n; ++i) {
+			sum += q.top();
+			q.pop();
+			q.push(keys[n + i]);
+		}
+		while(!q.empty()) {
+			sum += q.top();
+			q.pop();
+		}
+		bench::keep(sum);
+	});
+	printf("%-24s n=%-9zu %8.2f Mops/s\n", name, n, 4.0 * n / sec / 1e6);
+}
+
+template <size_t D>
+struct ccstl_queue: public CCSTL::priority_queue<uint64_t, CCSTL::vector<uint64_t>,
+                                                 std::less<uint64_t>, D> {};
+
+int main() {
+	size_t sizes[] = { 1000, 100000, 4000000 };
+	keys.resize(2 * sizes[2]);
+	for(size_t i = 0; i < keys.size(); ++i)
+		keys[i] = (uint64_t(rand()) << 32) | uint64_t(rand());
+
+	for(size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+		size_t n = sizes[k];
+		run<std::priority_queue<uint64_t> >("std::priority_queue", n);
+		run<ccstl_queue<2> >("CCSTL arity 2", n);
+		run<ccstl_queue<4> >("CCSTL arity 4", n);
+		run<ccstl_queue<8> >("CCSTL arity 8", n);
+	}
+	return 0;
+}
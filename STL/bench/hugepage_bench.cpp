@@ -0,0 +1,187 @@
+// 内存池的chunk来自malloc 与 来自huge_page_arena(透明大页) 的对比,
+// 用perf计数器统计随机访问链表和散列表时的dTLB缺失
+//   g++ -O2 -std=c++11 -I.. hugepage_bench.cpp ../Alloc.cpp ../Simd.cpp ../MmapAlloc.cpp -o hugepage_bench
+//   ./hugepage_bench [malloc|hugepage] [节点个数]
+// 不指定模式时两种各在一个子进程中跑一遍. 计数器需要perf_event_paranoid <= 2
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../Alloc.h"
+#include "../List.h"
+#include "../MmapAlloc.h"
+
+using namespace CCSTL;
+
+// 让std::unordered_map的节点也从alloc的内存池中分配
+template <class T>
+struct pool_allocator {
+	typedef T value_type;
+	pool_allocator() {}
+	template <class U> pool_allocator(const pool_allocator<U>&) {}
+	T* allocate(size_t n) { return static_cast<T*>(alloc::allocate(n * sizeof(T))); }
+	void deallocate(T* p, size_t n) { alloc::deallocate(p, n * sizeof(T)); }
+	template <class U> bool operator==(const pool_allocator<U>&) const { return true; }
+	template <class U> bool operator!=(const pool_allocator<U>&) const { return false; }
+};
+
+// 只统计用户态的dTLB读缺失
+class dtlb_counter {
+public:
+	dtlb_counter() {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB |
+		              (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+	~dtlb_counter() { if(fd >= 0) close(fd); }
+
+	bool ok() const { return fd >= 0; }
+	void start() {
+		if(fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+	long long stop() {
+		long long n = -1;
+		if(fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			if(read(fd, &n, sizeof(n)) != sizeof(n))
+				n = -1;
+		}
+		return n;
+	}
+
+private:
+	int fd;
+};
+
+static unsigned long long rng = 88172645463325252ull;
+static size_t next_rand() {
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return size_t(rng);
+}
+
+// 进程中透明大页占用的字节数
+static long anon_huge_kb() {
+	FILE* f = fopen("/proc/self/smaps_rollup", "r");
+	if(!f)
+		return -1;
+	char line[256];
+	long kb = -1;
+	while(fgets(line, sizeof(line), f)) {
+		if(strncmp(line, "AnonHugePages:", 14) == 0)
+			kb = strtol(line + 14, 0, 10);
+	}
+	fclose(f);
+	return kb;
+}
+
+static void report(const char* mode, const char* name, double sec, size_t ops, long long misses) {
+	if(misses >= 0)
+		printf("%-9s %-22s %8.2f ns/op  %10.4f dTLB misses/op\n",
+		       mode, name, sec / ops * 1e9, double(misses) / ops);
+	else
+		printf("%-9s %-22s %8.2f ns/op  dTLB misses n/a\n", mode, name, sec / ops * 1e9);
+}
+
+static void run(const char* mode, size_t n) {
+	if(strcmp(mode, "hugepage") == 0) {
+		if(!huge_page_arena::available())
+			printf("transparent huge pages are disabled, huge_page_arena falls back to malloc\n");
+		alloc::set_chunk_provider(huge_page_arena::allocate);
+	}
+	dtlb_counter counter;
+	if(!counter.ok())
+		printf("perf_event_open failed: %s\n", strerror(errno));
+
+	// 链表: 每个新节点插在随机的已有节点前, 遍历顺序与地址顺序无关
+	{
+		list<long> l;
+		std::vector<list<long>::iterator> its;
+		its.reserve(n);
+		its.push_back(l.insert(l.end(), 0));
+		for(size_t i = 1; i < n; ++i)
+			its.push_back(l.insert(its[next_rand() % its.size()], long(i)));
+		std::vector<list<long>::iterator>().swap(its);
+
+		const int rounds = 4;
+		long sum = 0;
+		counter.start();
+		double start = bench::now_sec();
+		for(int r = 0; r < rounds; ++r) {
+			for(list<long>::iterator it = l.begin(); it != l.end(); ++it)
+				sum += *it;
+		}
+		double sec = bench::now_sec() - start;
+		long long misses = counter.stop();
+		bench::keep(sum);
+		report(mode, "list traversal", sec, n * rounds, misses);
+	}
+
+	// 散列表: 随机查找
+	{
+		typedef std::unordered_map<long, long, std::hash<long>, std::equal_to<long>,
+		                           pool_allocator<std::pair<const long, long>>> map_type;
+		map_type m;
+		m.reserve(n);
+		for(size_t i = 0; i < n; ++i)
+			m[long(next_rand() % (n * 4))] = long(i);
+
+		size_t lookups = n * 4;
+		long sum = 0;
+		counter.start();
+		double start = bench::now_sec();
+		for(size_t i = 0; i < lookups; ++i) {
+			map_type::const_iterator it = m.find(long(next_rand() % (n * 4)));
+			if(it != m.end())
+				sum += it->second;
+		}
+		double sec = bench::now_sec() - start;
+		long long misses = counter.stop();
+		bench::keep(sum);
+		report(mode, "unordered_map find", sec, lookups, misses);
+	}
+	printf("%-9s AnonHugePages %ld kB, arena reserved %zu kB\n",
+	       mode, anon_huge_kb(), huge_page_arena::reserved() >> 10);
+}
+
+int main(int argc, char** argv) {
+	size_t n = argc > 2 ? strtoull(argv[2], 0, 10) : 2000000;
+	if(argc > 1) {
+		run(argv[1], n);
+		return 0;
+	}
+	// 内存池一旦开始分配就不能再换provider, 所以每种模式用一个新进程
+	const char* modes[] = {"malloc", "hugepage"};
+	for(int i = 0; i < 2; ++i) {
+		fflush(stdout);
+		pid_t pid = fork();
+		if(pid == 0) {
+			run(modes[i], n);
+			fflush(stdout);
+			_exit(0);
+		}
+		waitpid(pid, 0, 0);
+	}
+	return 0;
+}
@@ -0,0 +1,129 @@
+// 容器计数策略的开销: 默认的null_instrument与counted_instrument对比, std的容器作参照
+//   g++ -O2 -std=c++11 -I.. instrument_bench.cpp ../Alloc.cpp ../Instrument.cpp ../Simd.cpp -o instrument_bench
+//   ./instrument_bench [元素个数]
+//
+// null_instrument的钩子都是空的内联函数, 容器的大小不变(下面的static_assert),
+// 生成的代码也与没有这个模板参数时逐条指令相同, 所以null一列就是原来的容器.
+// 每个场景null/counted轮流跑几轮, 取各自最快的一次, 减少噪声的影响
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <vector>
+#include "bench.h"
+#include "../Instrument.h"
+#include "../List.h"
+#include "../deque.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+CCSTL_INSTRUMENT_TAG(bench_vector);
+CCSTL_INSTRUMENT_TAG(bench_list);
+CCSTL_INSTRUMENT_TAG(bench_deque);
+
+typedef vector<long> plain_vector;
+typedef vector<long, allocator<long>, counted_instrument<bench_vector>> counted_vector;
+typedef list<long> plain_list;
+typedef list<long, allocator<long>, counted_instrument<bench_list>> counted_list;
+typedef deque<long> plain_deque;
+typedef deque<long, allocator<long>, 0, counted_instrument<bench_deque>> counted_deque;
+
+static_assert(sizeof(plain_vector) == sizeof(counted_vector), "instrument must not add state to vector");
+// list不保存长度, counted的版本为了记录最大长度多一个计数, null的版本仍然只有一个指针
+static_assert(sizeof(plain_list) == sizeof(void*), "null_instrument must not add state to list");
+static_assert(sizeof(plain_deque) == sizeof(counted_deque), "instrument must not add state to deque");
+
+static size_t n = 1000000;
+
+template <class V>
+static void vector_push_back() {
+	V v;
+	for(size_t i = 0; i < n; ++i)
+		v.push_back(long(i));
+	bench::keep(v.back());
+}
+
+// 插入删除都在前部, 每次要挪动后面的全部元素
+template <class V>
+static void vector_insert_erase() {
+	V v;
+	for(size_t i = 0; i < n / 1000; ++i)
+		v.push_back(long(i));
+	for(size_t i = 0; i < n / 100; ++i) {
+		v.insert(v.begin() + 1, long(i));
+		v.erase(v.begin() + 2);
+	}
+	bench::keep(v.back());
+}
+
+template <class V>
+static void vector_copy() {
+	V v(n, 1L);
+	for(int i = 0; i < 4; ++i) {
+		V w(v);
+		bench::keep(w.back());
+	}
+}
+
+template <class L>
+static void list_push_pop() {
+	L l;
+	for(size_t i = 0; i < n; ++i) {
+		l.push_back(long(i));
+		if(i & 1)
+			l.pop_front();
+	}
+	bench::keep(*l.begin());
+}
+
+template <class D>
+static void deque_push_both() {
+	D d;
+	for(size_t i = 0; i < n / 2; ++i) {
+		d.push_back(long(i));
+		d.push_front(long(i));
+	}
+	bench::keep(d.back());
+}
+
+static double best_of(void (*f)(), int rounds) {
+	double best = 1e30;
+	for(int r = 0; r < rounds; ++r)
+		best = std::min(best, bench::measure(f, 0.05));
+	return best;
+}
+
+static void compare(const char* name, void (*plain)(), void (*counted)(), void (*reference)()) {
+	const int rounds = 5;
+	double p = 1e30, c = 1e30;
+	// 交替进行, 机器状态的变化对两边的影响相同
+	for(int r = 0; r < rounds; ++r) {
+		p = std::min(p, best_of(plain, 1));
+		c = std::min(c, best_of(counted, 1));
+	}
+	double s = best_of(reference, rounds);
+	printf("%-20s null %9.3f ms  counted %9.3f ms (%+6.1f%%)  std %9.3f ms\n",
+	       name, p * 1e3, c * 1e3, (c / p - 1) * 100, s * 1e3);
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		n = strtoull(argv[1], 0, 10);
+	printf("%zu elements\n", n);
+
+	compare("vector push_back", vector_push_back<plain_vector>, vector_push_back<counted_vector>,
+	        vector_push_back<std::vector<long>>);
+	compare("vector insert/erase", vector_insert_erase<plain_vector>, vector_insert_erase<counted_vector>,
+	        vector_insert_erase<std::vector<long>>);
+	compare("vector copy", vector_copy<plain_vector>, vector_copy<counted_vector>,
+	        vector_copy<std::vector<long>>);
+	compare("list push/pop", list_push_pop<plain_list>, list_push_pop<counted_list>,
+	        list_push_pop<std::list<long>>);
+	compare("deque push both", deque_push_both<plain_deque>, deque_push_both<counted_deque>,
+	        deque_push_both<std::deque<long>>);
+
+	printf("\n");
+	instrument_registry::dump(stdout);
+	return 0;
+}
@@ -0,0 +1,106 @@
+// 建立并保存一个大数组, 再重新加载:
+// vector + write/read 与 mapped_vector 对比
+//   g++ -O2 -std=c++11 -I.. mapped_vector_bench.cpp ../Alloc.cpp ../Simd.cpp ../MmapAlloc.cpp -o mapped_vector_bench
+//   ./mapped_vector_bench [文件路径] [元素个数]
+// 文件路径可以放在tmpfs(/dev/shm)或ext4上分别测试
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../vector.h"
+#include "../mapped_vector.h"
+
+using namespace CCSTL;
+
+struct record {
+	long key;
+	double value;
+};
+
+static void write_all(int fd, const char* p, size_t n) {
+	while(n) {
+		ssize_t w = write(fd, p, n);
+		if(w <= 0)
+			abort();
+		p += w;
+		n -= size_t(w);
+	}
+}
+
+static void read_all(int fd, char* p, size_t n) {
+	while(n) {
+		ssize_t r = read(fd, p, n);
+		if(r <= 0)
+			abort();
+		p += r;
+		n -= size_t(r);
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* path = argc > 1 ? argv[1] : "/tmp/mapped_vector_bench.bin";
+	size_t n = argc > 2 ? strtoull(argv[2], 0, 10) : 20000000;
+	double mb = double(n * sizeof(record)) / (1 << 20);
+	printf("%zu records, %.0f MB, %s\n", n, mb, path);
+
+	// vector: 在匿名内存中建立, 再整体写入文件
+	{
+		double start = bench::now_sec();
+		vector<record> v;
+		for(size_t i = 0; i < n; ++i)
+			v.push_back(record{long(i), i * 0.5});
+		double built = bench::now_sec();
+		int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		size_t size = v.size();
+		write_all(fd, reinterpret_cast<const char*>(&size), sizeof(size));
+		write_all(fd, reinterpret_cast<const char*>(&v[0]), size * sizeof(record));
+		fsync(fd);
+		close(fd);
+		double saved = bench::now_sec();
+		printf("vector         build %8.3f s  save %8.3f s\n", built - start, saved - built);
+	}
+	{
+		double start = bench::now_sec();
+		int fd = open(path, O_RDONLY);
+		size_t size;
+		read_all(fd, reinterpret_cast<char*>(&size), sizeof(size));
+		vector<record> v(size, record());
+		read_all(fd, reinterpret_cast<char*>(&v[0]), size * sizeof(record));
+		close(fd);
+		double loaded = bench::now_sec();
+		long sum = 0;
+		for(size_t i = 0; i < v.size(); ++i)
+			sum += v[i].key;
+		bench::keep(sum);
+		double scanned = bench::now_sec();
+		printf("vector         load  %8.3f s  scan %8.3f s\n", loaded - start, scanned - loaded);
+	}
+
+	// mapped_vector: 直接在文件中建立, 重新打开时不复制
+	{
+		double start = bench::now_sec();
+		mapped_vector<record> v;
+		v.create(path);
+		for(size_t i = 0; i < n; ++i)
+			v.push_back(record{long(i), i * 0.5});
+		double built = bench::now_sec();
+		v.sync();
+		double saved = bench::now_sec();
+		printf("mapped_vector  build %8.3f s  save %8.3f s\n", built - start, saved - built);
+	}
+	{
+		double start = bench::now_sec();
+		mapped_vector<record> v;
+		v.open(path, false);
+		double loaded = bench::now_sec();
+		v.advise(mapped_file::ADVISE_SEQUENTIAL);
+		long sum = 0;
+		for(const record* p = v.begin(); p != v.end(); ++p)
+			sum += p->key;
+		bench::keep(sum);
+		double scanned = bench::now_sec();
+		printf("mapped_vector  open  %8.3f s  scan %8.3f s\n", loaded - start, scanned - loaded);
+	}
+	unlink(path);
+	return 0;
+}
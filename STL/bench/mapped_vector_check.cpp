@@ -0,0 +1,192 @@
+// mapped_vector在真实文件系统上的往返检查: 新建、扩容、关闭后重新打开、只读打开、文件头校验
+//   g++ -O2 -std=c++11 -I.. mapped_vector_check.cpp ../Alloc.cpp ../Simd.cpp ../MmapAlloc.cpp -o mapped_vector_check
+//   ./mapped_vector_check [目录...]
+// 默认检查/dev/shm(tmpfs)和/tmp, 在每个目录里建一个临时文件, 结束时删除.
+// 全部通过返回0, 否则打印失败的检查并返回1
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#include "../mapped_vector.h"
+
+using namespace CCSTL;
+
+struct record {
+	long key;
+	double value;
+};
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) { \
+			printf("  FAILED line %d: %s\n", __LINE__, #cond); \
+			++failures; \
+		} \
+	} while(0)
+
+static const char* fs_name(const char* dir) {
+	struct statfs st;
+	if(statfs(dir, &st) != 0)
+		return "?";
+	switch(st.f_type) {
+	case 0x01021994: return "tmpfs";
+	case 0xEF53: return "ext2/3/4";
+	case 0x58465342: return "xfs";
+	case 0x9123683E: return "btrfs";
+	default: return "other";
+	}
+}
+
+static bool same(const record& r, long i) {
+	return r.key == i && r.value == double(i) * 0.5;
+}
+
+// open()应当拒绝的文件: 先用f把正常的文件改坏
+template <class F>
+static void expect_rejected(const std::string& path, const char* what, F f) {
+	{
+		mapped_vector<record> v;
+		v.create(path.c_str());
+		for(long i = 0; i < 10; ++i)
+			v.push_back(record{i, double(i) * 0.5});
+		f(v);
+	}
+	bool rejected = false;
+	try {
+		mapped_vector<record> v;
+		v.open(path.c_str());
+	} catch(const std::system_error& e) {
+		rejected = e.code() == std::errc::invalid_argument;
+	}
+	if(!rejected)
+		printf("  FAILED: %s was accepted\n", what);
+	failures += !rejected;
+}
+
+static void check_dir(const char* dir) {
+	std::string path = std::string(dir) + "/mapped_vector_check." + std::to_string(long(getpid()));
+	printf("%s (%s)\n", dir, fs_name(dir));
+	const long n = 1 << 20;
+
+	// 新建并逐个追加, 跨过多次扩容
+	{
+		mapped_vector<record> v;
+		v.create(path.c_str());
+		for(long i = 0; i < n; ++i)
+			v.push_back(record{i, double(i) * 0.5});
+		CHECK(v.size() == size_t(n));
+		CHECK(v.capacity() >= v.size());
+		bool ok = true;
+		for(long i = 0; i < n; ++i)
+			ok = ok && same(v[i], i);
+		CHECK(ok);
+		v.sync();
+	}
+
+	// 重新打开: 数据和大小都在, 继续追加, 再截短到正好
+	{
+		mapped_vector<record> v(path.c_str());
+		CHECK(v.size() == size_t(n));
+		v.advise(mapped_file::ADVISE_SEQUENTIAL);
+		bool ok = true;
+		long i = 0;
+		for(mapped_vector<record>::const_iterator it = v.begin(); it != v.end(); ++it, ++i)
+			ok = ok && same(*it, i);
+		CHECK(ok && i == n);
+		v.push_back(record{n, double(n) * 0.5});
+		v.shrink_to_fit();
+		CHECK(v.capacity() == v.size());
+	}
+
+	// 只读打开
+	{
+		mapped_vector<record> v;
+		v.open(path.c_str(), false);
+		const mapped_vector<record>& cv = v;
+		CHECK(cv.size() == size_t(n + 1));
+		CHECK(same(cv.back(), n));
+		v.advise(mapped_file::ADVISE_RANDOM, 0, 1000);
+		bool refused = false;
+		try {
+			v.reserve(v.capacity() + 1);
+		} catch(const std::system_error&) {
+			refused = true;
+		}
+		CHECK(refused);
+	}
+
+	// 满的时候追加容器里已有的元素: 参数引用的旧映射在扩容后失效
+	{
+		mapped_vector<long> v;
+		v.create(path.c_str());
+		v.push_back(7);
+		while(v.size() < v.capacity())
+			v.push_back(long(v.size()));
+		for(int round = 0; round < 4; ++round) {
+			size_t cap = v.capacity();
+			v.push_back(v[0]);
+			CHECK(v.capacity() > cap && v.back() == 7);
+			while(v.size() < v.capacity())
+				v.push_back(long(v.size()));
+		}
+		size_t old = v.size();
+		v.resize(v.capacity() + 100, v[0]);
+		CHECK(v[old] == 7 && v.back() == 7);
+	}
+
+	expect_rejected(path, "bad magic", [](mapped_vector<record>& v) {
+		reinterpret_cast<char*>(v.data())[-64] = 'X';
+	});
+	expect_rejected(path, "size larger than capacity", [](mapped_vector<record>& v) {
+		v.shrink_to_fit();
+		reinterpret_cast<uint64_t*>(reinterpret_cast<char*>(v.data()) - 64)[2] = v.size() + 1;
+	});
+	{
+		// 元素类型不同(sizeof不同)
+		mapped_vector<record> v;
+		v.create(path.c_str());
+		v.push_back(record{1, 0.5});
+	}
+	bool rejected = false;
+	try {
+		mapped_vector<long> v;
+		v.open(path.c_str());
+	} catch(const std::system_error& e) {
+		rejected = e.code() == std::errc::invalid_argument;
+	}
+	CHECK(rejected);
+	{
+		// 比文件头还短的文件
+		int fd = ::open(path.c_str(), O_WRONLY | O_TRUNC);
+		CHECK(fd >= 0 && write(fd, "CCSTLMV", 8) == 8);
+		::close(fd);
+	}
+	rejected = false;
+	try {
+		mapped_vector<record> v;
+		v.open(path.c_str());
+	} catch(const std::system_error& e) {
+		rejected = e.code() == std::errc::invalid_argument;
+	}
+	CHECK(rejected);
+
+	unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1) {
+		for(int i = 1; i < argc; ++i)
+			check_dir(argv[i]);
+	} else {
+		check_dir("/dev/shm");
+		check_dir("/tmp");
+	}
+	printf(failures ? "%d check(s) failed\n" : "all checks passed\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+// 并行算法的扩展性测试: 同一组操作在1..N个线程上的耗时与加速比
+//   g++ -O2 -std=c++11 -I.. parallel_bench.cpp ../Alloc.cpp ../Simd.cpp ../ThreadPool.cpp -pthread -o parallel_bench
+//   ./parallel_bench [元素个数] [最大线程数]
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "bench.h"
+#include "../vector.h"
+#include "../execution.h"
+
+using namespace CCSTL;
+
+static size_t n = 1 << 24;
+
+struct result {
+	const char* name;
+	double base;
+};
+
+static void row(result& r, size_t threads, double sec) {
+	if(threads == 1)
+		r.base = sec;
+	printf("%-16s %3zu threads %10.2f ms  x%.2f\n", r.name, threads, sec * 1e3, r.base / sec);
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		n = strtoull(argv[1], 0, 10);
+	size_t max_threads = argc > 2 ? strtoull(argv[2], 0, 10) : std::thread::hardware_concurrency();
+
+	vector<double> src(n, 0.0);
+	vector<double> dst(n, 0.0);
+	for(size_t i = 0; i < n; ++i)
+		src[i] = double((i * 2654435761u) % 1000003);
+	deque<double> dq;
+	for(size_t i = 0; i < n; ++i)
+		dq.push_back(src[i]);
+
+	result rs[] = { {"for_each", 0}, {"transform", 0}, {"reduce", 0}, {"reduce(deque)", 0},
+	                {"inclusive_scan", 0}, {"copy", 0}, {"sort", 0} };
+	double reference = 0;
+	// 线程数按1, 2, 4, ...增长, 最后一轮一定是max_threads
+	for(size_t threads = 1; threads <= max_threads;
+	    threads = threads < max_threads && threads * 2 > max_threads ? max_threads : threads * 2) {
+		thread_pool pool(threads);
+		execution::parallel_policy par = execution::par(pool);
+
+		row(rs[0], threads, bench::measure([&] {
+			CCSTL::for_each(par, dst.begin(), dst.end(), [](double& x) { x = x * 0.5 + 1; });
+		}));
+		row(rs[1], threads, bench::measure([&] {
+			CCSTL::transform(par, src.begin(), src.end(), dst.begin(), [](double x) { return x * x; });
+		}));
+		double sum = 0;
+		row(rs[2], threads, bench::measure([&] {
+			sum = CCSTL::reduce(par, src.begin(), src.end(), 0.0);
+		}));
+		// 分块与线程数无关, 所以浮点数求和的结果在任何线程数下都应完全相同
+		if(threads == 1)
+			reference = sum;
+		else if(memcmp(&sum, &reference, sizeof(double)) != 0)
+			printf("reduce result differs: %.17g vs %.17g\n", sum, reference);
+		row(rs[3], threads, bench::measure([&] {
+			bench::keep(CCSTL::reduce(par, dq.begin(), dq.end(), 0.0));
+		}));
+		row(rs[4], threads, bench::measure([&] {
+			CCSTL::inclusive_scan(par, src.begin(), src.end(), dst.begin());
+		}));
+		row(rs[5], threads, bench::measure([&] {
+			CCSTL::copy(par, src.begin(), src.end(), dst.begin());
+		}));
+		row(rs[6], threads, bench::measure([&] {
+			CCSTL::copy(par, src.begin(), src.end(), dst.begin());
+			CCSTL::sort(par, dst.begin(), dst.end());
+		}, 0));
+	}
+	return 0;
+}
@@ -0,0 +1,127 @@
+// persistent_vector与复制整个vector做快照的对比
+//   g++ -O2 -std=c++11 -I.. persistent_vector_bench.cpp ../Alloc.cpp ../Simd.cpp -pthread -o persistent_vector_bench
+//   ./persistent_vector_bench [元素个数]
+// snapshot   取一份只读快照: persistent_vector只加两次引用计数, vector要整块复制
+// update     快照之后改一个随机位置: persistent_vector复制一条路径, vector在快照之外原地改
+//            (vector + snapshot一栏是每次修改前都复制一份快照, 即现在的做法)
+// build      逐个push_back建出整个容器: persistent(每次返回新版本)、transient(原地批量修改)与vector
+// iterate    顺序求和, persistent_vector的迭代器缓存当前叶子, 每32个元素才从根找一次
+// random get 随机下标读取, persistent_vector每次要走log32(n)层
+#include <cstdlib>
+#include "bench.h"
+#include "../persistent_vector.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+static size_t nelems = 1 << 20;
+
+static unsigned long long rng = 88172645463325252ull;
+static size_t next_rand() {
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return size_t(rng);
+}
+
+static void report(const char* op, const char* impl, double sec, size_t per) {
+	printf("%-10s %-24s %12.2f ns\n", op, impl, sec * 1e9 / per);
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		nelems = strtoull(argv[1], 0, 10);
+	printf("%zu elements of %zu bytes\n", nelems, sizeof(long));
+
+	vector<long> v;
+	transient_vector<long> t;
+	for(size_t i = 0; i < nelems; ++i) {
+		v.push_back(long(i));
+		t.push_back(long(i));
+	}
+	persistent_vector<long> p = t.persistent();
+
+	// 每行的单位: snapshot/update是每次操作, build/iterate/random get是每个元素
+	report("snapshot", "persistent_vector", bench::measure([&] {
+		persistent_vector<long> snap(p);
+		bench::keep(snap.size());
+	}), 1);
+	report("snapshot", "vector copy", bench::measure([&] {
+		vector<long> snap(v);
+		bench::keep(snap.back());
+	}), 1);
+
+	const size_t updates = 1000;
+	report("update", "persistent_vector", bench::measure([&] {
+		persistent_vector<long> cur(p);
+		for(size_t k = 0; k < updates; ++k)
+			cur = cur.set(next_rand() % nelems, long(k));
+		bench::keep(cur.back());
+	}), updates);
+	report("update", "transient", bench::measure([&] {
+		transient_vector<long> cur = p.transient();
+		for(size_t k = 0; k < updates; ++k)
+			cur.set(next_rand() % nelems, long(k));
+		bench::keep(cur.size());
+	}), updates);
+	report("update", "vector in place", bench::measure([&] {
+		for(size_t k = 0; k < updates; ++k)
+			v[next_rand() % nelems] = long(k);
+		bench::keep(v.back());
+	}), updates);
+	report("update", "vector + snapshot", bench::measure([&] {
+		for(size_t k = 0; k < 10; ++k) {
+			vector<long> snap(v);
+			v[next_rand() % nelems] = long(k);
+			bench::keep(snap.back());
+		}
+	}), 10);
+
+	report("build", "persistent push_back", bench::measure([&] {
+		persistent_vector<long> b;
+		for(size_t i = 0; i < nelems; ++i)
+			b = b.push_back(long(i));
+		bench::keep(b.size());
+	}), nelems);
+	report("build", "transient push_back", bench::measure([&] {
+		transient_vector<long> b;
+		for(size_t i = 0; i < nelems; ++i)
+			b.push_back(long(i));
+		persistent_vector<long> r = b.persistent();
+		bench::keep(r.size());
+	}), nelems);
+	report("build", "vector push_back", bench::measure([&] {
+		vector<long> b;
+		for(size_t i = 0; i < nelems; ++i)
+			b.push_back(long(i));
+		bench::keep(b.size());
+	}), nelems);
+
+	report("iterate", "persistent_vector", bench::measure([&] {
+		long sum = 0;
+		for(persistent_vector<long>::const_iterator it = p.begin(); it != p.end(); ++it)
+			sum += *it;
+		bench::keep(sum);
+	}), nelems);
+	report("iterate", "vector", bench::measure([&] {
+		long sum = 0;
+		for(vector<long>::iterator it = v.begin(); it != v.end(); ++it)
+			sum += *it;
+		bench::keep(sum);
+	}), nelems);
+
+	const size_t gets = 1 << 16;
+	report("random get", "persistent_vector", bench::measure([&] {
+		long sum = 0;
+		for(size_t k = 0; k < gets; ++k)
+			sum += p[next_rand() % nelems];
+		bench::keep(sum);
+	}), gets);
+	report("random get", "vector", bench::measure([&] {
+		long sum = 0;
+		for(size_t k = 0; k < gets; ++k)
+			sum += v[next_rand() % nelems];
+		bench::keep(sum);
+	}), gets);
+	return 0;
+}
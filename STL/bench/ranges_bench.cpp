@@ -0,0 +1,115 @@
+// 惰性视图(ranges.h)与每一步都生成一个临时vector的写法对比
+//   g++ -O2 -std=c++11 -I.. ranges_bench.cpp ../Alloc.cpp ../Simd.cpp -o ranges_bench
+//   ./ranges_bench [元素个数]
+// 三条流水线:
+//   filter|transform|take   留下偶数, 乘3, 取前一半, 求和
+//   transform|to<vector>    随机访问, 长度已知, to一次预留好
+//   zip|filter|transform    两个vector逐对相乘, 留下乘积为正的, 求和
+// materialize是逐步push_back到临时vector里(没有reserve, 每一步都要反复扩容),
+// list一栏是同样的流水线作用在list上. 每一行是平摊到每个输入元素的纳秒数
+#include <cstdlib>
+#include "bench.h"
+#include "../List.h"
+#include "../ranges.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+static size_t nelems = 1 << 20;
+
+static void report(const char* pipeline, const char* impl, double sec) {
+	printf("%-24s %-20s %8.3f ns\n", pipeline, impl, sec * 1e9 / nelems);
+}
+
+struct is_even {
+	bool operator()(int x) const { return x % 2 == 0; }
+};
+
+struct triple {
+	long operator()(int x) const { return long(x) * 3; }
+};
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		nelems = strtoull(argv[1], 0, 10);
+	printf("%zu elements\n", nelems);
+
+	vector<int> v;
+	vector<int> w;
+	list<int> l;
+	for(size_t i = 0; i < nelems; ++i) {
+		int x = int((i * 2654435761u) >> 7) - (1 << 23);
+		v.push_back(x);
+		w.push_back(int(i % 7) - 3);
+		l.push_back(x);
+	}
+	const ptrdiff_t half = ptrdiff_t(nelems / 4);
+
+	report("filter|transform|take", "views", bench::measure([&] {
+		long sum = 0;
+		for(long x : v | views::filter(is_even()) | views::transform(triple()) | views::take(half))
+			sum += x;
+		bench::keep(sum);
+	}));
+	report("filter|transform|take", "materialize", bench::measure([&] {
+		vector<int> evens;
+		for(size_t i = 0; i < v.size(); ++i) {
+			if(is_even()(v[i]))
+				evens.push_back(v[i]);
+		}
+		vector<long> tripled;
+		for(size_t i = 0; i < evens.size(); ++i)
+			tripled.push_back(triple()(evens[i]));
+		vector<long> taken;
+		for(size_t i = 0; i < tripled.size() && ptrdiff_t(i) < half; ++i)
+			taken.push_back(tripled[i]);
+		long sum = 0;
+		for(size_t i = 0; i < taken.size(); ++i)
+			sum += taken[i];
+		bench::keep(sum);
+	}));
+	report("filter|transform|take", "views (list)", bench::measure([&] {
+		long sum = 0;
+		for(long x : l | views::filter(is_even()) | views::transform(triple()) | views::take(half))
+			sum += x;
+		bench::keep(sum);
+	}));
+
+	report("transform|to<vector>", "views", bench::measure([&] {
+		vector<long> out = v | views::transform(triple()) | to<vector>();
+		bench::keep(out.back());
+	}));
+	report("transform|to<vector>", "materialize", bench::measure([&] {
+		vector<long> out;
+		for(size_t i = 0; i < v.size(); ++i)
+			out.push_back(triple()(v[i]));
+		bench::keep(out.back());
+	}));
+
+	report("zip|filter|transform", "views", bench::measure([&] {
+		long sum = 0;
+		auto positive = [](const std::pair<int&, int&>& p) { return long(p.first) * p.second > 0; };
+		auto product = [](const std::pair<int&, int&>& p) { return long(p.first) * p.second; };
+		for(long x : views::zip(v, w) | views::filter(positive) | views::transform(product))
+			sum += x;
+		bench::keep(sum);
+	}));
+	report("zip|filter|transform", "materialize", bench::measure([&] {
+		vector<std::pair<int, int> > zipped;
+		for(size_t i = 0; i < v.size() && i < w.size(); ++i)
+			zipped.push_back(std::pair<int, int>(v[i], w[i]));
+		vector<std::pair<int, int> > kept;
+		for(size_t i = 0; i < zipped.size(); ++i) {
+			if(long(zipped[i].first) * zipped[i].second > 0)
+				kept.push_back(zipped[i]);
+		}
+		vector<long> products;
+		for(size_t i = 0; i < kept.size(); ++i)
+			products.push_back(long(kept[i].first) * kept[i].second);
+		long sum = 0;
+		for(size_t i = 0; i < products.size(); ++i)
+			sum += products[i];
+		bench::keep(sum);
+	}));
+	return 0;
+}
@@ -0,0 +1,154 @@
+// 二进制序列化(Serialize.h)与逐个元素经过iostream读写的对比
+//   g++ -O2 -std=c++11 -I.. serialize_bench.cpp ../Alloc.cpp ../Simd.cpp ../Serialize.cpp ../MmapAlloc.cpp -o serialize_bench
+//   ./serialize_bench [元素个数] [文件路径]
+// 元素是16字节的结构体, 默认4M个(64MB). 写出的文件在页缓存里, 测的是复制和系统调用的开销, 不是磁盘.
+// serial::write对vector是一次writev, deque每个缓冲区一个iovec, list逐个复制进暂存区;
+// iostream逐个元素调用write/read. view是mmap之后直接在文件上求和, 不复制数据.
+// 每一行是负载的GB/s
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../List.h"
+#include "../MmapAlloc.h"
+#include "../Serialize.h"
+#include "../deque.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+struct sample {
+	long timestamp;
+	int sensor;
+	float value;
+};
+
+static size_t nelems = 4 << 20;
+static const char* path = "/tmp/ccstl_serialize_bench.bin";
+
+static void report(const char* op, const char* impl, double sec) {
+	double bytes = double(nelems) * sizeof(sample);
+	printf("%-10s %-24s %8.2f GB/s\n", op, impl, bytes / sec / 1e9);
+}
+
+static int open_write() {
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		perror(path);
+		exit(1);
+	}
+	return fd;
+}
+
+static int open_read() {
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		perror(path);
+		exit(1);
+	}
+	return fd;
+}
+
+template <class C>
+static void write_serial(const C& c) {
+	int fd = open_write();
+	serial::write(fd, c);
+	close(fd);
+}
+
+template <class C>
+static void read_serial(C& c) {
+	int fd = open_read();
+	serial::read(fd, c);
+	close(fd);
+}
+
+template <class Iterator>
+static void write_stream(Iterator first, Iterator last) {
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	size_t n = nelems;
+	out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+	for(; first != last; ++first)
+		out.write(reinterpret_cast<const char*>(&*first), sizeof(sample));
+}
+
+static void read_stream(vector<sample>& v) {
+	std::ifstream in(path, std::ios::binary);
+	size_t n = 0;
+	in.read(reinterpret_cast<char*>(&n), sizeof(n));
+	vector<sample> tmp;
+	sample s;
+	for(size_t i = 0; i < n && in.read(reinterpret_cast<char*>(&s), sizeof(s)); ++i)
+		tmp.push_back(s);
+	v.swap(tmp);
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		nelems = strtoull(argv[1], 0, 10);
+	if(argc > 2)
+		path = argv[2];
+	printf("%zu elements of %zu bytes (%.1f MB), file %s\n",
+	       nelems, sizeof(sample), nelems * sizeof(sample) / 1e6, path);
+
+	vector<sample> v;
+	deque<sample> d;
+	list<sample> l;
+	for(size_t i = 0; i < nelems; ++i) {
+		sample s;
+		s.timestamp = long(i) * 1000;
+		s.sensor = int(i % 64);
+		s.value = float(i) * 0.5f;
+		v.push_back(s);
+		d.push_back(s);
+		l.push_back(s);
+	}
+
+	report("write", "serial vector", bench::measure([&] { write_serial(v); }));
+	report("write", "serial deque", bench::measure([&] { write_serial(d); }));
+	report("write", "serial list", bench::measure([&] { write_serial(l); }));
+	report("write", "ofstream per element", bench::measure([&] { write_stream(v.begin(), v.end()); }));
+
+	write_serial(v);
+	report("read", "serial vector", bench::measure([&] {
+		vector<sample> r;
+		read_serial(r);
+		bench::keep(r.back().value);
+	}));
+	report("read", "serial deque", bench::measure([&] {
+		deque<sample> r;
+		read_serial(r);
+		bench::keep(r.back().value);
+	}));
+
+	// 文件已经在页缓存里, 映射和缺页的开销也算在内
+	report("read+sum", "serial view (mmap)", bench::measure([&] {
+		mapped_file f;
+		f.open(path, false);
+		serial::vector_view<sample> view = serial::view<sample>(f.data(), f.size());
+		double sum = 0;
+		for(size_t i = 0; i < view.size(); ++i)
+			sum += view[i].value;
+		bench::keep(sum);
+	}));
+	report("read+sum", "serial read vector", bench::measure([&] {
+		vector<sample> r;
+		read_serial(r);
+		double sum = 0;
+		for(size_t i = 0; i < r.size(); ++i)
+			sum += r[i].value;
+		bench::keep(sum);
+	}));
+
+	write_stream(v.begin(), v.end());
+	report("read", "ifstream per element", bench::measure([&] {
+		vector<sample> r;
+		read_stream(r);
+		bench::keep(r.back().value);
+	}));
+
+	unlink(path);
+	return 0;
+}
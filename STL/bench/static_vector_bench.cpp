@@ -0,0 +1,79 @@
+// static_vector与预先reserve的vector对比: 小批量地建一个容器、填满、遍历一遍再丢掉
+//   g++ -O2 -std=c++11 -I.. static_vector_bench.cpp ../Alloc.cpp ../Simd.cpp -o static_vector_bench
+//   ./static_vector_bench [批次数]
+// 每批的元素个数在8~128之间, static_vector的容量取128和32. vector每批都要从内存池取一块再还回去,
+// static_vector完全不经过分配器. 用-std=c++14/17编译时, 元素是平凡类型的static_vector
+// 构造时要把全部位置清零(constexpr构造函数的要求), 批量小、容量大时可以看出这部分开销.
+// 每一行是平摊到每个元素的纳秒数
+#include <cstdlib>
+#include <vector>
+#include "bench.h"
+#include "../static_vector.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+static size_t batches = 100000;
+
+struct field {
+	int id;
+	int length;
+	long offset;
+};
+
+static field make(size_t i) {
+	field f;
+	f.id = int(i);
+	f.length = int(i * 7);
+	f.offset = long(i) << 4;
+	return f;
+}
+
+template <class C>
+static void build_and_iterate(size_t batch, bool reserve) {
+	long sum = 0;
+	for(size_t b = 0; b < batches; ++b) {
+		C c;
+		if(reserve)
+			c.reserve(batch);
+		for(size_t i = 0; i < batch; ++i)
+			c.push_back(make(b + i));
+		for(typename C::const_iterator it = c.begin(); it != c.end(); ++it)
+			sum += it->offset + it->length;
+	}
+	bench::keep(sum);
+}
+
+static void report(size_t batch, const char* impl, double sec) {
+	printf("batch %4zu  %-28s %8.2f ns\n", batch, impl, sec * 1e9 / (batches * batch));
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		batches = strtoull(argv[1], 0, 10);
+	printf("%zu batches, element %zu bytes, static_vector<field, 128> %zu bytes\n",
+	       batches, sizeof(field), sizeof(static_vector<field, 128>));
+
+	const size_t sizes[] = {8, 32, 128};
+	for(size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+		size_t batch = sizes[k];
+		report(batch, "static_vector<128>", bench::measure([&] {
+			build_and_iterate<static_vector<field, 128>>(batch, false);
+		}));
+		if(batch <= 32) {
+			report(batch, "static_vector<32>", bench::measure([&] {
+				build_and_iterate<static_vector<field, 32>>(batch, false);
+			}));
+		}
+		report(batch, "CCSTL::vector + reserve", bench::measure([&] {
+			build_and_iterate<vector<field>>(batch, true);
+		}));
+		report(batch, "CCSTL::vector", bench::measure([&] {
+			build_and_iterate<vector<field>>(batch, false);
+		}));
+		report(batch, "std::vector + reserve", bench::measure([&] {
+			build_and_iterate<std::vector<field>>(batch, true);
+		}));
+	}
+	return 0;
+}
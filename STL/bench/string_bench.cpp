@@ -0,0 +1,185 @@
+// CCSTL::string与std::string对比, 短字符串(能放进对象内部)和长字符串两组负载
+//   g++ -O2 -std=c++11 -I.. string_bench.cpp ../Alloc.cpp ../Simd.cpp -o string_bench
+//   ./string_bench [字符串个数]
+// 短字符串长度在8~20之间, 两边都不分配内存(CCSTL最多22个字符, libstdc++最多15个, 所以16~20只有CCSTL能放下);
+// 长字符串长度在100~300之间. 每一行是平摊到每个字符串的纳秒数.
+// find是在字符串里找一个不存在的子串(最坏情况, 要扫完全部字符); split把一整段文本按空格切开,
+// string_view只记录位置, std::string每段都要复制一次
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "../basic_string.h"
+#include "../vector.h"
+
+using namespace CCSTL;
+
+static size_t nstrings = 100000;
+
+static unsigned long long rng = 88172645463325252ull;
+static uint64_t next_rand() {
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return rng;
+}
+
+// 随机的小写单词, 用空格分开
+static std::vector<std::string> make_words(size_t n, size_t min_len, size_t max_len) {
+	std::vector<std::string> words;
+	for(size_t i = 0; i < n; ++i) {
+		size_t len = min_len + next_rand() % (max_len - min_len + 1);
+		std::string w;
+		for(size_t k = 0; k < len; ++k)
+			w.push_back((k % 7 == 6) ? ' ' : char('a' + next_rand() % 26));
+		words.push_back(w);
+	}
+	return words;
+}
+
+static void report(const char* group, const char* op, const char* impl, double sec, size_t n) {
+	printf("%-6s %-12s %-14s %9.2f ns\n", group, op, impl, sec * 1e9 / n);
+}
+
+template <class S>
+static std::vector<S> convert(const std::vector<std::string>& words) {
+	std::vector<S> r;
+	for(size_t i = 0; i < words.size(); ++i)
+		r.push_back(S(words[i].c_str()));
+	return r;
+}
+
+template <class S, class V>
+static void run(const char* group, const char* impl, const std::vector<std::string>& words) {
+	std::vector<S> in = convert<S>(words);
+	const size_t n = in.size();
+
+	report(group, "construct", impl, bench::measure([&] {
+		for(size_t i = 0; i < n; ++i) {
+			S s(words[i].c_str());
+			bench::keep(s.data()[0]);
+		}
+	}), n);
+
+	report(group, "copy", impl, bench::measure([&] {
+		std::vector<S> out(in);
+		bench::keep(out.back().data()[0]);
+	}), n);
+
+	// 逐字符追加, 测扩容
+	report(group, "push_back", impl, bench::measure([&] {
+		for(size_t i = 0; i < n; ++i) {
+			S s;
+			const std::string& w = words[i];
+			for(size_t k = 0; k < w.size(); ++k)
+				s.push_back(w[k]);
+			bench::keep(s.data()[0]);
+		}
+	}), n);
+
+	report(group, "append", impl, bench::measure([&] {
+		S s;
+		for(size_t i = 0; i < n; ++i)
+			s += in[i];
+		bench::keep(s.data()[0]);
+	}), n);
+
+	// 容器扩容时字符串的搬迁
+	report(group, "vec growth", impl, bench::measure([&] {
+		V v;
+		for(size_t i = 0; i < n; ++i)
+			v.push_back(in[i]);
+		bench::keep(v.back().data()[0]);
+	}), n);
+
+	report(group, "find", impl, bench::measure([&] {
+		size_t hits = 0;
+		for(size_t i = 0; i < n; ++i)
+			hits += in[i].find("qzj") != S::npos;
+		bench::keep(hits);
+	}), n);
+
+	report(group, "find char", impl, bench::measure([&] {
+		size_t hits = 0;
+		for(size_t i = 0; i < n; ++i)
+			hits += in[i].find('#') != S::npos;
+		bench::keep(hits);
+	}), n);
+
+	// 与只有最后一个字符不同的副本比较
+	std::vector<S> other(in);
+	for(size_t i = 0; i < n; ++i)
+		other[i].back() = '#';
+	report(group, "compare", impl, bench::measure([&] {
+		int sum = 0;
+		for(size_t i = 0; i < n; ++i)
+			sum += in[i].compare(other[i]) < 0;
+		bench::keep(sum);
+	}), n);
+	report(group, "equal", impl, bench::measure([&] {
+		size_t same = 0;
+		for(size_t i = 0; i < n; ++i)
+			same += in[i] == other[i];
+		bench::keep(same);
+	}), n);
+
+	report(group, "sort", impl, bench::measure([&] {
+		std::vector<S> v(in);
+		std::sort(v.begin(), v.end());
+		bench::keep(v.front().data()[0]);
+	}, 0.5), n);
+}
+
+// 把全部单词连成一段文本, 按空格切分并统计长度
+static void run_split(const std::vector<std::string>& words) {
+	std::string text;
+	for(size_t i = 0; i < words.size(); ++i) {
+		text += words[i];
+		text += ' ';
+	}
+	const size_t n = words.size();
+
+	report("text", "split", "string_view", bench::measure([&] {
+		string_view rest(text.data(), text.size());
+		size_t total = 0;
+		while(!rest.empty()) {
+			size_t sp = rest.find(' ');
+			if(sp == string_view::npos)
+				sp = rest.size();
+			total += rest.substr(0, sp).size();
+			rest.remove_prefix(sp == rest.size() ? sp : sp + 1);
+		}
+		bench::keep(total);
+	}), n);
+
+	report("text", "split", "std::string", bench::measure([&] {
+		size_t total = 0, pos = 0;
+		while(pos < text.size()) {
+			size_t sp = text.find(' ', pos);
+			if(sp == std::string::npos)
+				sp = text.size();
+			std::string field = text.substr(pos, sp - pos);
+			total += field.size();
+			pos = sp + 1;
+		}
+		bench::keep(total);
+	}), n);
+}
+
+int main(int argc, char** argv) {
+	if(argc > 1)
+		nstrings = strtoull(argv[1], 0, 10);
+	printf("%zu strings, CCSTL::string %zu bytes (%zu inline chars), std::string %zu bytes\n",
+	       nstrings, sizeof(string), size_t(string::sso_capacity), sizeof(std::string));
+
+	std::vector<std::string> short_words = make_words(nstrings, 8, 20);
+	std::vector<std::string> long_words = make_words(nstrings / 10, 100, 300);
+
+	run<string, vector<string>>("short", "CCSTL", short_words);
+	run<std::string, std::vector<std::string>>("short", "std", short_words);
+	run<string, vector<string>>("long", "CCSTL", long_words);
+	run<std::string, std::vector<std::string>>("long", "std", long_words);
+	run_split(short_words);
+	return 0;
+}
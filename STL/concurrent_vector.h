@@ -0,0 +1,214 @@
+#ifndef CONCURRENT_VECTOR_H
+#define CONCURRENT_VECTOR_H
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "Allocator.h"
+#include "Iterator.h"
+
+namespace CCSTL {
+    // 只能追加的并发vector
+    //
+    // 元素存放在一组按指数增长的段中: 第k段可容纳 first_block << k 个元素,
+    // 第k段的第一个元素的下标为 first_block * (2^k - 1). 段一旦分配就不会移动,
+    // 所以已有元素的地址永远有效, 追加时也不会使读者看到的元素失效 ——
+    // 这与vector::insert_aux重新配置整块空间不同, 更像deque的map加缓冲区.
+    //
+    // push_back/grow_by用fetch_add原子地占住下标区间, 之后各线程在自己的区间里
+    // 构造元素, 互不干扰; 只有某一段第一次被用到时才需要分配, 整个生命周期内最多分配log(n)次.
+    // 分配和释放段时持有alloc_mutex()(见Alloc.h): 内存池不是线程安全的, 每个容器自己的锁
+    // 挡不住另一个concurrent_vector同时在别的线程里扩容.
+    //
+    // size()返回已经被占用的下标个数, 其中可能有元素还在构造中;
+    // 读取下标i的元素前, 需要与追加它的线程同步(例如通过push_back的返回值传递i)
+    template <class T, class Alloc = allocator<T>>
+    class concurrent_vector {
+    public:
+        typedef T value_type;
+        typedef value_type* pointer;
+        typedef const value_type* const_pointer;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+    private:
+        typedef Alloc dataAllocator;
+
+        // 第0段的元素个数, 取2的幂
+        static const size_type first_block = 8;
+        static const size_type first_block_log = 3;
+        static const size_type max_segments = sizeof(size_type) * 8 - first_block_log;
+
+        std::atomic<size_type> my_size;
+        std::atomic<pointer> segments[max_segments];
+
+        static size_type segment_index(size_type i) {
+            return sizeof(unsigned long long) * 8 - 1 -
+                   __builtin_clzll((unsigned long long)((i >> first_block_log) + 1));
+        }
+        static size_type segment_base(size_type k) { return first_block * ((size_type(1) << k) - 1); }
+        static size_type segment_size(size_type k) { return first_block << k; }
+
+        pointer segment(size_type k) {
+            pointer p = segments[k].load(std::memory_order_acquire);
+            return p ? p : allocate_segment(k);
+        }
+
+        pointer allocate_segment(size_type k) {
+            std::lock_guard<std::mutex> lock(alloc_mutex());
+            pointer p = segments[k].load(std::memory_order_relaxed);
+            if(!p) {
+                p = dataAllocator::allocate(segment_size(k));
+                segments[k].store(p, std::memory_order_release);
+            }
+            return p;
+        }
+
+        pointer slot(size_type i) {
+            size_type k = segment_index(i);
+            return segment(k) + (i - segment_base(k));
+        }
+
+        // 构造失败时下标已经被别的线程看到, 无法撤销, 所以构造必须不抛异常
+        template <class... Args>
+        void construct_at(size_type i, Args&&... args) noexcept {
+            new(static_cast<void*>(slot(i))) T(std::forward<Args>(args)...);
+        }
+
+        // 按段填充, 每段只查一次段指针
+        void fill_range(size_type i, size_type last, const T& x) noexcept {
+            while(i < last) {
+                size_type k = segment_index(i);
+                pointer base = segment(k) - segment_base(k);
+                size_type stop = segment_base(k) + segment_size(k);
+                if(stop > last)
+                    stop = last;
+                for(; i < stop; ++i)
+                    new(static_cast<void*>(base + i)) T(x);
+            }
+        }
+
+    public:
+        // 随机访问迭代器, 只是(容器, 下标)对
+        template <class Container, class Value>
+        class index_iterator {
+        public:
+            typedef random_access_iterator_tag iterator_category;
+            typedef Value value_type;
+            typedef Value* pointer;
+            typedef Value& reference;
+            typedef ptrdiff_t difference_type;
+            typedef index_iterator self;
+
+            index_iterator(): c(0), i(0) {}
+            index_iterator(Container* c, size_type i): c(c), i(i) {}
+
+            reference operator*() const { return (*c)[i]; }
+            pointer operator->() const { return &(*c)[i]; }
+            reference operator[](difference_type n) const { return (*c)[i + n]; }
+
+            self& operator++() { ++i; return *this; }
+            self operator++(int) { self tmp = *this; ++i; return tmp; }
+            self& operator--() { --i; return *this; }
+            self operator--(int) { self tmp = *this; --i; return tmp; }
+            self& operator+=(difference_type n) { i += n; return *this; }
+            self& operator-=(difference_type n) { i -= n; return *this; }
+            self operator+(difference_type n) const { return self(c, i + n); }
+            self operator-(difference_type n) const { return self(c, i - n); }
+            difference_type operator-(const self& x) const { return difference_type(i) - difference_type(x.i); }
+
+            bool operator==(const self& x) const { return i == x.i; }
+            bool operator!=(const self& x) const { return i != x.i; }
+            bool operator<(const self& x) const { return i < x.i; }
+
+        private:
+            Container* c;
+            size_type i;
+        };
+
+        typedef index_iterator<concurrent_vector, T> iterator;
+        typedef index_iterator<const concurrent_vector, const T> const_iterator;
+
+        concurrent_vector(): my_size(0) {
+            for(size_type k = 0; k < max_segments; ++k)
+                segments[k].store(0, std::memory_order_relaxed);
+        }
+
+        concurrent_vector(const concurrent_vector&) = delete;
+        concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+        ~concurrent_vector() {
+            clear();
+            std::lock_guard<std::mutex> lock(alloc_mutex());
+            for(size_type k = 0; k < max_segments; ++k) {
+                pointer p = segments[k].load(std::memory_order_relaxed);
+                if(p)
+                    dataAllocator::deallocate(p, segment_size(k));
+            }
+        }
+
+        // 线程安全, 返回新元素的下标
+        size_type push_back(const T& x) {
+            size_type i = my_size.fetch_add(1, std::memory_order_relaxed);
+            construct_at(i, x);
+            return i;
+        }
+
+        size_type push_back(T&& x) {
+            size_type i = my_size.fetch_add(1, std::memory_order_relaxed);
+            construct_at(i, std::move(x));
+            return i;
+        }
+
+        template <class... Args>
+        size_type emplace_back(Args&&... args) {
+            size_type i = my_size.fetch_add(1, std::memory_order_relaxed);
+            construct_at(i, std::forward<Args>(args)...);
+            return i;
+        }
+
+        // 线程安全, 一次追加n个值为x的元素, 返回第一个新元素的下标
+        size_type grow_by(size_type n, const T& x) {
+            size_type first = my_size.fetch_add(n, std::memory_order_relaxed);
+            fill_range(first, first + n, x);
+            return first;
+        }
+
+        size_type grow_by(size_type n) { return grow_by(n, T()); }
+
+        // 读取是线程安全的, 但见类前的说明: 必须先与追加该元素的线程同步
+        reference operator[](size_type i) {
+            size_type k = segment_index(i);
+            return segments[k].load(std::memory_order_acquire)[i - segment_base(k)];
+        }
+        const_reference operator[](size_type i) const {
+            size_type k = segment_index(i);
+            return segments[k].load(std::memory_order_acquire)[i - segment_base(k)];
+        }
+
+        size_type size() const { return my_size.load(std::memory_order_acquire); }
+        bool empty() const { return size() == 0; }
+        size_type capacity() const {
+            size_type k = 0;
+            while(k < max_segments && segments[k].load(std::memory_order_relaxed))
+                ++k;
+            return segment_base(k);
+        }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        // 以下操作不是线程安全的
+        void clear() {
+            size_type n = my_size.load(std::memory_order_relaxed);
+            for(size_type i = 0; i < n; ++i)
+                dataAllocator::destroy(&(*this)[i]);
+            my_size.store(0, std::memory_order_relaxed);
+        }
+    };
+}
+#endif
@@ -1,7 +1,13 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <initializer_list>
+#include <algorithm>
 #include "Iterator.h"
+#include "Allocator.h"
+#include "Instrument.h"
 
 namespace CCSTL{
 	// 如果n不为0, 传回n, 表示buffer_size由使用者自定
@@ -11,10 +17,11 @@ namespace CCSTL{
 	inline size_t __deque_buf_size(size_t n, size_t sz) {
 		return n != 0 ? n : (sz < 512 ? size_t(512 / sz) : size_t(1));
 	}
-	template <class T, size_t BufSiz>
+	template <class T, size_t BufSiz = 0>
 	struct deque_iterator {
-		typedef deque_iterator<T> iterator;
-		typedef deque_iterator<const T> const_iterator;
+		typedef typename std::remove_const<T>::type nonconst_type;
+		typedef deque_iterator<nonconst_type, BufSiz> iterator;
+		typedef deque_iterator<const nonconst_type, BufSiz> const_iterator;
 		static size_t buffer_size() { return __deque_buf_size(BufSiz, sizeof(T)); }
 
 		typedef random_access_iterator_tag iterator_category;
@@ -23,7 +30,8 @@ namespace CCSTL{
 		typedef T& reference;
 		typedef size_t size_type;
 		typedef ptrdiff_t difference_type;
-		typedef T** map_pointer;
+		// const_iterator与iterator共用同一种map, 这样iterator才能转换为const_iterator
+		typedef nonconst_type** map_pointer;
 
 		typedef deque_iterator self;
 
@@ -43,7 +51,7 @@ namespace CCSTL{
 
 		difference_type operator-(const self& x) const {
 			return difference_type(buffer_size()) * (node - x.node - 1) +
-				(cur - first) + (x.last - cur);
+				(cur - first) + (x.last - x.cur);
 		}
 
 		self& operator++() {
@@ -110,6 +118,9 @@ namespace CCSTL{
 		bool operator<(const self& x) const {
 			return (node == x.node)?(cur < x.cur):(node < x.node);
 		}
+		bool operator>(const self& x) const { return x < *this; }
+		bool operator<=(const self& x) const { return !(x < *this); }
+		bool operator>=(const self& x) const { return !(*this < x); }
 
 		void set_node(map_pointer new_node) {
 			node = new_node;
@@ -118,23 +129,28 @@ namespace CCSTL{
 		}
 	};
 
-	template <class T, class Alloc = std::allocator<T>, size_t BufSiz = 0>
+	// Instrument见Instrument.h, 默认的null_instrument没有任何开销
+	template <class T, class Alloc = allocator<T>, size_t BufSiz = 0, class Instrument = null_instrument>
 	class deque {
 	public:
 		typedef T value_type;
 		typedef value_type* pointer;
 		typedef const value_type* const_pointer;
 		typedef value_type& reference;
-		typedef const value_type& cost_reference;
+		typedef const value_type& const_reference;
 		typedef size_t size_type;
 		typedef ptrdiff_t difference_type;
 
 	public:
-		typedef deque_iterator<T> iterator;
-		typedef deque_iterator<const T> const_iterator;
+		typedef deque_iterator<T, BufSiz> iterator;
+		typedef deque_iterator<const T, BufSiz> const_iterator;
 	protected:
 		typedef pointer* map_pointer;
 
+		// 元素缓冲区和map都从alloc取得
+		typedef Alloc data_allocator;
+		typedef allocator<pointer> map_allocator;
+
 		static size_type buffer_size() {
 			return __deque_buf_size(BufSiz, sizeof(value_type));
 		}
@@ -147,13 +163,69 @@ namespace CCSTL{
 		map_pointer map;
 		size_type map_size;
 	public:
+		deque(): start(), finish(), map(0), map_size(0) {
+			create_map_and_nodes(0);
+		}
+		deque(size_type n, const T& value): start(), finish(), map(0), map_size(0) {
+			fill_initialize(n, value);
+		}
+		deque(int n, const T& value): start(), finish(), map(0), map_size(0) {
+			fill_initialize(n, value);
+		}
+		deque(long n, const T& value): start(), finish(), map(0), map_size(0) {
+			fill_initialize(n, value);
+		}
+		explicit deque(size_type n): start(), finish(), map(0), map_size(0) {
+			fill_initialize(n, T());
+		}
+		deque(std::initializer_list<T> li): start(), finish(), map(0), map_size(0) {
+			create_map_and_nodes(0);
+			for(const T* p = li.begin(); p != li.end(); ++p)
+				push_back(*p);
+		}
+		deque(const deque& x): start(), finish(), map(0), map_size(0) {
+			create_map_and_nodes(0);
+			for(const_iterator it = x.begin(); it != x.end(); ++it)
+				push_back(*it);
+			Instrument::on_copy(x.size());
+		}
+		// 被移走的x换到一个新建的空map上, 之后仍然可以正常使用
+		deque(deque&& x): start(), finish(), map(0), map_size(0) {
+			create_map_and_nodes(0);
+			swap(x);
+			Instrument::on_move(size());
+		}
+		deque& operator=(const deque& x) {
+			if(this != &x) {
+				clear();
+				for(const_iterator it = x.begin(); it != x.end(); ++it)
+					push_back(*it);
+				Instrument::on_copy(x.size());
+			}
+			return *this;
+		}
+		// 原有的元素清掉, 剩下的空缓冲区随swap交给x
+		deque& operator=(deque&& x) {
+			if(this != &x) {
+				clear();
+				swap(x);
+				Instrument::on_move(size());
+			}
+			return *this;
+		}
+		~deque() {
+			destroy(start, finish);
+			destroy_nodes(start.node, finish.node + 1);
+			deallocate_map(map, map_size);
+		}
+
 		iterator begin() { return start; }
 		iterator end() { return finish; }
 		const_iterator begin() const { return start; }
 		const_iterator end() const { return finish; }
 
 		reference operator[](size_type n) { return start[difference_type(n)]; }
-		const_reference operator[](size_type n) { return start[difference_type(n)]; }
+		const_reference operator[](size_type n) const { return start[difference_type(n)]; }
 
 		reference front() { return *start; }
 		reference back() {
@@ -172,7 +244,342 @@ namespace CCSTL{
 		size_type size() const { return finish - start; }
 		size_type max_size() const { return size_type(-1); }
 		bool empty() const { return finish == start; }
+
+		void push_back(const T& x) {
+			if(finish.cur != finish.last - 1) {
+				data_allocator::construct(finish.cur, x);
+				++finish.cur;
+			} else
+				push_back_aux(x);
+			Instrument::on_size(size());
+		}
+
+		void push_front(const T& x) {
+			if(start.cur != start.first) {
+				data_allocator::construct(start.cur - 1, x);
+				--start.cur;
+			} else
+				push_front_aux(x);
+			Instrument::on_size(size());
+		}
+
+		// 缓冲区还有位置时直接构造; 否则配置新缓冲区后在其中直接构造, 不经过临时对象
+		template <class... Args>
+		void emplace_back(Args&&... args) {
+			if(finish.cur != finish.last - 1) {
+				new(static_cast<void*>(finish.cur)) T(std::forward<Args>(args)...);
+				++finish.cur;
+			} else
+				emplace_back_aux(std::forward<Args>(args)...);
+			Instrument::on_size(size());
+		}
+
+		template <class... Args>
+		void emplace_front(Args&&... args) {
+			if(start.cur != start.first) {
+				new(static_cast<void*>(start.cur - 1)) T(std::forward<Args>(args)...);
+				--start.cur;
+			} else
+				emplace_front_aux(std::forward<Args>(args)...);
+			Instrument::on_size(size());
+		}
+
+		void pop_back() {
+			if(finish.cur != finish.first) {
+				--finish.cur;
+				data_allocator::destroy(finish.cur);
+			} else
+				pop_back_aux();
+		}
+
+		void pop_front() {
+			if(start.cur != start.last - 1) {
+				data_allocator::destroy(start.cur);
+				++start.cur;
+			} else
+				pop_front_aux();
+		}
+
+		// 只保留一个缓冲区, 与SGI的做法相同
+		void clear();
+
+		void swap(deque& x) {
+			std::swap(start, x.start);
+			std::swap(finish, x.finish);
+			std::swap(map, x.map);
+			std::swap(map_size, x.map_size);
+		}
+
+		// 按缓冲区依次对每一段连续存放的元素调用f(指针, 个数), 空段跳过.
+		// 整段复制或写出时用它代替逐个元素的迭代器(见Serialize.h)
+		template <class F>
+		void for_each_segment(F f) {
+			for(map_pointer node = start.node; node <= finish.node; ++node) {
+				pointer first = node == start.node ? start.cur : *node;
+				pointer last = node == finish.node ? finish.cur : *node + buffer_size();
+				if(first != last)
+					f(first, size_type(last - first));
+			}
+		}
+		template <class F>
+		void for_each_segment(F f) const {
+			for(map_pointer node = start.node; node <= finish.node; ++node) {
+				const_pointer first = node == start.node ? start.cur : *node;
+				const_pointer last = node == finish.node ? finish.cur : *node + buffer_size();
+				if(first != last)
+					f(first, size_type(last - first));
+			}
+		}
+
+	private:
+		pointer allocate_node() {
+			Instrument::on_allocate(buffer_size() * sizeof(T));
+			return data_allocator::allocate(buffer_size());
+		}
+		void deallocate_node(pointer p) {
+			Instrument::on_deallocate(buffer_size() * sizeof(T));
+			data_allocator::deallocate(p, buffer_size());
+		}
+
+		map_pointer allocate_map(size_type n) {
+			Instrument::on_allocate(n * sizeof(pointer));
+			return map_allocator::allocate(n);
+		}
+		void deallocate_map(map_pointer p, size_type n) {
+			Instrument::on_deallocate(n * sizeof(pointer));
+			map_allocator::deallocate(p, n);
+		}
+
+		void destroy(iterator first, iterator last) {
+			for(; first != last; ++first)
+				data_allocator::destroy(first.cur);
+		}
+
+		void destroy_nodes(map_pointer nstart, map_pointer nfinish) {
+			for(map_pointer cur = nstart; cur < nfinish; ++cur)
+				deallocate_node(*cur);
+		}
+
+		void create_map_and_nodes(size_type num_elements);
+		void fill_initialize(size_type n, const T& value);
+		void push_back_aux(const T& x);
+		void push_front_aux(const T& x);
+		template <class... Args>
+		void emplace_back_aux(Args&&... args);
+		template <class... Args>
+		void emplace_front_aux(Args&&... args);
+		void pop_back_aux();
+		void pop_front_aux();
+
+		void reserve_map_at_back(size_type nodes_to_add = 1) {
+			if(nodes_to_add + 1 > map_size - (finish.node - map))
+				reallocate_map(nodes_to_add, false);
+		}
+
+		void reserve_map_at_front(size_type nodes_to_add = 1) {
+			if(nodes_to_add > size_type(start.node - map))
+				reallocate_map(nodes_to_add, true);
+		}
+
+		void reallocate_map(size_type nodes_to_add, bool add_at_front);
 	};
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::create_map_and_nodes(size_type num_elements) {
+		// 需要的节点数 = (元素个数 / 每个缓冲区可容纳的元素个数) + 1
+		// 如果刚好整除, 会多配一个节点
+		size_type num_nodes = num_elements / buffer_size() + 1;
+
+		// 一个map要管理几个节点, 最少8个, 最多是"所需节点数加2"
+		// 前后各预留一个, 扩充时可用
+		map_size = std::max(initial_map_size(), num_nodes + 2);
+		map = allocate_map(map_size);
+
+		// 令nstart和nfinish指向map所拥有的全部节点的最中央区段
+		// 保持在最中央, 可使头尾两端的扩充能量一样大
+		map_pointer nstart = map + (map_size - num_nodes) / 2;
+		map_pointer nfinish = nstart + num_nodes - 1;
+
+		map_pointer cur;
+		try {
+			for(cur = nstart; cur <= nfinish; ++cur)
+				*cur = allocate_node();
+		} catch(...) {
+			destroy_nodes(nstart, cur);
+			deallocate_map(map, map_size);
+			map = 0;
+			throw;
+		}
+
+		start.set_node(nstart);
+		finish.set_node(nfinish);
+		start.cur = start.first;
+		finish.cur = finish.first + num_elements % buffer_size();
+	}
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::fill_initialize(size_type n, const T& value) {
+		create_map_and_nodes(n);
+		map_pointer cur;
+		try {
+			// 为每个节点的缓冲区设定初值
+			for(cur = start.node; cur < finish.node; ++cur)
+				std::uninitialized_fill(*cur, *cur + buffer_size(), value);
+			// 最后一个节点的设定稍有不同, 因为尾端可能有备用空间, 不必设初值
+			std::uninitialized_fill(finish.first, finish.cur, value);
+			Instrument::on_size(n);
+		} catch(...) {
+			for(map_pointer p = start.node; p < cur; ++p)
+				for(pointer q = *p; q != *p + buffer_size(); ++q)
+					data_allocator::destroy(q);
+			destroy_nodes(start.node, finish.node + 1);
+			deallocate_map(map, map_size);
+			map = 0;
+			throw;
+		}
+	}
+
+	// 只有当finish.cur == finish.last - 1时才会被调用
+	// 也就是说, 只有当最后一个缓冲区只剩一个备用元素空间时才会被调用
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::push_back_aux(const T& x) {
+		T x_copy = x;
+		reserve_map_at_back();
+		*(finish.node + 1) = allocate_node();
+		try {
+			data_allocator::construct(finish.cur, x_copy);
+		} catch(...) {
+			deallocate_node(*(finish.node + 1));
+			throw;
+		}
+		finish.set_node(finish.node + 1);
+		finish.cur = finish.first;
+	}
+
+	// 只有当start.cur == start.first时才会被调用
+	// 也就是说, 只有当第一个缓冲区没有任何备用元素时才会被调用
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::push_front_aux(const T& x) {
+		T x_copy = x;
+		reserve_map_at_front();
+		*(start.node - 1) = allocate_node();
+		try {
+			start.set_node(start.node - 1);
+			start.cur = start.last - 1;
+			data_allocator::construct(start.cur, x_copy);
+		} catch(...) {
+			start.set_node(start.node + 1);
+			start.cur = start.first;
+			deallocate_node(*(start.node - 1));
+			throw;
+		}
+	}
+
+	// 与push_back_aux相同, 但直接在finish.cur上构造;
+	// 配置缓冲区不会移动已有元素, 所以args引用容器内的元素也是安全的
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	template <class... Args>
+	void deque<T, Alloc, BufSiz, Instrument>::emplace_back_aux(Args&&... args) {
+		reserve_map_at_back();
+		*(finish.node + 1) = allocate_node();
+		try {
+			new(static_cast<void*>(finish.cur)) T(std::forward<Args>(args)...);
+		} catch(...) {
+			deallocate_node(*(finish.node + 1));
+			throw;
+		}
+		finish.set_node(finish.node + 1);
+		finish.cur = finish.first;
+	}
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	template <class... Args>
+	void deque<T, Alloc, BufSiz, Instrument>::emplace_front_aux(Args&&... args) {
+		reserve_map_at_front();
+		*(start.node - 1) = allocate_node();
+		try {
+			start.set_node(start.node - 1);
+			start.cur = start.last - 1;
+			new(static_cast<void*>(start.cur)) T(std::forward<Args>(args)...);
+		} catch(...) {
+			start.set_node(start.node + 1);
+			start.cur = start.first;
+			deallocate_node(*(start.node - 1));
+			throw;
+		}
+	}
+
+	// 只有当finish.cur == finish.first时才会被调用
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::pop_back_aux() {
+		deallocate_node(finish.first);
+		finish.set_node(finish.node - 1);
+		finish.cur = finish.last - 1;
+		data_allocator::destroy(finish.cur);
+	}
+
+	// 只有当start.cur == start.last - 1时才会被调用
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::pop_front_aux() {
+		data_allocator::destroy(start.cur);
+		deallocate_node(start.first);
+		start.set_node(start.node + 1);
+		start.cur = start.first;
+	}
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::clear() {
+		// 针对头尾以外的每一个缓冲区, 它们一定都是饱满的
+		for(map_pointer node = start.node + 1; node < finish.node; ++node) {
+			for(pointer p = *node; p != *node + buffer_size(); ++p)
+				data_allocator::destroy(p);
+			deallocate_node(*node);
+		}
+
+		if(start.node != finish.node) {
+			// 至少有头尾两个缓冲区, 头缓冲区保留, 尾缓冲区释放
+			for(pointer p = start.cur; p != start.last; ++p)
+				data_allocator::destroy(p);
+			for(pointer p = finish.first; p != finish.cur; ++p)
+				data_allocator::destroy(p);
+			deallocate_node(finish.first);
+		} else
+			destroy(start, finish);
+
+		finish = start;
+	}
+
+	template <class T, class Alloc, size_t BufSiz, class Instrument>
+	void deque<T, Alloc, BufSiz, Instrument>::reallocate_map(size_type nodes_to_add, bool add_at_front) {
+		size_type old_num_nodes = finish.node - start.node + 1;
+		size_type new_num_nodes = old_num_nodes + nodes_to_add;
+		// 两种情况都要把节点指针整体搬一次
+		Instrument::on_reallocate(old_num_nodes * sizeof(pointer));
+
+		map_pointer new_nstart;
+		if(map_size > 2 * new_num_nodes) {
+			// map的空间足够, 只是偏向了一端, 把节点挪回中央
+			new_nstart = map + (map_size - new_num_nodes) / 2
+						 + (add_at_front ? nodes_to_add : 0);
+			if(new_nstart < start.node)
+				std::copy(start.node, finish.node + 1, new_nstart);
+			else
+				std::copy_backward(start.node, finish.node + 1, new_nstart + old_num_nodes);
+		} else {
+			// 配置一块新空间给新map
+			size_type new_map_size = map_size + std::max(map_size, nodes_to_add) + 2;
+			map_pointer new_map = allocate_map(new_map_size);
+			new_nstart = new_map + (new_map_size - new_num_nodes) / 2
+						 + (add_at_front ? nodes_to_add : 0);
+			std::copy(start.node, finish.node + 1, new_nstart);
+			deallocate_map(map, map_size);
+			map = new_map;
+			map_size = new_map_size;
+		}
+
+		start.set_node(new_nstart);
+		finish.set_node(new_nstart + old_num_nodes - 1);
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,315 @@
+#ifndef DYNAMIC_BITSET_H
+#define DYNAMIC_BITSET_H
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include "Allocator.h"
+#include "Simd.h"
+
+namespace CCSTL{
+    // 按位存放的布尔序列, 每64位一个字, 存储空间经由Alloc从内存池取得
+    // 相当于std::vector<bool>, 但可以按字直接操作:
+    //   push_back/resize 每次处理一整个字, 不逐位循环
+    //   count            popcount, find_first/find_next 用tzcnt, 跳过全0的字时按向量扫描,
+    //                    要遍历全部的1时用for_each_set
+    //   &= |= ^= -=      整段交给Simd.cpp的按字内核(AVX2/SSE2/标量)
+    // 最后一个字中超出size的位总是0, count、查找和比较都依赖这一点.
+    // 两个位图做位运算时size必须相同, 与operator[]一样不做检查
+    template <class Alloc = allocator<uint64_t>>
+    class dynamic_bitset {
+    public:
+        typedef uint64_t word_type;
+        typedef size_t size_type;
+        typedef bool value_type;
+        typedef bool const_reference;
+
+        static const size_type bits_per_word = 64;
+        static const size_type npos = size_type(-1);
+
+        // 对单个位的代理引用
+        class reference {
+            friend class dynamic_bitset;
+            word_type* word;
+            word_type mask;
+            reference(word_type* w, size_type bit): word(w), mask(word_type(1) << bit) {}
+        public:
+            operator bool() const { return (*word & mask) != 0; }
+            bool operator~() const { return (*word & mask) == 0; }
+            reference& operator=(bool x) {
+                if(x)
+                    *word |= mask;
+                else
+                    *word &= ~mask;
+                return *this;
+            }
+            reference& operator=(const reference& x) { return *this = bool(x); }
+            reference& operator|=(bool x) { if(x) *word |= mask; return *this; }
+            reference& operator&=(bool x) { if(!x) *word &= ~mask; return *this; }
+            reference& operator^=(bool x) { if(x) *word ^= mask; return *this; }
+            reference& flip() { *word ^= mask; return *this; }
+        };
+
+    private:
+        typedef Alloc data_allocator;
+
+        word_type* words;
+        size_type nbits;
+        size_type cap_words;
+
+        static size_type words_for(size_type bits) { return (bits + bits_per_word - 1) / bits_per_word; }
+        static size_type word_index(size_type pos) { return pos / bits_per_word; }
+        static size_type bit_index(size_type pos) { return pos % bits_per_word; }
+
+        // 把最后一个字中超出size的位清零
+        void clear_tail() {
+            if(bit_index(nbits))
+                words[word_index(nbits)] &= (word_type(1) << bit_index(nbits)) - 1;
+        }
+
+        void reallocate(size_type new_cap_words) {
+            word_type* w = data_allocator::allocate(new_cap_words);
+            if(words) {
+                memcpy(w, words, num_words() * sizeof(word_type));
+                data_allocator::deallocate(words, cap_words);
+            }
+            words = w;
+            cap_words = new_cap_words;
+        }
+
+        size_type find_from_word(size_type w) const {
+            size_type n = num_words();
+            if(w >= n)
+                return npos;
+            // 位图较密时下一个字往往就不为0, 不必进入向量扫描
+            if(words[w])
+                return w * bits_per_word + size_type(__builtin_ctzll(words[w]));
+            size_type i = w + 1 + simd::find_nonzero_word(words + w + 1, n - w - 1);
+            if(i == n)
+                return npos;
+            return i * bits_per_word + size_type(__builtin_ctzll(words[i]));
+        }
+
+    public:
+        dynamic_bitset(): words(0), nbits(0), cap_words(0) {}
+        explicit dynamic_bitset(size_type n, bool value = false): words(0), nbits(0), cap_words(0) {
+            resize(n, value);
+        }
+        dynamic_bitset(const dynamic_bitset& x): words(0), nbits(x.nbits), cap_words(0) {
+            if(x.num_words()) {
+                words = data_allocator::allocate(x.num_words());
+                cap_words = x.num_words();
+                memcpy(words, x.words, x.num_words() * sizeof(word_type));
+            }
+        }
+        dynamic_bitset(dynamic_bitset&& x): words(x.words), nbits(x.nbits), cap_words(x.cap_words) {
+            x.words = 0;
+            x.nbits = x.cap_words = 0;
+        }
+        dynamic_bitset& operator=(const dynamic_bitset& x) {
+            if(this != &x) {
+                dynamic_bitset tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        dynamic_bitset& operator=(dynamic_bitset&& x) {
+            swap(x);
+            return *this;
+        }
+        ~dynamic_bitset() {
+            if(words)
+                data_allocator::deallocate(words, cap_words);
+        }
+
+        // 容量
+        size_type size() const { return nbits; }
+        bool empty() const { return nbits == 0; }
+        size_type capacity() const { return cap_words * bits_per_word; }
+        size_type num_words() const { return words_for(nbits); }
+        word_type* data() { return words; }
+        const word_type* data() const { return words; }
+
+        void reserve(size_type bits) {
+            if(words_for(bits) > cap_words)
+                reallocate(words_for(bits));
+        }
+
+        // 访问元素
+        reference operator[](size_type pos) { return reference(words + word_index(pos), bit_index(pos)); }
+        const_reference operator[](size_type pos) const { return test(pos); }
+        bool test(size_type pos) const { return (words[word_index(pos)] >> bit_index(pos)) & 1; }
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return test(0); }
+        reference back() { return (*this)[nbits - 1]; }
+        const_reference back() const { return test(nbits - 1); }
+
+        // 修改单个位
+        dynamic_bitset& set(size_type pos, bool value = true) {
+            (*this)[pos] = value;
+            return *this;
+        }
+        dynamic_bitset& reset(size_type pos) {
+            words[word_index(pos)] &= ~(word_type(1) << bit_index(pos));
+            return *this;
+        }
+        dynamic_bitset& flip(size_type pos) {
+            words[word_index(pos)] ^= word_type(1) << bit_index(pos);
+            return *this;
+        }
+
+        // 修改全部的位
+        dynamic_bitset& set() {
+            std::fill_n(words, num_words(), ~word_type(0));
+            clear_tail();
+            return *this;
+        }
+        dynamic_bitset& reset() {
+            std::fill_n(words, num_words(), word_type(0));
+            return *this;
+        }
+        dynamic_bitset& flip() {
+            for(size_type i = 0; i < num_words(); ++i)
+                words[i] = ~words[i];
+            clear_tail();
+            return *this;
+        }
+
+        // 进入新的字时整字写入, 否则只置一位
+        void push_back(bool x) {
+            if(bit_index(nbits) == 0) {
+                if(num_words() == cap_words)
+                    reallocate(cap_words ? 2 * cap_words : 1);
+                words[word_index(nbits)] = word_type(x);
+            } else if(x)
+                words[word_index(nbits)] |= word_type(1) << bit_index(nbits);
+            ++nbits;
+        }
+
+        void pop_back() {
+            --nbits;
+            clear_tail();
+        }
+
+        // 新增的位先补满当前的字, 其余整字填充
+        void resize(size_type n, bool value = false) {
+            if(n > nbits) {
+                if(words_for(n) > cap_words)
+                    reallocate(std::max(words_for(n), 2 * cap_words));
+                size_type old_words = num_words();
+                if(value && bit_index(nbits))
+                    words[old_words - 1] |= ~word_type(0) << bit_index(nbits);
+                memset(words + old_words, value ? 0xFF : 0, (words_for(n) - old_words) * sizeof(word_type));
+            }
+            nbits = n;
+            clear_tail();
+        }
+
+        void clear() { nbits = 0; }
+
+        void swap(dynamic_bitset& x) {
+            std::swap(words, x.words);
+            std::swap(nbits, x.nbits);
+            std::swap(cap_words, x.cap_words);
+        }
+
+        // 统计与查找
+        size_type count() const { return simd::popcount_words(words, num_words()); }
+        bool any() const { return find_first() != npos; }
+        bool none() const { return !any(); }
+        bool all() const { return count() == nbits; }
+
+        // 第一个为1的位, 没有时返回npos
+        size_type find_first() const { return find_from_word(0); }
+
+        // pos之后第一个为1的位, 没有时返回npos
+        size_type find_next(size_type pos) const {
+            if(pos == npos || ++pos >= nbits)
+                return npos;
+            word_type w = words[word_index(pos)] & (~word_type(0) << bit_index(pos));
+            if(w)
+                return word_index(pos) * bits_per_word + size_type(__builtin_ctzll(w));
+            return find_from_word(word_index(pos) + 1);
+        }
+
+        // 按从小到大的顺序对每个为1的位调用f(pos). 逐字取出最低位的1再清掉,
+        // 不像find_next那样每次重新定位, 位图较密时快得多
+        template <class F>
+        void for_each_set(F f) const {
+            size_type n = num_words();
+            for(size_type i = 0; i < n; ++i) {
+                word_type w = words[i];
+                while(w) {
+                    f(i * bits_per_word + size_type(__builtin_ctzll(w)));
+                    w &= w - 1;
+                }
+            }
+        }
+
+        // 整段按字运算
+        dynamic_bitset& operator&=(const dynamic_bitset& x) {
+            simd::and_words(words, x.words, num_words());
+            return *this;
+        }
+        dynamic_bitset& operator|=(const dynamic_bitset& x) {
+            simd::or_words(words, x.words, num_words());
+            return *this;
+        }
+        dynamic_bitset& operator^=(const dynamic_bitset& x) {
+            simd::xor_words(words, x.words, num_words());
+            return *this;
+        }
+        // 差集: 保留在*this中而不在x中的位
+        dynamic_bitset& operator-=(const dynamic_bitset& x) {
+            simd::andnot_words(words, x.words, num_words());
+            return *this;
+        }
+        dynamic_bitset operator~() const {
+            dynamic_bitset r(*this);
+            r.flip();
+            return r;
+        }
+
+        bool operator==(const dynamic_bitset& x) const {
+            return nbits == x.nbits &&
+                   simd::mismatch_bytes(words, x.words, num_words() * sizeof(word_type)) ==
+                       num_words() * sizeof(word_type);
+        }
+        bool operator!=(const dynamic_bitset& x) const { return !(*this == x); }
+    };
+
+    template <class Alloc>
+    const typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::bits_per_word;
+    template <class Alloc>
+    const typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::npos;
+
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator&(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        r &= b;
+        return r;
+    }
+
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator|(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        r |= b;
+        return r;
+    }
+
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator^(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        r ^= b;
+        return r;
+    }
+
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator-(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        r -= b;
+        return r;
+    }
+}
+
+#endif
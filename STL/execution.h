@@ -0,0 +1,328 @@
+#ifndef EXECUTION_H
+#define EXECUTION_H
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <functional>
+#include "Trait.h"
+#include "deque.h"
+#include "ThreadPool.h"
+
+// 并行算法: 把随机访问区间按grain切成若干块, 每块作为一个任务交给工作窃取线程池
+//
+// 分块只由区间长度和grain决定, 与线程数、调度顺序无关; reduce与inclusive_scan
+// 按块的顺序合并结果, 所以只要运算满足结合律, 结果就是确定的(浮点数也一样,
+// 只是可能与顺序版本的结果不同)
+namespace CCSTL {
+namespace execution {
+    class parallel_policy {
+    public:
+        // 默认每块的元素个数; 它不能依赖线程数, 否则结果不确定
+        static const size_t default_grain = 16384;
+
+        explicit parallel_policy(thread_pool& p, size_t g = default_grain)
+            : pool_(&p), grain_(g ? g : 1) {}
+
+        thread_pool& pool() const { return *pool_; }
+        size_t grain() const { return grain_; }
+
+        parallel_policy with_grain(size_t g) const { return parallel_policy(*pool_, g); }
+
+    private:
+        thread_pool* pool_;
+        size_t grain_;
+    };
+
+    inline parallel_policy par() { return parallel_policy(thread_pool::instance()); }
+    inline parallel_policy par(thread_pool& pool, size_t grain = parallel_policy::default_grain) {
+        return parallel_policy(pool, grain);
+    }
+}
+
+    // ---------------------------------------------------------------
+    // 分块
+    // ---------------------------------------------------------------
+    // 普通随机访问迭代器没有分段, deque的迭代器按缓冲区分段:
+    // 块的边界对齐到缓冲区边界, 这样每个任务只访问完整的几个缓冲区
+    template <class RandomAccessIterator>
+    inline size_t __segment_size(const RandomAccessIterator&) { return 0; }
+    template <class RandomAccessIterator>
+    inline size_t __segment_offset(const RandomAccessIterator&) { return 0; }
+
+    template <class T, size_t BufSiz>
+    inline size_t __segment_size(const deque_iterator<T, BufSiz>& it) { return it.buffer_size(); }
+    template <class T, size_t BufSiz>
+    inline size_t __segment_offset(const deque_iterator<T, BufSiz>& it) { return it.cur - it.first; }
+
+    // 第k块为[begin(k), end(k))
+    class __chunking {
+    public:
+        template <class RandomAccessIterator>
+        __chunking(const RandomAccessIterator& first, size_t n, size_t grain): n(n) {
+            size_t seg = __segment_size(first);
+            if(seg) {
+                grain = (grain + seg - 1) / seg * seg;
+                offset = __segment_offset(first);
+            } else
+                offset = 0;
+            this->grain = grain;
+            count = n == 0 ? 0 : (n + offset + grain - 1) / grain;
+        }
+
+        size_t size() const { return count; }
+        size_t begin(size_t k) const {
+            if(k == 0)
+                return 0;
+            size_t b = k * grain - offset;
+            return b < n ? b : n;
+        }
+        size_t end(size_t k) const { return begin(k + 1); }
+
+    private:
+        size_t n;
+        size_t grain;
+        size_t offset;
+        size_t count;
+    };
+
+    // 对每一块调用f(k, begin, end), 块数为1时直接在当前线程执行
+    template <class F>
+    void __parallel_chunks(const execution::parallel_policy& policy, const __chunking& chunks, F f) {
+        size_t count = chunks.size();
+        if(count <= 1 || policy.pool().concurrency() == 1) {
+            for(size_t k = 0; k < count; ++k)
+                f(k, chunks.begin(k), chunks.end(k));
+            return;
+        }
+        task_group group(policy.pool());
+        for(size_t k = 1; k < count; ++k) {
+            size_t b = chunks.begin(k), e = chunks.end(k);
+            group.run([=, &f]() { f(k, b, e); });
+        }
+        // 第一块留给自己
+        f(0, chunks.begin(0), chunks.end(0));
+        group.wait();
+    }
+
+    // 并行算法可能在工作线程中嵌套调用, 而alloc的内存池不是线程安全的,
+    // 所以临时空间直接向operator new申请
+    template <class T>
+    inline T* __parallel_buffer(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    // 每块一个槽位的临时数组, 用来存放每块的部分结果
+    template <class T>
+    class __chunk_results {
+    public:
+        explicit __chunk_results(size_t n): n(n), p(__parallel_buffer<T>(n)), built(0) {}
+        ~__chunk_results() {
+            for(size_t i = 0; i < built; ++i)
+                p[i].~T();
+            ::operator delete(p);
+        }
+        // 所有槽位初始化为x, 之后才能用下标访问
+        void fill(const T& x) {
+            for(; built < n; ++built)
+                new(p + built) T(x);
+        }
+        T& operator[](size_t i) { return p[i]; }
+
+    private:
+        __chunk_results(const __chunk_results&);
+        size_t n;
+        T* p;
+        size_t built;
+    };
+
+    // ---------------------------------------------------------------
+    // for_each / transform / copy
+    // ---------------------------------------------------------------
+    template <class RandomAccessIterator, class Function>
+    void for_each(const execution::parallel_policy& policy,
+                  RandomAccessIterator first, RandomAccessIterator last, Function f) {
+        __chunking chunks(first, last - first, policy.grain());
+        __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+            RandomAccessIterator it = first + b;
+            for(size_t i = b; i != e; ++i, ++it)
+                f(*it);
+        });
+    }
+
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class UnaryOperation>
+    RandomAccessIterator2 transform(const execution::parallel_policy& policy,
+                                    RandomAccessIterator1 first, RandomAccessIterator1 last,
+                                    RandomAccessIterator2 result, UnaryOperation op) {
+        size_t n = last - first;
+        __chunking chunks(first, n, policy.grain());
+        __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+            std::transform(first + b, first + e, result + b, op);
+        });
+        return result + n;
+    }
+
+    template <class RandomAccessIterator1, class RandomAccessIterator2,
+              class RandomAccessIterator3, class BinaryOperation>
+    RandomAccessIterator3 transform(const execution::parallel_policy& policy,
+                                    RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+                                    RandomAccessIterator2 first2, RandomAccessIterator3 result,
+                                    BinaryOperation op) {
+        size_t n = last1 - first1;
+        __chunking chunks(first1, n, policy.grain());
+        __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+            std::transform(first1 + b, first1 + e, first2 + b, result + b, op);
+        });
+        return result + n;
+    }
+
+    template <class RandomAccessIterator1, class RandomAccessIterator2>
+    RandomAccessIterator2 copy(const execution::parallel_policy& policy,
+                               RandomAccessIterator1 first, RandomAccessIterator1 last,
+                               RandomAccessIterator2 result) {
+        size_t n = last - first;
+        __chunking chunks(first, n, policy.grain());
+        __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+            std::copy(first + b, first + e, result + b);
+        });
+        return result + n;
+    }
+
+    // ---------------------------------------------------------------
+    // reduce
+    // ---------------------------------------------------------------
+    // 每块从第一个元素开始顺序折叠, 再按块的顺序把init和各块的结果折叠起来,
+    // 所以只要求op满足结合律, 不要求交换律
+    template <class RandomAccessIterator, class T, class BinaryOperation>
+    T reduce(const execution::parallel_policy& policy,
+             RandomAccessIterator first, RandomAccessIterator last, T init, BinaryOperation op) {
+        __chunking chunks(first, last - first, policy.grain());
+        __chunk_results<T> partial(chunks.size());
+        partial.fill(init);
+        __parallel_chunks(policy, chunks, [&](size_t k, size_t b, size_t e) {
+            RandomAccessIterator it = first + b;
+            T acc = *it;
+            for(++it, ++b; b != e; ++b, ++it)
+                acc = op(acc, *it);
+            partial[k] = acc;
+        });
+        for(size_t k = 0; k < chunks.size(); ++k)
+            init = op(init, partial[k]);
+        return init;
+    }
+
+    template <class RandomAccessIterator, class T>
+    inline T reduce(const execution::parallel_policy& policy,
+                    RandomAccessIterator first, RandomAccessIterator last, T init) {
+        return CCSTL::reduce(policy, first, last, init, std::plus<T>());
+    }
+
+    template <class RandomAccessIterator>
+    inline typename iterator_traits<RandomAccessIterator>::value_type
+    reduce(const execution::parallel_policy& policy,
+           RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+        return CCSTL::reduce(policy, first, last, value_type());
+    }
+
+    // ---------------------------------------------------------------
+    // inclusive_scan
+    // ---------------------------------------------------------------
+    // 三趟: 并行求每块的和 -> 顺序求各块的前缀 -> 并行地在每块内部做扫描
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class BinaryOperation>
+    RandomAccessIterator2 inclusive_scan(const execution::parallel_policy& policy,
+                                         RandomAccessIterator1 first, RandomAccessIterator1 last,
+                                         RandomAccessIterator2 result, BinaryOperation op) {
+        typedef typename iterator_traits<RandomAccessIterator1>::value_type value_type;
+        size_t n = last - first;
+        if(n == 0)
+            return result;
+        __chunking chunks(first, n, policy.grain());
+        __chunk_results<value_type> sums(chunks.size());
+        sums.fill(*first);
+        __parallel_chunks(policy, chunks, [&](size_t k, size_t b, size_t e) {
+            RandomAccessIterator1 it = first + b;
+            value_type acc = *it;
+            for(++it, ++b; b != e; ++b, ++it)
+                acc = op(acc, *it);
+            sums[k] = acc;
+        });
+        // sums[k]变为第0..k块所有元素的和, 第k块的扫描从sums[k-1]开始
+        for(size_t k = 1; k < chunks.size(); ++k)
+            sums[k] = op(sums[k - 1], sums[k]);
+        __parallel_chunks(policy, chunks, [&](size_t k, size_t b, size_t e) {
+            RandomAccessIterator1 it = first + b;
+            RandomAccessIterator2 out = result + b;
+            value_type acc = k == 0 ? *it : op(sums[k - 1], *it);
+            *out = acc;
+            for(++it, ++out, ++b; b != e; ++b, ++it, ++out) {
+                acc = op(acc, *it);
+                *out = acc;
+            }
+        });
+        return result + n;
+    }
+
+    template <class RandomAccessIterator1, class RandomAccessIterator2>
+    inline RandomAccessIterator2 inclusive_scan(const execution::parallel_policy& policy,
+                                                RandomAccessIterator1 first, RandomAccessIterator1 last,
+                                                RandomAccessIterator2 result) {
+        typedef typename iterator_traits<RandomAccessIterator1>::value_type value_type;
+        return CCSTL::inclusive_scan(policy, first, last, result, std::plus<value_type>());
+    }
+
+    // ---------------------------------------------------------------
+    // sort
+    // ---------------------------------------------------------------
+    // 每块各自std::sort, 然后两两归并, 每一轮的归并互相独立, 可以并行;
+    // 归并在区间和一块同样大小的缓冲区之间来回进行
+    template <class RandomAccessIterator, class Compare>
+    void sort(const execution::parallel_policy& policy,
+              RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+        size_t n = last - first;
+        __chunking chunks(first, n, policy.grain());
+        size_t count = chunks.size();
+        __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+            std::sort(first + b, first + e, comp);
+        });
+        if(count <= 1)
+            return;
+
+        value_type* buf = __parallel_buffer<value_type>(n);
+        __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+            std::uninitialized_copy(first + b, first + e, buf + b);
+        });
+
+        bool in_buf = false;    // 当前的有序数据在buf中还是在原区间中
+        for(size_t width = 1; width < count; width *= 2) {
+            size_t pairs = (count + 2 * width - 1) / (2 * width);
+            __chunking merges(buf, pairs, 1);
+            __parallel_chunks(policy, merges, [&](size_t p, size_t, size_t) {
+                size_t lo = chunks.begin(2 * width * p);
+                size_t mid = chunks.begin(std::min(count, 2 * width * p + width));
+                size_t hi = chunks.begin(std::min(count, 2 * width * (p + 1)));
+                if(in_buf)
+                    std::merge(buf + lo, buf + mid, buf + mid, buf + hi, first + lo, comp);
+                else
+                    std::merge(first + lo, first + mid, first + mid, first + hi, buf + lo, comp);
+            });
+            in_buf = !in_buf;
+        }
+        if(in_buf) {
+            __parallel_chunks(policy, chunks, [&](size_t, size_t b, size_t e) {
+                std::copy(buf + b, buf + e, first + b);
+            });
+        }
+        for(size_t i = 0; i < n; ++i)
+            buf[i].~value_type();
+        ::operator delete(buf);
+    }
+
+    template <class RandomAccessIterator>
+    inline void sort(const execution::parallel_policy& policy,
+                     RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+        CCSTL::sort(policy, first, last, std::less<value_type>());
+    }
+}
+#endif
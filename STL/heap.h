@@ -0,0 +1,173 @@
+#ifndef HEAP_H
+#define HEAP_H
+#include <functional>
+#include <utility>
+#include "Trait.h"
+
+// 堆算法
+// push_heap / pop_heap / make_heap / sort_heap 与标准库一样是二叉大顶堆;
+// dary_xxx_heap<D> 是D叉堆的版本, 节点i的孩子为D*i+1 .. D*i+D, 父节点为(i-1)/D.
+// D取4或8时一个节点的孩子大多落在同一个cache line中, 下沉时访存更少, 树也更矮
+namespace CCSTL {
+    // 把value放到hole位置, 沿着父节点向上, 直到top为止
+    template <size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+    void __dary_push_heap(RandomAccessIterator first, Distance hole, Distance top,
+                          T value, Compare comp) {
+        Distance parent = (hole - 1) / D;
+        while(hole > top && comp(*(first + parent), value)) {
+            *(first + hole) = std::move(*(first + parent));
+            hole = parent;
+            parent = (hole - 1) / D;
+        }
+        *(first + hole) = std::move(value);
+    }
+
+    // 从hole开始沿着较大的孩子向下, 把value放到合适的位置
+    template <size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+    void __dary_adjust_heap(RandomAccessIterator first, Distance hole, Distance len,
+                            T value, Compare comp) {
+        const Distance top = hole;
+        Distance child = D * hole + 1;
+        // 孩子全部存在的节点, 不必检查边界
+        while(child + Distance(D) <= len) {
+            // 写成条件赋值, 编译器可以生成cmov, 随机数据下分支预测不准
+            Distance best = child;
+            for(size_t k = 1; k < D; ++k)
+                best = comp(*(first + best), *(first + (child + k))) ? child + k : best;
+            *(first + hole) = std::move(*(first + best));
+            hole = best;
+            child = D * hole + 1;
+        }
+        // 最后一个节点的孩子不满
+        if(child < len) {
+            Distance best = child;
+            for(Distance k = child + 1; k < len; ++k) {
+                if(comp(*(first + best), *(first + k)))
+                    best = k;
+            }
+            *(first + hole) = std::move(*(first + best));
+            hole = best;
+        }
+        // 先一路下沉到叶子再上浮, 比每层都与value比较少一半的比较次数
+        __dary_push_heap<D>(first, hole, top, std::move(value), comp);
+    }
+
+    // 新元素已经放在last-1的位置
+    template <size_t D, class RandomAccessIterator, class Compare>
+    inline void dary_push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        Distance len = last - first;
+        if(len > 1) {
+            T value = std::move(*(last - 1));
+            __dary_push_heap<D>(first, Distance(len - 1), Distance(0), std::move(value), comp);
+        }
+    }
+
+    // 把最大的元素移到last-1, [first, last-1)仍然是堆
+    template <size_t D, class RandomAccessIterator, class Compare>
+    inline void dary_pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        Distance len = last - first;
+        if(len > 1) {
+            T value = std::move(*(last - 1));
+            *(last - 1) = std::move(*first);
+            __dary_adjust_heap<D>(first, Distance(0), Distance(len - 1), std::move(value), comp);
+        }
+    }
+
+    // Floyd的自底向上建堆, O(n)
+    template <size_t D, class RandomAccessIterator, class Compare>
+    void dary_make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        Distance len = last - first;
+        if(len < 2)
+            return;
+        for(Distance parent = (len - 2) / D; ; --parent) {
+            T value = std::move(*(first + parent));
+            __dary_adjust_heap<D>(first, parent, len, std::move(value), comp);
+            if(parent == 0)
+                return;
+        }
+    }
+
+    template <size_t D, class RandomAccessIterator, class Compare>
+    void dary_sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        while(last - first > 1) {
+            dary_pop_heap<D>(first, last, comp);
+            --last;
+        }
+    }
+
+    template <size_t D, class RandomAccessIterator, class Compare>
+    bool dary_is_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        Distance len = last - first;
+        for(Distance child = 1; child < len; ++child) {
+            if(comp(*(first + (child - 1) / D), *(first + child)))
+                return false;
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------
+    // 二叉堆
+    // ---------------------------------------------------------------
+    template <class RandomAccessIterator, class Compare>
+    inline void push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        dary_push_heap<2>(first, last, comp);
+    }
+
+    template <class RandomAccessIterator>
+    inline void push_heap(RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        dary_push_heap<2>(first, last, std::less<T>());
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        dary_pop_heap<2>(first, last, comp);
+    }
+
+    template <class RandomAccessIterator>
+    inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        dary_pop_heap<2>(first, last, std::less<T>());
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        dary_make_heap<2>(first, last, comp);
+    }
+
+    template <class RandomAccessIterator>
+    inline void make_heap(RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        dary_make_heap<2>(first, last, std::less<T>());
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        dary_sort_heap<2>(first, last, comp);
+    }
+
+    template <class RandomAccessIterator>
+    inline void sort_heap(RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        dary_sort_heap<2>(first, last, std::less<T>());
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline bool is_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        return dary_is_heap<2>(first, last, comp);
+    }
+
+    template <class RandomAccessIterator>
+    inline bool is_heap(RandomAccessIterator first, RandomAccessIterator last) {
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        return dary_is_heap<2>(first, last, std::less<T>());
+    }
+}
+#endif
@@ -0,0 +1,259 @@
+#ifndef MAPPED_VECTOR_H
+#define MAPPED_VECTOR_H
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include "MmapAlloc.h"
+
+namespace CCSTL {
+    // 文件布局: 64字节的头, 之后(按alignof(T)对齐)是连续存放的元素.
+    // 头和元素都直接映射在内存里, 修改立即反映到页缓存中
+    struct mapped_vector_header {
+        char magic[8];          // "CCSTLMV"
+        uint32_t version;
+        uint32_t elem_size;     // sizeof(T), 打开时用来检查类型是否匹配
+        uint64_t size;
+        uint64_t capacity;
+        char reserved[32];
+    };
+
+    // 以文件为存储的vector, 只能存放可平凡复制的元素
+    //
+    // 接口与vector相同, 迭代器就是T*; 不同的是空间来自mapped_file:
+    // 扩容时用ftruncate加长文件, 再用mremap扩大映射, 内核只是改页表,
+    // 不需要像vector::insert_aux那样把旧元素复制到新空间.
+    // 重新打开时只映射文件, 不读取任何数据, 元素在第一次访问时才被调入,
+    // 所以打开几十GB的文件也只需要几次系统调用; 数据可以比内存大.
+    //
+    // 扩容后映射地址可能改变, 和vector一样, 之前的迭代器和指针全部失效.
+    // 所有系统调用的失败都抛出std::system_error
+    template <class T>
+    class mapped_vector {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "mapped_vector requires a trivially copyable element type");
+    public:
+        typedef T value_type;
+        typedef value_type* pointer;
+        typedef const value_type* const_pointer;
+        typedef value_type* iterator;
+        typedef const value_type* const_iterator;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        static const uint32_t format_version = 1;
+
+    private:
+        static const size_type data_offset =
+            (sizeof(mapped_vector_header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+        mapped_file file;
+        mapped_vector_header* header;
+        iterator start;
+
+        static const char* magic() { return "CCSTLMV"; }
+
+        static std::system_error error(std::errc e, const char* what) {
+            return std::system_error(std::make_error_code(e), what);
+        }
+
+        // 映射地址改变后重新取得头和数据的位置
+        void attach() {
+            header = reinterpret_cast<mapped_vector_header*>(file.data());
+            start = reinterpret_cast<iterator>(file.data() + data_offset);
+        }
+
+        void reallocate(size_type new_capacity) {
+            if(!file.is_writable())
+                throw error(std::errc::operation_not_permitted, "mapped_vector: opened read-only");
+            file.resize(data_offset + new_capacity * sizeof(T));
+            attach();
+            header->capacity = new_capacity;
+        }
+
+        // 至少放得下n个元素, 与vector一样按两倍增长
+        void grow_to(size_type n) {
+            size_type cap = capacity();
+            if(n <= cap)
+                return;
+            size_type new_capacity = cap * 2;
+            // 第一次分配至少用满一页
+            size_type first = (mmap_alloc::page_size() - data_offset) / sizeof(T);
+            if(new_capacity < first)
+                new_capacity = first;
+            if(new_capacity < n)
+                new_capacity = n;
+            reallocate(new_capacity);
+        }
+
+        void set_size(size_type n) { header->size = n; }
+
+    public:
+        mapped_vector(): header(0), start(0) {}
+        // 打开已有的文件, 文件不存在时新建
+        explicit mapped_vector(const char* path): header(0), start(0) {
+            try {
+                open(path);
+            } catch(const std::system_error& e) {
+                if(e.code() != std::errc::no_such_file_or_directory)
+                    throw;
+                create(path);
+            }
+        }
+
+        mapped_vector(const mapped_vector&) = delete;
+        mapped_vector& operator=(const mapped_vector&) = delete;
+
+        // 析构时不做msync: 脏页由内核写回; 需要落盘时先调用sync()
+        ~mapped_vector() { close(); }
+
+        // 新建(或截断)文件, capacity为预留的元素个数
+        void create(const char* path, size_type capacity = 0) {
+            close();
+            file.create(path, data_offset + capacity * sizeof(T));
+            attach();
+            std::memset(header, 0, sizeof(*header));
+            std::memcpy(header->magic, magic(), sizeof(header->magic));
+            header->version = format_version;
+            header->elem_size = sizeof(T);
+            header->size = 0;
+            header->capacity = capacity;
+        }
+
+        // 映射已有的文件, 不复制数据.
+        // 只读打开时映射没有写权限, 只能通过const接口访问, 写入元素会引发SIGSEGV
+        void open(const char* path, bool writable = true) {
+            close();
+            file.open(path, writable);
+            if(file.size() < data_offset) {
+                file.close();
+                throw error(std::errc::invalid_argument, "mapped_vector: file too small");
+            }
+            attach();
+            if(std::memcmp(header->magic, magic(), sizeof(header->magic)) != 0 ||
+               header->version != format_version || header->elem_size != sizeof(T) ||
+               header->size > header->capacity ||
+               file.size() < data_offset + header->capacity * sizeof(T)) {
+                header = 0;
+                start = 0;
+                file.close();
+                throw error(std::errc::invalid_argument, "mapped_vector: bad file header");
+            }
+        }
+
+        void close() {
+            file.close();
+            header = 0;
+            start = 0;
+        }
+
+        bool is_open() const { return file.is_open(); }
+
+        // 把修改写回文件. async为true时只发起写回, 不等待完成
+        void sync(bool async = false) { file.sync(async); }
+
+        // 按访问方式提示内核: 顺序扫描时加大预读, 随机访问时关掉预读,
+        // willneed则立即在后台开始调入
+        void advise(mapped_file::advice a) {
+            if(size())
+                file.advise(a, data_offset, size() * sizeof(T));
+        }
+        void advise(mapped_file::advice a, size_type first, size_type n) {
+            if(n)
+                file.advise(a, data_offset + first * sizeof(T), n * sizeof(T));
+        }
+
+        iterator begin() { return start; }
+        const_iterator begin() const { return start; }
+        iterator end() { return start + size(); }
+        const_iterator end() const { return start + size(); }
+        pointer data() { return start; }
+        const_pointer data() const { return start; }
+
+        size_type size() const { return header ? size_type(header->size) : 0; }
+        size_type capacity() const { return header ? size_type(header->capacity) : 0; }
+        bool empty() const { return size() == 0; }
+
+        reference operator[](size_type n) { return start[n]; }
+        const_reference operator[](size_type n) const { return start[n]; }
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *(end() - 1); }
+        const_reference back() const { return *(end() - 1); }
+
+        void reserve(size_type n) {
+            if(n > capacity())
+                reallocate(n);
+        }
+
+        // 把文件截短到正好放下现有元素
+        void shrink_to_fit() {
+            if(capacity() != size())
+                reallocate(size());
+        }
+
+        void push_back(const T& x) {
+            size_type n = size();
+            if(n == capacity()) {
+                // x可能就是容器里的元素, mremap之后旧的地址已经解除映射, 先复制一份(与vector::insert_aux相同)
+                T x_copy = x;
+                grow_to(n + 1);
+                start[n] = x_copy;
+            } else
+                start[n] = x;
+            set_size(n + 1);
+        }
+
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            push_back(T(std::forward<Args>(args)...));
+        }
+
+        void pop_back() { set_size(size() - 1); }
+
+        void resize(size_type new_size, const T& x) {
+            size_type n = size();
+            if(new_size > n) {
+                T x_copy = x;   // 同push_back
+                grow_to(new_size);
+                std::fill(start + n, start + new_size, x_copy);
+            }
+            set_size(new_size);
+        }
+        void resize(size_type new_size) { resize(new_size, T()); }
+
+        void clear() { set_size(0); }
+
+        iterator erase(iterator first, iterator last) {
+            iterator finish = end();
+            std::memmove(first, last, (finish - last) * sizeof(T));
+            set_size(size() - (last - first));
+            return first;
+        }
+        iterator erase(iterator position) { return erase(position, position + 1); }
+
+        // 在末尾追加[first, last), 批量建立数据时比逐个push_back少检查容量.
+        // 与vector::insert相同, [first, last)不能来自这个容器本身
+        template <class ForwardIterator>
+        void append(ForwardIterator first, ForwardIterator last) {
+            size_type n = size();
+            size_type count = 0;
+            for(ForwardIterator i = first; i != last; ++i)
+                ++count;
+            grow_to(n + count);
+            std::copy(first, last, start + n);
+            set_size(n + count);
+        }
+
+        void swap(mapped_vector& v) {
+            std::swap(header, v.header);
+            std::swap(start, v.start);
+            file.swap(v.file);
+        }
+    };
+}
+#endif
@@ -0,0 +1,550 @@
+#ifndef PERSISTENT_VECTOR_H
+#define PERSISTENT_VECTOR_H
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Alloc.h"
+#include "Trait.h"
+
+namespace CCSTL {
+    // 不可变的vector, 修改时与原来的版本共享没有改动的部分
+    //
+    // 元素存放在32叉的trie中, 每个叶子32个元素, 下标i按每5位一层从根找到叶子;
+    // 最后不满32个的元素放在单独的tail叶子里, 所以push_back/pop_back大多只动tail.
+    // 节点带原子的引用计数, 复制persistent_vector只是给根和tail加一次计数(O(1)的快照),
+    // push_back/set/pop_back返回新的版本, 只复制从根到被修改叶子的一条路径(O(log32 n)个节点),
+    // 原来的版本不变.
+    //
+    // 修改时只复制被别的版本共享的节点(引用计数大于1), 只属于自己的节点原地修改.
+    // transient_vector就是利用这一点做批量修改: 第一次改到某条路径时复制, 之后都在原地进行,
+    // 改完用persistent()变回persistent_vector, 两者之间的转换都是O(1).
+    //
+    // 线程: 不同的线程可以各自持有共享节点的persistent_vector, 读取和析构都不需要加锁;
+    // 同一个对象(包括transient_vector)不能同时被多个线程修改.
+    // 节点来自alloc, 内存池本身不是线程安全的, 所以分配和释放节点时持有alloc_mutex()(快照常常在读者线程中析构)
+    struct __pvec_node {
+        std::atomic<size_t> refs;
+
+        __pvec_node(): refs(1) {}
+    };
+
+    struct __pvec_inner: __pvec_node {
+        __pvec_node* child[32];
+
+        __pvec_inner() {
+            for(size_t i = 0; i < 32; ++i)
+                child[i] = 0;
+        }
+    };
+
+    // count是已经构造的元素个数: trie中的叶子总是32, tail是tail的长度
+    template <class T>
+    struct __pvec_leaf: __pvec_node {
+        size_t count;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type elems[32];
+
+        __pvec_leaf(): count(0) {}
+
+        T* data() { return reinterpret_cast<T*>(elems); }
+        const T* data() const { return reinterpret_cast<const T*>(elems); }
+    };
+
+    template <class T>
+    class __pvec_base {
+        static_assert(alignof(T) <= 16, "persistent_vector elements must not need more than 16-byte alignment");
+
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T& const_reference;
+
+        size_type size() const { return cnt; }
+        bool empty() const { return cnt == 0; }
+        const_reference operator[](size_type i) const { return leaf_for(i)->data()[i & mask]; }
+        const_reference front() const { return (*this)[0]; }
+        const_reference back() const { return (*this)[cnt - 1]; }
+
+    protected:
+        static const unsigned bits = 5;
+        static const size_type width = size_type(1) << bits;
+        static const size_type mask = width - 1;
+
+        typedef __pvec_inner inner;
+        typedef __pvec_leaf<T> leaf;
+
+        __pvec_base(): cnt(0), shift(bits), root(0), tail(0) {}
+        __pvec_base(const __pvec_base& x): cnt(x.cnt), shift(x.shift), root(x.root), tail(x.tail) {
+            retain(root);
+            retain(tail);
+        }
+        __pvec_base(__pvec_base&& x) noexcept: cnt(x.cnt), shift(x.shift), root(x.root), tail(x.tail) {
+            x.cnt = 0;
+            x.shift = bits;
+            x.root = 0;
+            x.tail = 0;
+        }
+        ~__pvec_base() { reset(); }
+
+        void swap_base(__pvec_base& x) noexcept {
+            std::swap(cnt, x.cnt);
+            std::swap(shift, x.shift);
+            std::swap(root, x.root);
+            std::swap(tail, x.tail);
+        }
+
+        void reset() {
+            release_inner(root, shift);
+            release_leaf(tail);
+            cnt = 0;
+            shift = bits;
+            root = 0;
+            tail = 0;
+        }
+
+        // 节点的分配与引用计数
+        static void* allocate_node(size_t n) {
+            std::lock_guard<std::mutex> lock(alloc_mutex());
+            return alloc::allocate(n);
+        }
+        static void deallocate_node(void* p, size_t n) {
+            std::lock_guard<std::mutex> lock(alloc_mutex());
+            alloc::deallocate(p, n);
+        }
+
+        static inner* new_inner() { return new(allocate_node(sizeof(inner))) inner; }
+        static leaf* new_leaf() { return new(allocate_node(sizeof(leaf))) leaf; }
+
+        static void free_leaf(leaf* p) {
+            for(size_t i = 0; i < p->count; ++i)
+                p->data()[i].~T();
+            p->~leaf();
+            deallocate_node(p, sizeof(leaf));
+        }
+
+        static void retain(__pvec_node* p) {
+            if(p)
+                p->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        static bool unique(const __pvec_node* p) { return p->refs.load(std::memory_order_acquire) == 1; }
+
+        static void release_leaf(__pvec_node* p) {
+            if(p && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                free_leaf(static_cast<leaf*>(p));
+        }
+        // level是p这一层的位移, 为bits时子节点是叶子
+        static void release_inner(__pvec_node* p, unsigned level) {
+            if(!p || p->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            inner* node = static_cast<inner*>(p);
+            for(size_t i = 0; i < width; ++i) {
+                if(level == bits)
+                    release_leaf(node->child[i]);
+                else
+                    release_inner(node->child[i], level - bits);
+            }
+            node->~inner();
+            deallocate_node(node, sizeof(inner));
+        }
+
+        // 复制叶子的前n个元素, 元素的复制抛出异常时不泄漏
+        static leaf* copy_leaf(const leaf* src, size_t n) {
+            leaf* p = new_leaf();
+            try {
+                for(; p->count < n; ++p->count)
+                    new(static_cast<void*>(p->data() + p->count)) T(src->data()[p->count]);
+            } catch(...) {
+                free_leaf(p);
+                throw;
+            }
+            return p;
+        }
+
+        static inner* copy_inner(const inner* src) {
+            inner* p = new_inner();
+            for(size_t i = 0; i < width; ++i) {
+                p->child[i] = src->child[i];
+                retain(p->child[i]);
+            }
+            return p;
+        }
+
+        // 保证slot指向的节点只属于自己, 被共享时换成一份复制
+        static inner* unique_inner(__pvec_node*& slot, unsigned level) {
+            if(!slot) {
+                slot = new_inner();
+            } else if(!unique(slot)) {
+                inner* p = copy_inner(static_cast<inner*>(slot));
+                release_inner(slot, level);
+                slot = p;
+            }
+            return static_cast<inner*>(slot);
+        }
+        static leaf* unique_leaf(__pvec_node*& slot) {
+            if(!unique(slot)) {
+                leaf* p = copy_leaf(static_cast<leaf*>(slot), static_cast<leaf*>(slot)->count);
+                release_leaf(slot);
+                slot = p;
+            }
+            return static_cast<leaf*>(slot);
+        }
+
+        // trie中元素的个数, tail从这里开始
+        size_type tail_offset() const { return cnt < width ? 0 : ((cnt - 1) >> bits) << bits; }
+
+        const leaf* leaf_for(size_type i) const {
+            if(i >= tail_offset())
+                return tail;
+            const __pvec_node* node = root;
+            for(unsigned level = shift; level > bits; level -= bits)
+                node = static_cast<const inner*>(node)->child[(i >> level) & mask];
+            return static_cast<const leaf*>(static_cast<const inner*>(node)->child[(i >> bits) & mask]);
+        }
+
+        // 以下修改都是原地进行的, 只复制被共享的节点
+        void push_back_in_place(const T& x) {
+            if(cnt - tail_offset() < width) {
+                // tail还有位置. x可能就在旧的tail里, 先构造再释放旧的
+                leaf* old = tail;
+                leaf* t = !old ? new_leaf() : unique(old) ? old : copy_leaf(old, old->count);
+                try {
+                    new(static_cast<void*>(t->data() + t->count)) T(x);
+                } catch(...) {
+                    if(t != old)
+                        free_leaf(t);
+                    throw;
+                }
+                ++t->count;
+                if(t != old) {
+                    release_leaf(old);
+                    tail = t;
+                }
+                ++cnt;
+                return;
+            }
+            // tail满了, 放进trie, x作为新的tail
+            leaf* t = new_leaf();
+            try {
+                new(static_cast<void*>(t->data())) T(x);
+            } catch(...) {
+                free_leaf(t);
+                throw;
+            }
+            t->count = 1;
+            try {
+                push_tail();
+            } catch(...) {
+                free_leaf(t);
+                throw;
+            }
+            tail = t;
+            ++cnt;
+        }
+
+        // 把满的tail挂到trie上, trie满了时先加一层
+        void push_tail() {
+            if((cnt >> bits) > (size_type(1) << shift)) {
+                inner* r = new_inner();
+                r->child[0] = root;
+                root = r;
+                shift += bits;
+            }
+            __pvec_node** slot = &root;
+            for(unsigned level = shift; ; level -= bits) {
+                inner* node = unique_inner(*slot, level);
+                size_type sub = ((cnt - 1) >> level) & mask;
+                if(level == bits) {
+                    // tail的引用转给trie
+                    node->child[sub] = tail;
+                    break;
+                }
+                slot = &node->child[sub];
+            }
+        }
+
+        void set_in_place(size_type i, T x) {
+            leaf* l;
+            if(i >= tail_offset()) {
+                __pvec_node* slot = tail;
+                l = unique_leaf(slot);
+                tail = l;
+            } else {
+                __pvec_node** slot = &root;
+                unsigned level = shift;
+                for(; level > bits; level -= bits)
+                    slot = &unique_inner(*slot, level)->child[(i >> level) & mask];
+                l = unique_leaf(unique_inner(*slot, level)->child[(i >> bits) & mask]);
+            }
+            l->data()[i & mask] = std::move(x);
+        }
+
+        void pop_back_in_place() {
+            if(cnt == 1) {
+                reset();
+                return;
+            }
+            if(cnt - tail_offset() > 1) {
+                __pvec_node* slot = tail;
+                leaf* t = unique_leaf(slot);
+                t->data()[--t->count].~T();
+                tail = t;
+                --cnt;
+                return;
+            }
+            // tail只剩一个元素: trie中最后一个叶子变成tail
+            leaf* t = const_cast<leaf*>(leaf_for(cnt - 2));
+            retain(t);
+            pop_tail(root, shift);
+            release_leaf(tail);
+            tail = t;
+            --cnt;
+            // 根只剩一个子节点时去掉一层
+            if(shift > bits && root && static_cast<inner*>(root)->child[1] == 0) {
+                inner* r = static_cast<inner*>(root);
+                root = r->child[0];
+                retain(root);
+                release_inner(r, shift);
+                shift -= bits;
+            }
+        }
+
+        // 从trie中摘掉下标cnt-2所在的叶子, 变空的节点一并释放
+        void pop_tail(__pvec_node*& slot, unsigned level) {
+            size_type sub = ((cnt - 2) >> level) & mask;
+            inner* node = unique_inner(slot, level);
+            if(level > bits) {
+                pop_tail(node->child[sub], level - bits);
+            } else {
+                release_leaf(node->child[sub]);
+                node->child[sub] = 0;
+            }
+            if(sub == 0 && node->child[0] == 0) {
+                release_inner(node, level);
+                slot = 0;
+            }
+        }
+
+        size_type cnt;
+        unsigned shift;     // 根的位移, 至少是bits
+        __pvec_node* root;  // 内部节点, trie为空时为0
+        leaf* tail;         // 为空时为0
+    };
+
+    template <class T>
+    class transient_vector;
+
+    template <class T>
+    class persistent_vector: public __pvec_base<T> {
+        typedef __pvec_base<T> base;
+        using base::cnt;
+        using base::mask;
+        using base::width;
+
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T& const_reference;
+        typedef const T& reference;
+        typedef const T* const_pointer;
+        typedef const T* pointer;
+
+        // 随机访问迭代器, 缓存当前所在的叶子, 顺序遍历时每32个元素才从根找一次
+        class const_iterator {
+        public:
+            typedef random_access_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            const_iterator(const persistent_vector* v, size_type i): v(v), i(i), block(0), block_start(0) { locate(); }
+
+            reference operator*() const { return block[i - block_start]; }
+            pointer operator->() const { return &(operator*()); }
+            reference operator[](difference_type n) const { return (*v)[i + n]; }
+
+            const_iterator& operator++() {
+                if(++i - block_start >= width)
+                    locate();
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator& operator--() {
+                if(--i - block_start >= width)
+                    locate();
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator& operator+=(difference_type n) {
+                i += n;
+                if(i - block_start >= width)
+                    locate();
+                return *this;
+            }
+            const_iterator& operator-=(difference_type n) { return *this += -n; }
+            const_iterator operator+(difference_type n) const {
+                const_iterator tmp = *this;
+                return tmp += n;
+            }
+            const_iterator operator-(difference_type n) const {
+                const_iterator tmp = *this;
+                return tmp += -n;
+            }
+            difference_type operator-(const const_iterator& x) const { return difference_type(i - x.i); }
+
+            bool operator==(const const_iterator& x) const { return i == x.i; }
+            bool operator!=(const const_iterator& x) const { return i != x.i; }
+            bool operator<(const const_iterator& x) const { return i < x.i; }
+            bool operator>(const const_iterator& x) const { return x < *this; }
+            bool operator<=(const const_iterator& x) const { return !(x < *this); }
+            bool operator>=(const const_iterator& x) const { return !(*this < x); }
+
+        private:
+            // 在结尾时没有叶子, block_start取i, 往回走一步就会重新定位
+            void locate() {
+                if(i < v->cnt) {
+                    block = v->leaf_for(i)->data();
+                    block_start = i & ~mask;
+                } else {
+                    block = 0;
+                    block_start = i;
+                }
+            }
+
+            const persistent_vector* v;
+            size_type i;
+            const T* block;
+            size_type block_start;
+        };
+        typedef const_iterator iterator;
+
+        persistent_vector() {}
+        persistent_vector(size_type n, const T& value) {
+            while(n--)
+                this->push_back_in_place(value);
+        }
+        template <class InputIterator>
+        persistent_vector(InputIterator first, InputIterator last,
+            typename std::enable_if<!std::is_integral<InputIterator>::value>::type* = 0) {
+            for(; first != last; ++first)
+                this->push_back_in_place(*first);
+        }
+        persistent_vector(std::initializer_list<T> il) {
+            for(const T* p = il.begin(); p != il.end(); ++p)
+                this->push_back_in_place(*p);
+        }
+        // 复制就是快照, O(1)
+        persistent_vector(const persistent_vector& x): base(x) {}
+        persistent_vector(persistent_vector&& x) noexcept: base(std::move(x)) {}
+
+        persistent_vector& operator=(const persistent_vector& x) {
+            persistent_vector tmp(x);
+            this->swap_base(tmp);
+            return *this;
+        }
+        persistent_vector& operator=(persistent_vector&& x) noexcept {
+            persistent_vector tmp(std::move(x));
+            this->swap_base(tmp);
+            return *this;
+        }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, cnt); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // 修改都返回新的版本, *this不变
+        persistent_vector push_back(const T& x) const {
+            persistent_vector r(*this);
+            r.push_back_in_place(x);
+            return r;
+        }
+        persistent_vector set(size_type i, const T& x) const {
+            persistent_vector r(*this);
+            r.set_in_place(i, x);
+            return r;
+        }
+        persistent_vector pop_back() const {
+            persistent_vector r(*this);
+            r.pop_back_in_place();
+            return r;
+        }
+
+        // 批量修改用的可变版本, 与*this共享全部节点
+        transient_vector<T> transient() const { return transient_vector<T>(*this); }
+
+        void swap(persistent_vector& x) noexcept { this->swap_base(x); }
+
+    private:
+        friend class transient_vector<T>;
+        explicit persistent_vector(base&& x): base(std::move(x)) {}
+    };
+
+    // persistent_vector的可变版本, 修改都在原地进行, 只在第一次碰到共享的节点时复制.
+    // 只能在一个线程中使用, 改完用persistent()取出结果
+    template <class T>
+    class transient_vector: public __pvec_base<T> {
+        typedef __pvec_base<T> base;
+
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+
+        transient_vector() {}
+        explicit transient_vector(const persistent_vector<T>& x): base(x) {}
+        transient_vector(transient_vector&& x) noexcept: base(std::move(x)) {}
+
+        transient_vector(const transient_vector&) = delete;
+        transient_vector& operator=(const transient_vector&) = delete;
+        transient_vector& operator=(transient_vector&& x) noexcept {
+            transient_vector tmp(std::move(x));
+            this->swap_base(tmp);
+            return *this;
+        }
+
+        void push_back(const T& x) { this->push_back_in_place(x); }
+        void set(size_type i, const T& x) { this->set_in_place(i, x); }
+        void pop_back() { this->pop_back_in_place(); }
+        void clear() { this->reset(); }
+
+        // 把内容交给persistent_vector, 之后*this为空
+        persistent_vector<T> persistent() { return persistent_vector<T>(std::move(static_cast<base&>(*this))); }
+    };
+
+    template <class T>
+    bool operator==(const persistent_vector<T>& a, const persistent_vector<T>& b) {
+        if(a.size() != b.size())
+            return false;
+        typename persistent_vector<T>::const_iterator i = a.begin(), j = b.begin();
+        for(; i != a.end(); ++i, ++j) {
+            if(!(*i == *j))
+                return false;
+        }
+        return true;
+    }
+
+    template <class T>
+    bool operator!=(const persistent_vector<T>& a, const persistent_vector<T>& b) {
+        return !(a == b);
+    }
+
+    template <class T>
+    void swap(persistent_vector<T>& a, persistent_vector<T>& b) noexcept {
+        a.swap(b);
+    }
+}
+
+#endif
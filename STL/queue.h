@@ -0,0 +1,143 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+#include <functional>
+#include <utility>
+#include "vector.h"
+#include "heap.h"
+#include "ring_buffer.h"
+#include "uninitialized.h"
+
+namespace CCSTL {
+    // 优先队列, 以Sequence为底层容器, 用堆算法维护大顶堆
+    // Arity为堆的叉数, 默认是二叉堆; 元素较小、队列较长时4叉堆通常更快:
+    // 下沉的层数减半, 每个节点的孩子在内存中是连续的
+    template <class T, class Sequence = vector<T>,
+              class Compare = std::less<typename Sequence::value_type>, size_t Arity = 2>
+    class priority_queue {
+    public:
+        typedef typename Sequence::value_type value_type;
+        typedef typename Sequence::size_type size_type;
+        typedef typename Sequence::reference reference;
+        typedef typename Sequence::const_reference const_reference;
+        typedef Sequence container_type;
+        typedef Compare value_compare;
+
+        static const size_t arity = Arity;
+
+    protected:
+        Sequence c;
+        Compare comp;
+
+    public:
+        priority_queue(): c(), comp() {}
+        explicit priority_queue(const Compare& x): c(), comp(x) {}
+        priority_queue(const Compare& x, const Sequence& s): c(s), comp(x) {
+            dary_make_heap<Arity>(c.begin(), c.end(), comp);
+        }
+        priority_queue(const Compare& x, Sequence&& s): c(std::move(s)), comp(x) {
+            dary_make_heap<Arity>(c.begin(), c.end(), comp);
+        }
+
+        // 先把整个区间放进容器再一次性建堆, O(n), 而逐个push是O(n log n)
+        template <class InputIterator>
+        priority_queue(InputIterator first, InputIterator last): c(first, last), comp() {
+            dary_make_heap<Arity>(c.begin(), c.end(), comp);
+        }
+        template <class InputIterator>
+        priority_queue(InputIterator first, InputIterator last, const Compare& x)
+            : c(first, last), comp(x) {
+            dary_make_heap<Arity>(c.begin(), c.end(), comp);
+        }
+
+        bool empty() const { return c.empty(); }
+        size_type size() const { return c.size(); }
+        const_reference top() const { return c.front(); }
+
+        void push(const value_type& x) {
+            c.push_back(x);
+            dary_push_heap<Arity>(c.begin(), c.end(), comp);
+        }
+
+        template <class... Args>
+        void emplace(Args&&... args) {
+            c.emplace_back(std::forward<Args>(args)...);
+            dary_push_heap<Arity>(c.begin(), c.end(), comp);
+        }
+
+        void pop() {
+            dary_pop_heap<Arity>(c.begin(), c.end(), comp);
+            c.pop_back();
+        }
+
+        void swap(priority_queue& x) {
+            c.swap(x.c);
+            std::swap(comp, x.comp);
+        }
+    };
+
+    // 有pop_front的容器(ring_buffer、deque、list)直接用; 否则退回erase(begin()),
+    // 对vector来说每次出队都要把其余元素前移一位, 是O(n)
+    template <class Sequence>
+    auto __pop_front(Sequence& c, int) -> decltype(c.pop_front(), void()) {
+        c.pop_front();
+    }
+    template <class Sequence>
+    void __pop_front(Sequence& c, long) {
+        c.erase(c.begin());
+    }
+
+    // 先进先出队列, 以Sequence为底层容器, 尾端进、头端出.
+    // 默认的ring_buffer容量稳定之后不再分配内存, 比deque少一层缓冲区间的跳转;
+    // 也可以用deque或list, vector只在很短的队列上可以接受
+    template <class T, class Sequence = ring_buffer<T>>
+    class queue {
+    public:
+        typedef typename Sequence::value_type value_type;
+        typedef typename Sequence::size_type size_type;
+        typedef typename Sequence::reference reference;
+        typedef typename Sequence::const_reference const_reference;
+        typedef Sequence container_type;
+
+    protected:
+        Sequence c;
+
+    public:
+        queue(): c() {}
+        explicit queue(const Sequence& s): c(s) {}
+        explicit queue(Sequence&& s): c(std::move(s)) {}
+
+        bool empty() const { return c.empty(); }
+        size_type size() const { return c.size(); }
+        reference front() { return c.front(); }
+        const_reference front() const { return c.front(); }
+        reference back() { return c.back(); }
+        const_reference back() const { return c.back(); }
+
+        void push(const value_type& x) { c.push_back(x); }
+
+        template <class... Args>
+        void emplace(Args&&... args) {
+            c.emplace_back(std::forward<Args>(args)...);
+        }
+
+        // 依次入队[first, last); 长度已知并且底层容器有reserve时一次预留好
+        template <class InputIterator>
+        void push_range(InputIterator first, InputIterator last) {
+            __append_range(c, first, last);
+        }
+        template <class Range>
+        void push_range(const Range& r) {
+            __append_range(c, r.begin(), r.end());
+        }
+
+        void pop() { __pop_front(c, 0); }
+
+        void swap(queue& x) { c.swap(x.c); }
+    };
+
+    template <class T, class Sequence>
+    void swap(queue<T, Sequence>& a, queue<T, Sequence>& b) {
+        a.swap(b);
+    }
+}
+#endif
@@ -0,0 +1,780 @@
+#ifndef RANGES_H
+#define RANGES_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "Trait.h"
+
+// 惰性的区间视图. 视图只保存底层区间(容器的引用或者另一个视图)和参数, 不分配内存,
+// 取元素时才计算; 多个步骤用 | 串起来, 最后用to<vector>()之类的收集成容器:
+//   vector<int> r = v | views::filter(is_even) | views::transform(square) | views::take(10) | to<vector>();
+// 每个视图的迭代器通过iterator_traits给出尽可能强的类别:
+//   filter       最多双向
+//   transform    与底层相同, 元素是函数的返回值
+//   take/drop    与底层相同(非随机访问的take最多单向)
+//   zip          两边都随机访问时随机访问, 否则最多单向, 较短的一边结束时结束
+//   enumerate    随机访问时随机访问, 否则最多单向, 元素是pair<下标, 元素>
+//   chunk        随机访问时随机访问, 否则最多单向, 元素是最多n个元素的subrange
+// 非随机访问的底层不知道结尾的位置, 所以需要从结尾往回走的视图只能单向.
+// 视图的迭代器指向视图本身(filter的谓词、transform的函数存在视图里), 视图被复制或销毁后,
+// 以前取得的迭代器就失效了, 与底层容器的迭代器失效规则叠加.
+// 左值容器按引用保存, 右值容器搬进视图里(owning_view). filter和drop每次begin()都从头找起
+namespace CCSTL {
+    // 所有视图的基类, 只用来与容器区分
+    struct view_base {};
+
+    template <class R>
+    struct __range_iterator {
+        typedef decltype(std::declval<R&>().begin()) type;
+    };
+
+    template <class R>
+    struct __range_value {
+        typedef typename iterator_traits<typename __range_iterator<R>::type>::value_type type;
+    };
+
+    // 两个类别中较弱的一个
+    template <class A, class B>
+    struct __weaker_category {
+        typedef typename std::conditional<std::is_base_of<A, B>::value, A, B>::type type;
+    };
+
+    template <class Iterator>
+    struct __is_random_access:
+        std::is_base_of<random_access_iterator_tag, typename iterator_traits<Iterator>::iterator_category> {};
+
+    // 最多前进n步, 不超过last, 返回实际的步数
+    template <class Iterator, class Distance>
+    Distance __advance_bounded(Iterator& it, Distance n, const Iterator& last, input_iterator_tag) {
+        Distance k = 0;
+        for(; k < n && it != last; ++k)
+            ++it;
+        return k;
+    }
+
+    template <class Iterator, class Distance>
+    Distance __advance_bounded(Iterator& it, Distance n, const Iterator& last, random_access_iterator_tag) {
+        Distance left = Distance(last - it);
+        if(n > left)
+            n = left;
+        it += n;
+        return n;
+    }
+
+    template <class Iterator, class Distance>
+    inline Distance __advance_bounded(Iterator& it, Distance n, const Iterator& last) {
+        typedef typename iterator_traits<Iterator>::iterator_category category;
+        return __advance_bounded(it, n, last, category());
+    }
+
+    template <class Iterator>
+    typename iterator_traits<Iterator>::difference_type
+    __range_distance(Iterator first, Iterator last, input_iterator_tag) {
+        typename iterator_traits<Iterator>::difference_type n = 0;
+        for(; first != last; ++first)
+            ++n;
+        return n;
+    }
+
+    template <class Iterator>
+    inline typename iterator_traits<Iterator>::difference_type
+    __range_distance(Iterator first, Iterator last, random_access_iterator_tag) {
+        return last - first;
+    }
+
+    // 视图迭代器共用的运算符. Derived只需要提供*、前置++/--、==, 随机访问的再提供+=、-(迭代器)和<,
+    // 其余的(后置++/--、!=、+n、-n、[]、> <= >=)由这里按它们实现; 用不到的不会实例化
+    template <class Derived, class Reference, class Difference>
+    struct __iterator_ops {
+        Reference operator[](Difference n) const { return *(derived() + n); }
+
+        friend Derived operator++(Derived& it, int) {
+            Derived tmp(it);
+            ++it;
+            return tmp;
+        }
+        friend Derived operator--(Derived& it, int) {
+            Derived tmp(it);
+            --it;
+            return tmp;
+        }
+        friend bool operator!=(const Derived& a, const Derived& b) { return !(a == b); }
+        friend Derived& operator-=(Derived& it, Difference n) { return it += -n; }
+        friend Derived operator+(const Derived& it, Difference n) {
+            Derived tmp(it);
+            tmp += n;
+            return tmp;
+        }
+        friend Derived operator+(Difference n, const Derived& it) { return it + n; }
+        friend Derived operator-(const Derived& it, Difference n) {
+            Derived tmp(it);
+            tmp += -n;
+            return tmp;
+        }
+        friend bool operator>(const Derived& a, const Derived& b) { return b < a; }
+        friend bool operator<=(const Derived& a, const Derived& b) { return !(b < a); }
+        friend bool operator>=(const Derived& a, const Derived& b) { return !(a < b); }
+
+    private:
+        const Derived& derived() const { return static_cast<const Derived&>(*this); }
+    };
+
+    // ---------------------------------------------------------------
+    // subrange / ref_view / owning_view
+    // ---------------------------------------------------------------
+    // 一对迭代器, chunk的元素就是它
+    template <class Iterator>
+    class subrange: public view_base {
+    public:
+        typedef Iterator iterator;
+        typedef typename iterator_traits<Iterator>::difference_type difference_type;
+
+        subrange(Iterator first, Iterator last): first(first), last(last) {}
+
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+        bool empty() const { return first == last; }
+        // 非随机访问时要走一遍
+        difference_type size() const {
+            typedef typename iterator_traits<Iterator>::iterator_category category;
+            return __range_distance(first, last, category());
+        }
+
+    private:
+        Iterator first;
+        Iterator last;
+    };
+
+    template <class R>
+    class ref_view: public view_base {
+    public:
+        typedef typename __range_iterator<R>::type iterator;
+
+        explicit ref_view(R& r): r(&r) {}
+
+        iterator begin() const { return r->begin(); }
+        iterator end() const { return r->end(); }
+
+    private:
+        R* r;
+    };
+
+    // 右值容器搬进视图, 视图析构时一起析构. 迭代器就是容器的非const迭代器
+    template <class R>
+    class owning_view: public view_base {
+    public:
+        typedef typename __range_iterator<R>::type iterator;
+
+        explicit owning_view(R&& x): r(std::move(x)) {}
+
+        iterator begin() const { return r.begin(); }
+        iterator end() const { return r.end(); }
+
+    private:
+        mutable R r;
+    };
+
+    // 视图原样复制, 左值容器用ref_view, 右值容器用owning_view
+    template <class R>
+    struct __all_view {
+        typedef typename std::remove_cv<typename std::remove_reference<R>::type>::type plain;
+        typedef typename std::conditional<std::is_base_of<view_base, plain>::value, plain,
+            typename std::conditional<std::is_lvalue_reference<R>::value,
+                ref_view<typename std::remove_reference<R>::type>,
+                owning_view<plain> >::type>::type type;
+    };
+
+    // ---------------------------------------------------------------
+    // filter_view
+    // ---------------------------------------------------------------
+    template <class V, class Pred>
+    class filter_view: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+        typedef iterator_traits<base_iterator> base_traits;
+
+    public:
+        class iterator: public __iterator_ops<iterator, typename base_traits::reference,
+                                              typename base_traits::difference_type> {
+        public:
+            typedef typename __weaker_category<bidirectional_iterator_tag,
+                typename base_traits::iterator_category>::type iterator_category;
+            typedef typename base_traits::value_type value_type;
+            typedef typename base_traits::difference_type difference_type;
+            typedef typename base_traits::pointer pointer;
+            typedef typename base_traits::reference reference;
+
+            iterator(const filter_view* parent, base_iterator cur, base_iterator last):
+                parent(parent), cur(cur), last(last) { satisfy(); }
+
+            reference operator*() const { return *cur; }
+            iterator& operator++() {
+                ++cur;
+                satisfy();
+                return *this;
+            }
+            iterator& operator--() {
+                do
+                    --cur;
+                while(!parent->pred(*cur));
+                return *this;
+            }
+            bool operator==(const iterator& x) const { return cur == x.cur; }
+            base_iterator base() const { return cur; }
+
+        private:
+            void satisfy() {
+                while(cur != last && !parent->pred(*cur))
+                    ++cur;
+            }
+
+            const filter_view* parent;
+            base_iterator cur;
+            base_iterator last;
+        };
+
+        filter_view(V base, Pred pred): base_(std::move(base)), pred(std::move(pred)) {}
+
+        iterator begin() const { return iterator(this, base_.begin(), base_.end()); }
+        iterator end() const { return iterator(this, base_.end(), base_.end()); }
+
+    private:
+        V base_;
+        Pred pred;
+    };
+
+    // ---------------------------------------------------------------
+    // transform_view
+    // ---------------------------------------------------------------
+    template <class V, class F>
+    class transform_view: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+        typedef iterator_traits<base_iterator> base_traits;
+        typedef decltype(std::declval<const F&>()(*std::declval<base_iterator>())) result;
+
+    public:
+        class iterator: public __iterator_ops<iterator, result, typename base_traits::difference_type> {
+        public:
+            typedef typename base_traits::iterator_category iterator_category;
+            typedef typename std::decay<result>::type value_type;
+            typedef typename base_traits::difference_type difference_type;
+            typedef void pointer;
+            typedef result reference;
+
+            iterator(const transform_view* parent, base_iterator cur): parent(parent), cur(cur) {}
+
+            reference operator*() const { return parent->f(*cur); }
+            iterator& operator++() {
+                ++cur;
+                return *this;
+            }
+            iterator& operator--() {
+                --cur;
+                return *this;
+            }
+            iterator& operator+=(difference_type n) {
+                cur += n;
+                return *this;
+            }
+            difference_type operator-(const iterator& x) const { return cur - x.cur; }
+            bool operator==(const iterator& x) const { return cur == x.cur; }
+            bool operator<(const iterator& x) const { return cur < x.cur; }
+            base_iterator base() const { return cur; }
+
+        private:
+            const transform_view* parent;
+            base_iterator cur;
+        };
+
+        transform_view(V base, F f): base_(std::move(base)), f(std::move(f)) {}
+
+        iterator begin() const { return iterator(this, base_.begin()); }
+        iterator end() const { return iterator(this, base_.end()); }
+
+    private:
+        V base_;
+        F f;
+    };
+
+    // ---------------------------------------------------------------
+    // take_view / drop_view
+    // ---------------------------------------------------------------
+    // 随机访问时迭代器就是底层的迭代器, 结尾直接算出来
+    template <class V, bool = __is_random_access<typename __range_iterator<const V>::type>::value>
+    class take_view: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+
+    public:
+        typedef base_iterator iterator;
+        typedef typename iterator_traits<base_iterator>::difference_type difference_type;
+
+        take_view(V base, difference_type n): base_(std::move(base)), n(n) {}
+
+        iterator begin() const { return base_.begin(); }
+        iterator end() const {
+            iterator first = base_.begin();
+            __advance_bounded(first, n, base_.end());
+            return first;
+        }
+
+    private:
+        V base_;
+        difference_type n;
+    };
+
+    // 否则迭代器带着剩余的个数, 个数用完或者底层结束都算到了结尾
+    template <class V>
+    class take_view<V, false>: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+        typedef iterator_traits<base_iterator> base_traits;
+
+    public:
+        typedef typename base_traits::difference_type difference_type;
+
+        class iterator: public __iterator_ops<iterator, typename base_traits::reference, difference_type> {
+        public:
+            typedef typename __weaker_category<forward_iterator_tag,
+                typename base_traits::iterator_category>::type iterator_category;
+            typedef typename base_traits::value_type value_type;
+            typedef typename base_traits::difference_type difference_type;
+            typedef typename base_traits::pointer pointer;
+            typedef typename base_traits::reference reference;
+
+            iterator(base_iterator cur, difference_type left): cur(cur), left(left) {}
+
+            reference operator*() const { return *cur; }
+            iterator& operator++() {
+                ++cur;
+                --left;
+                return *this;
+            }
+            bool operator==(const iterator& x) const { return left == x.left || cur == x.cur; }
+            base_iterator base() const { return cur; }
+
+        private:
+            base_iterator cur;
+            difference_type left;
+        };
+
+        take_view(V base, difference_type n): base_(std::move(base)), n(n) {}
+
+        iterator begin() const { return iterator(base_.begin(), n); }
+        iterator end() const { return iterator(base_.end(), 0); }
+
+    private:
+        V base_;
+        difference_type n;
+    };
+
+    template <class V>
+    class drop_view: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+
+    public:
+        typedef base_iterator iterator;
+        typedef typename iterator_traits<base_iterator>::difference_type difference_type;
+
+        drop_view(V base, difference_type n): base_(std::move(base)), n(n) {}
+
+        iterator begin() const {
+            iterator first = base_.begin();
+            __advance_bounded(first, n, base_.end());
+            return first;
+        }
+        iterator end() const { return base_.end(); }
+
+    private:
+        V base_;
+        difference_type n;
+    };
+
+    // ---------------------------------------------------------------
+    // zip_view
+    // ---------------------------------------------------------------
+    template <class V1, class V2>
+    class zip_view: public view_base {
+        typedef typename __range_iterator<const V1>::type base_iterator1;
+        typedef typename __range_iterator<const V2>::type base_iterator2;
+        typedef iterator_traits<base_iterator1> traits1;
+        typedef iterator_traits<base_iterator2> traits2;
+        typedef std::integral_constant<bool, __is_random_access<base_iterator1>::value &&
+                                             __is_random_access<base_iterator2>::value> random_access;
+
+    public:
+        typedef std::pair<typename traits1::reference, typename traits2::reference> reference;
+        typedef typename traits1::difference_type difference_type;
+
+        class iterator: public __iterator_ops<iterator, reference, difference_type> {
+        public:
+            typedef typename std::conditional<random_access::value, random_access_iterator_tag,
+                typename __weaker_category<forward_iterator_tag,
+                    typename __weaker_category<typename traits1::iterator_category,
+                        typename traits2::iterator_category>::type>::type>::type iterator_category;
+            typedef std::pair<typename traits1::value_type, typename traits2::value_type> value_type;
+            typedef typename zip_view::difference_type difference_type;
+            typedef void pointer;
+            typedef typename zip_view::reference reference;
+
+            iterator(base_iterator1 a, base_iterator2 b): a(a), b(b) {}
+
+            reference operator*() const { return reference(*a, *b); }
+            iterator& operator++() {
+                ++a;
+                ++b;
+                return *this;
+            }
+            iterator& operator--() {
+                --a;
+                --b;
+                return *this;
+            }
+            iterator& operator+=(difference_type n) {
+                a += n;
+                b += n;
+                return *this;
+            }
+            difference_type operator-(const iterator& x) const { return a - x.a; }
+            // 任何一边到了结尾都算结束
+            bool operator==(const iterator& x) const { return a == x.a || b == x.b; }
+            bool operator<(const iterator& x) const { return a < x.a; }
+
+        private:
+            base_iterator1 a;
+            base_iterator2 b;
+        };
+
+        zip_view(V1 base1, V2 base2): base1(std::move(base1)), base2(std::move(base2)) {}
+
+        iterator begin() const { return iterator(base1.begin(), base2.begin()); }
+        iterator end() const { return end(random_access()); }
+
+    private:
+        // 随机访问时两边都停在较短的长度上, 从结尾往回走也是对齐的
+        iterator end(std::true_type) const {
+            base_iterator1 a = base1.begin();
+            base_iterator2 b = base2.begin();
+            difference_type n = base1.end() - a;
+            difference_type m = difference_type(base2.end() - b);
+            if(m < n)
+                n = m;
+            return iterator(a + n, b + n);
+        }
+        iterator end(std::false_type) const { return iterator(base1.end(), base2.end()); }
+
+        V1 base1;
+        V2 base2;
+    };
+
+    // ---------------------------------------------------------------
+    // enumerate_view
+    // ---------------------------------------------------------------
+    template <class V>
+    class enumerate_view: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+        typedef iterator_traits<base_iterator> base_traits;
+
+    public:
+        typedef typename base_traits::difference_type difference_type;
+        typedef std::pair<difference_type, typename base_traits::reference> reference;
+
+        class iterator: public __iterator_ops<iterator, reference, difference_type> {
+        public:
+            typedef typename std::conditional<__is_random_access<base_iterator>::value,
+                random_access_iterator_tag,
+                typename __weaker_category<forward_iterator_tag,
+                    typename base_traits::iterator_category>::type>::type iterator_category;
+            typedef typename enumerate_view::difference_type difference_type;
+            typedef typename enumerate_view::reference reference;
+            typedef std::pair<difference_type, typename base_traits::value_type> value_type;
+            typedef void pointer;
+
+            iterator(difference_type index, base_iterator cur): index(index), cur(cur) {}
+
+            reference operator*() const { return reference(index, *cur); }
+            iterator& operator++() {
+                ++index;
+                ++cur;
+                return *this;
+            }
+            iterator& operator--() {
+                --index;
+                --cur;
+                return *this;
+            }
+            iterator& operator+=(difference_type n) {
+                index += n;
+                cur += n;
+                return *this;
+            }
+            difference_type operator-(const iterator& x) const { return index - x.index; }
+            bool operator==(const iterator& x) const { return cur == x.cur; }
+            bool operator<(const iterator& x) const { return index < x.index; }
+            base_iterator base() const { return cur; }
+
+        private:
+            difference_type index;
+            base_iterator cur;
+        };
+
+        explicit enumerate_view(V base): base_(std::move(base)) {}
+
+        iterator begin() const { return iterator(0, base_.begin()); }
+        // 非随机访问时结尾的下标用不到(只能单向, ==只比较位置)
+        iterator end() const {
+            typedef typename base_traits::iterator_category category;
+            base_iterator last = base_.end();
+            difference_type n = __is_random_access<base_iterator>::value ?
+                __range_distance(base_.begin(), last, category()) : 0;
+            return iterator(n, last);
+        }
+
+    private:
+        V base_;
+    };
+
+    // ---------------------------------------------------------------
+    // chunk_view
+    // ---------------------------------------------------------------
+    template <class V>
+    class chunk_view: public view_base {
+        typedef typename __range_iterator<const V>::type base_iterator;
+        typedef iterator_traits<base_iterator> base_traits;
+
+    public:
+        typedef typename base_traits::difference_type difference_type;
+        typedef subrange<base_iterator> reference;
+
+        // 随机访问时按相对于开头的位置计算: 位置总是n的倍数或者等于总长度
+        class iterator: public __iterator_ops<iterator, reference, difference_type> {
+        public:
+            typedef typename std::conditional<__is_random_access<base_iterator>::value,
+                random_access_iterator_tag,
+                typename __weaker_category<forward_iterator_tag,
+                    typename base_traits::iterator_category>::type>::type iterator_category;
+            typedef typename chunk_view::difference_type difference_type;
+            typedef typename chunk_view::reference reference;
+            typedef reference value_type;
+            typedef void pointer;
+
+            iterator(base_iterator first, base_iterator cur, base_iterator last, difference_type n):
+                first(first), cur(cur), last(last), n(n) {}
+
+            reference operator*() const {
+                base_iterator next = cur;
+                __advance_bounded(next, n, last);
+                return reference(cur, next);
+            }
+            iterator& operator++() {
+                __advance_bounded(cur, n, last);
+                return *this;
+            }
+            iterator& operator--() { return *this += -1; }
+            iterator& operator+=(difference_type k) {
+                difference_type pos = (index() + k) * n;
+                difference_type size = last - first;
+                cur = first + (pos < size ? pos : size);
+                return *this;
+            }
+            difference_type operator-(const iterator& x) const { return index() - x.index(); }
+            bool operator==(const iterator& x) const { return cur == x.cur; }
+            bool operator<(const iterator& x) const { return cur < x.cur; }
+
+        private:
+            // 第几块, 结尾是块数
+            difference_type index() const { return (difference_type(cur - first) + n - 1) / n; }
+
+            base_iterator first;
+            base_iterator cur;
+            base_iterator last;
+            difference_type n;
+        };
+
+        chunk_view(V base, difference_type n): base_(std::move(base)), n(n) {}
+
+        iterator begin() const { return iterator(base_.begin(), base_.begin(), base_.end(), n); }
+        iterator end() const { return iterator(base_.begin(), base_.end(), base_.end(), n); }
+
+    private:
+        V base_;
+        difference_type n;
+    };
+
+    // ---------------------------------------------------------------
+    // views: 构造视图的函数, 可以直接调用也可以用 | 串起来
+    // ---------------------------------------------------------------
+    namespace views {
+        template <class R>
+        typename __all_view<R>::type all(R&& r) {
+            return typename __all_view<R>::type(std::forward<R>(r));
+        }
+
+        template <class Pred>
+        struct __filter_closure { Pred pred; };
+
+        template <class R, class Pred>
+        filter_view<typename __all_view<R>::type, Pred> filter(R&& r, Pred pred) {
+            return filter_view<typename __all_view<R>::type, Pred>(all(std::forward<R>(r)), std::move(pred));
+        }
+
+        template <class Pred>
+        __filter_closure<Pred> filter(Pred pred) {
+            __filter_closure<Pred> c = {std::move(pred)};
+            return c;
+        }
+
+        template <class R, class Pred>
+        filter_view<typename __all_view<R>::type, Pred> operator|(R&& r, __filter_closure<Pred> c) {
+            return filter(std::forward<R>(r), std::move(c.pred));
+        }
+
+        template <class F>
+        struct __transform_closure { F f; };
+
+        template <class R, class F>
+        transform_view<typename __all_view<R>::type, F> transform(R&& r, F f) {
+            return transform_view<typename __all_view<R>::type, F>(all(std::forward<R>(r)), std::move(f));
+        }
+
+        template <class F>
+        __transform_closure<F> transform(F f) {
+            __transform_closure<F> c = {std::move(f)};
+            return c;
+        }
+
+        template <class R, class F>
+        transform_view<typename __all_view<R>::type, F> operator|(R&& r, __transform_closure<F> c) {
+            return transform(std::forward<R>(r), std::move(c.f));
+        }
+
+        struct __take_closure { ptrdiff_t n; };
+        struct __drop_closure { ptrdiff_t n; };
+        struct __chunk_closure { ptrdiff_t n; };
+        struct __enumerate_closure {};
+
+        template <class R>
+        take_view<typename __all_view<R>::type> take(R&& r, ptrdiff_t n) {
+            return take_view<typename __all_view<R>::type>(all(std::forward<R>(r)), n);
+        }
+
+        inline __take_closure take(ptrdiff_t n) {
+            __take_closure c = {n};
+            return c;
+        }
+
+        template <class R>
+        take_view<typename __all_view<R>::type> operator|(R&& r, __take_closure c) {
+            return take(std::forward<R>(r), c.n);
+        }
+
+        template <class R>
+        drop_view<typename __all_view<R>::type> drop(R&& r, ptrdiff_t n) {
+            return drop_view<typename __all_view<R>::type>(all(std::forward<R>(r)), n);
+        }
+
+        inline __drop_closure drop(ptrdiff_t n) {
+            __drop_closure c = {n};
+            return c;
+        }
+
+        template <class R>
+        drop_view<typename __all_view<R>::type> operator|(R&& r, __drop_closure c) {
+            return drop(std::forward<R>(r), c.n);
+        }
+
+        // n必须大于0
+        template <class R>
+        chunk_view<typename __all_view<R>::type> chunk(R&& r, ptrdiff_t n) {
+            return chunk_view<typename __all_view<R>::type>(all(std::forward<R>(r)), n);
+        }
+
+        inline __chunk_closure chunk(ptrdiff_t n) {
+            __chunk_closure c = {n};
+            return c;
+        }
+
+        template <class R>
+        chunk_view<typename __all_view<R>::type> operator|(R&& r, __chunk_closure c) {
+            return chunk(std::forward<R>(r), c.n);
+        }
+
+        template <class R>
+        enumerate_view<typename __all_view<R>::type> enumerate(R&& r) {
+            return enumerate_view<typename __all_view<R>::type>(all(std::forward<R>(r)));
+        }
+
+        inline __enumerate_closure enumerate() { return __enumerate_closure(); }
+
+        template <class R>
+        enumerate_view<typename __all_view<R>::type> operator|(R&& r, __enumerate_closure) {
+            return enumerate(std::forward<R>(r));
+        }
+
+        // zip只有直接调用的形式
+        template <class R1, class R2>
+        zip_view<typename __all_view<R1>::type, typename __all_view<R2>::type> zip(R1&& r1, R2&& r2) {
+            return zip_view<typename __all_view<R1>::type, typename __all_view<R2>::type>(
+                all(std::forward<R1>(r1)), all(std::forward<R2>(r2)));
+        }
+    }
+
+    // ---------------------------------------------------------------
+    // to: 把区间收集成容器
+    // ---------------------------------------------------------------
+    // 容器有reserve时按长度预留
+    template <class C>
+    auto __reserve_for(C& c, size_t n, int) -> decltype(c.reserve(n), void()) { c.reserve(n); }
+
+    template <class C>
+    void __reserve_for(C&, size_t, long) {}
+
+    // 随机访问的区间长度已知, 先预留再逐个push_back; 否则(例如经过filter)只能边放边扩容
+    template <class C, class R>
+    C __to(R&& r) {
+        typedef typename __range_iterator<R>::type iterator;
+        typedef typename iterator_traits<iterator>::iterator_category category;
+        C c;
+        iterator first = r.begin();
+        iterator last = r.end();
+        if(__is_random_access<iterator>::value)
+            __reserve_for(c, size_t(__range_distance(first, last, category())), 0);
+        for(; first != last; ++first)
+            c.push_back(*first);
+        return c;
+    }
+
+    template <class C>
+    struct __to_closure {};
+
+    template <template <class...> class C>
+    struct __to_template_closure {};
+
+    // to<vector<int> >(r), 直接给出容器的类型
+    template <class C, class R>
+    C to(R&& r) {
+        return __to<C>(std::forward<R>(r));
+    }
+
+    // to<vector>(r), 元素类型取区间的value_type
+    template <template <class...> class C, class R>
+    C<typename __range_value<R>::type> to(R&& r) {
+        return __to<C<typename __range_value<R>::type> >(std::forward<R>(r));
+    }
+
+    template <class C>
+    __to_closure<C> to() { return __to_closure<C>(); }
+
+    template <template <class...> class C>
+    __to_template_closure<C> to() { return __to_template_closure<C>(); }
+
+    template <class R, class C>
+    C operator|(R&& r, __to_closure<C>) {
+        return __to<C>(std::forward<R>(r));
+    }
+
+    template <class R, template <class...> class C>
+    C<typename __range_value<R>::type> operator|(R&& r, __to_template_closure<C>) {
+        return __to<C<typename __range_value<R>::type> >(std::forward<R>(r));
+    }
+}
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Allocator.h"
+#include "Trait.h"
+#include "uninitialized.h"
+
+namespace CCSTL {
+    template <class T, class Ref, class Ptr>
+    struct ring_buffer_iterator {
+        typedef ring_buffer_iterator<T, T&, T*> iterator;
+        typedef ring_buffer_iterator self;
+
+        typedef random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef Ptr pointer;
+        typedef Ref reference;
+        typedef ptrdiff_t difference_type;
+
+        T* buf;
+        size_t mask;
+        size_t pos;         // 没有取模的位置, 比较和相减都直接用它
+
+        ring_buffer_iterator(T* b, size_t m, size_t p): buf(b), mask(m), pos(p) {}
+        ring_buffer_iterator(const iterator& x): buf(x.buf), mask(x.mask), pos(x.pos) {}
+
+        reference operator*() const { return buf[pos & mask]; }
+        pointer operator->() const { return &(operator*()); }
+        reference operator[](difference_type n) const { return buf[(pos + n) & mask]; }
+
+        self& operator++() {
+            ++pos;
+            return *this;
+        }
+        self operator++(int) {
+            self tmp = *this;
+            ++pos;
+            return tmp;
+        }
+        self& operator--() {
+            --pos;
+            return *this;
+        }
+        self operator--(int) {
+            self tmp = *this;
+            --pos;
+            return tmp;
+        }
+        self& operator+=(difference_type n) {
+            pos += n;
+            return *this;
+        }
+        self& operator-=(difference_type n) {
+            pos -= n;
+            return *this;
+        }
+        self operator+(difference_type n) const { return self(buf, mask, pos + n); }
+        self operator-(difference_type n) const { return self(buf, mask, pos - n); }
+        difference_type operator-(const self& x) const { return difference_type(pos - x.pos); }
+
+        bool operator==(const self& x) const { return pos == x.pos; }
+        bool operator!=(const self& x) const { return pos != x.pos; }
+        bool operator<(const self& x) const { return difference_type(pos - x.pos) < 0; }
+        bool operator>(const self& x) const { return x < *this; }
+        bool operator<=(const self& x) const { return !(x < *this); }
+        bool operator>=(const self& x) const { return !(*this < x); }
+    };
+
+    // 容量为2的幂的环形缓冲区, 满了就翻倍. queue的默认底层容器:
+    // 元素放在一整块连续的空间里, 下标取模只是一次按位与; 头部出、尾部进都不移动其余元素,
+    // 也不像deque那样每512字节分配一个缓冲区. 容量只增不减, 稳定之后push/pop完全不分配内存.
+    // 扩容时把元素按逻辑顺序搬到新空间的开头, 之前的迭代器和引用全部失效
+    template <class T, class Alloc = allocator<T>>
+    class ring_buffer {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef ring_buffer_iterator<T, T&, T*> iterator;
+        typedef ring_buffer_iterator<T, const T&, const T*> const_iterator;
+
+    private:
+        typedef Alloc dataAllocator;
+
+        // 第一次分配时的容量
+        static const size_type initial_capacity = 8;
+
+        // head和count不相邻: 相邻时编译器会把pop_front里对二者的写合并成一次16字节的写,
+        // 下一次读head要从这次合并写里转发, 稳定的push/pop循环因此慢了一倍
+        T* buf;
+        size_type head;     // 第一个元素的位置, 总是小于cap
+        size_type cap;      // 0或者2的幂
+        size_type count;
+
+        T* slot(size_type i) const { return buf + ((head + i) & (cap - 1)); }
+
+        static size_type round_up(size_type n) {
+            size_type c = initial_capacity;
+            while(c < n)
+                c <<= 1;
+            return c;
+        }
+
+        // 把全部元素按顺序搬到new_buf的开头, 两段各搬一次; 第二段失败时把第一段析构掉
+        void relocate_to(T* new_buf) {
+            size_type first_len = cap - head < count ? cap - head : count;
+            T* mid = __uninitialized_relocate(buf + head, buf + head + first_len, new_buf);
+            try {
+                __uninitialized_relocate(buf, buf + (count - first_len), mid);
+            } catch(...) {
+                for(T* p = new_buf; p != mid; ++p)
+                    p->~T();
+                throw;
+            }
+        }
+
+        void destroy_all() {
+            for(size_type i = 0; i < count; ++i)
+                slot(i)->~T();
+        }
+
+        // 换到容量为n的新空间, 原来的元素析构并释放
+        void reallocate(size_type n) {
+            T* new_buf = dataAllocator::allocate(n);
+            try {
+                relocate_to(new_buf);
+            } catch(...) {
+                dataAllocator::deallocate(new_buf, n);
+                throw;
+            }
+            destroy_all();
+            dataAllocator::deallocate(buf, cap);
+            buf = new_buf;
+            cap = n;
+            head = 0;
+        }
+
+        // 满了: 先在新空间里构造新元素(参数可能引用着旧空间里的元素), 再搬迁旧元素
+        template <class... Args>
+        void grow_and_emplace_back(Args&&... args) {
+            size_type n = cap ? 2 * cap : initial_capacity;
+            T* new_buf = dataAllocator::allocate(n);
+            try {
+                new(static_cast<void*>(new_buf + count)) T(std::forward<Args>(args)...);
+            } catch(...) {
+                dataAllocator::deallocate(new_buf, n);
+                throw;
+            }
+            try {
+                relocate_to(new_buf);
+            } catch(...) {
+                new_buf[count].~T();
+                dataAllocator::deallocate(new_buf, n);
+                throw;
+            }
+            destroy_all();
+            dataAllocator::deallocate(buf, cap);
+            buf = new_buf;
+            cap = n;
+            head = 0;
+            ++count;
+        }
+
+    public:
+        ring_buffer(): buf(0), head(0), cap(0), count(0) {}
+        ring_buffer(const ring_buffer& x): buf(0), head(0), cap(0), count(0) {
+            if(x.count) {
+                reserve(x.count);
+                for(size_type i = 0; i < x.count; ++i)
+                    push_back(x[i]);
+            }
+        }
+        ring_buffer(ring_buffer&& x) noexcept: buf(x.buf), head(x.head), cap(x.cap), count(x.count) {
+            x.buf = 0;
+            x.cap = x.head = x.count = 0;
+        }
+        template <class InputIterator>
+        ring_buffer(InputIterator first, InputIterator last,
+            typename std::enable_if<!std::is_integral<InputIterator>::value>::type* = 0)
+            : buf(0), head(0), cap(0), count(0) {
+            __append_range(*this, first, last);
+        }
+        ~ring_buffer() {
+            destroy_all();
+            dataAllocator::deallocate(buf, cap);
+        }
+
+        ring_buffer& operator=(const ring_buffer& x) {
+            if(this != &x) {
+                ring_buffer tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        ring_buffer& operator=(ring_buffer&& x) noexcept {
+            ring_buffer tmp(std::move(x));
+            swap(tmp);
+            return *this;
+        }
+
+        iterator begin() { return iterator(buf, cap - 1, head); }
+        const_iterator begin() const { return const_iterator(buf, cap - 1, head); }
+        iterator end() { return iterator(buf, cap - 1, head + count); }
+        const_iterator end() const { return const_iterator(buf, cap - 1, head + count); }
+
+        size_type size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_type capacity() const { return cap; }
+        // 容量取不小于n的2的幂
+        void reserve(size_type n) {
+            if(n > cap)
+                reallocate(round_up(n));
+        }
+
+        reference operator[](size_type i) { return *slot(i); }
+        const_reference operator[](size_type i) const { return *slot(i); }
+        reference front() { return buf[head]; }
+        const_reference front() const { return buf[head]; }
+        reference back() { return *slot(count - 1); }
+        const_reference back() const { return *slot(count - 1); }
+
+        void push_back(const T& x) { emplace_back(x); }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            if(count == cap) {
+                grow_and_emplace_back(std::forward<Args>(args)...);
+                return;
+            }
+            new(static_cast<void*>(slot(count))) T(std::forward<Args>(args)...);
+            ++count;
+        }
+
+        void pop_front() {
+            buf[head].~T();
+            head = (head + 1) & (cap - 1);
+            --count;
+        }
+        void pop_back() {
+            --count;
+            slot(count)->~T();
+        }
+
+        // 保留容量
+        void clear() {
+            destroy_all();
+            head = 0;
+            count = 0;
+        }
+
+        void swap(ring_buffer& x) noexcept {
+            std::swap(buf, x.buf);
+            std::swap(cap, x.cap);
+            std::swap(head, x.head);
+            std::swap(count, x.count);
+        }
+    };
+
+    template <class T, class Alloc>
+    void swap(ring_buffer<T, Alloc>& a, ring_buffer<T, Alloc>& b) noexcept {
+        a.swap(b);
+    }
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef STACK_H
+#define STACK_H
+#include <utility>
+#include "uninitialized.h"
+#include "vector.h"
+
+namespace CCSTL {
+    // 栈, 以Sequence为底层容器, 在尾端进出.
+    // Sequence可以是vector(默认, 元素连续, 稳定之后不再分配)、deque或list,
+    // 要求有back/push_back/pop_back/emplace_back; list的size()是O(n)
+    template <class T, class Sequence = vector<T>>
+    class stack {
+    public:
+        typedef typename Sequence::value_type value_type;
+        typedef typename Sequence::size_type size_type;
+        typedef typename Sequence::reference reference;
+        typedef typename Sequence::const_reference const_reference;
+        typedef Sequence container_type;
+
+    protected:
+        Sequence c;
+
+    public:
+        stack(): c() {}
+        explicit stack(const Sequence& s): c(s) {}
+        explicit stack(Sequence&& s): c(std::move(s)) {}
+
+        bool empty() const { return c.empty(); }
+        size_type size() const { return c.size(); }
+        reference top() { return c.back(); }
+        const_reference top() const { return c.back(); }
+
+        void push(const value_type& x) { c.push_back(x); }
+
+        template <class... Args>
+        void emplace(Args&&... args) {
+            c.emplace_back(std::forward<Args>(args)...);
+        }
+
+        // 依次压入[first, last), 最后一个在栈顶; 长度已知并且底层容器有reserve时一次预留好
+        template <class InputIterator>
+        void push_range(InputIterator first, InputIterator last) {
+            __append_range(c, first, last);
+        }
+        template <class Range>
+        void push_range(const Range& r) {
+            __append_range(c, r.begin(), r.end());
+        }
+
+        void pop() { c.pop_back(); }
+
+        void swap(stack& x) { c.swap(x.c); }
+    };
+
+    template <class T, class Sequence>
+    void swap(stack<T, Sequence>& a, stack<T, Sequence>& b) {
+        a.swap(b);
+    }
+}
+#endif
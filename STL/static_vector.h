@@ -0,0 +1,327 @@
+#ifndef STATIC_VECTOR_H
+#define STATIC_VECTOR_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Trait.h"
+
+namespace CCSTL {
+    // 存储分两种, static_vector根据T选择, 自己不声明复制/析构, 以便继承存储的平凡性:
+    //   平凡的T  可平凡复制、平凡析构并且可以默认构造. T数组加上长度, 复制/析构都是编译器生成的
+    //            平凡版本, 整个对象可以memcpy, 所有操作都是对数组元素的赋值, C++14起可以在constexpr中使用.
+    //            默认构造不必平凡(如带默认成员初始化的struct), 新元素总是值初始化后赋值过去.
+    //            C++14/17的constexpr构造函数必须初始化每个成员, 只好在构造时把N个元素清零,
+    //            容量大、元素少时这是主要的开销; C++11(反正不能constexpr)和C++20不清零,
+    //            但默认构造不平凡的T仍会对N个元素各执行一次默认构造
+    //   其余的T  按T对齐的原始内存, 只构造前size个元素, 复制/移动/析构逐个处理
+    template <class T, size_t N,
+              bool Trivial = std::is_trivially_copyable<T>::value &&
+                             std::is_trivially_destructible<T>::value &&
+                             std::is_default_constructible<T>::value>
+    struct __static_vector_storage;
+
+    template <class T, size_t N>
+    struct __static_vector_storage<T, N, true> {
+        T elems[N ? N : 1];
+        size_t count;
+
+#if __cplusplus >= 201402L && __cpp_constexpr < 201907L
+        constexpr __static_vector_storage(): elems(), count(0) {}
+#elif __cplusplus >= 201402L
+        constexpr __static_vector_storage(): count(0) {}
+#else
+        __static_vector_storage(): count(0) {}
+#endif
+
+        CCSTL_CONSTEXPR14 T* ptr() { return elems; }
+        constexpr const T* ptr() const { return elems; }
+
+        template <class... Args>
+        CCSTL_CONSTEXPR14 void construct(size_t i, Args&&... args) { elems[i] = T(std::forward<Args>(args)...); }
+        CCSTL_CONSTEXPR14 void destroy(size_t) {}
+    };
+
+    template <class T, size_t N>
+    struct __static_vector_storage<T, N, false> {
+        typename std::aligned_storage<sizeof(T) * (N ? N : 1), alignof(T)>::type raw;
+        size_t count;
+
+        T* ptr() { return reinterpret_cast<T*>(&raw); }
+        const T* ptr() const { return reinterpret_cast<const T*>(&raw); }
+
+        template <class... Args>
+        void construct(size_t i, Args&&... args) { new(static_cast<void*>(ptr() + i)) T(std::forward<Args>(args)...); }
+        void destroy(size_t i) { ptr()[i].~T(); }
+
+        __static_vector_storage(): count(0) {}
+        __static_vector_storage(const __static_vector_storage& x): count(0) {
+            for(; count < x.count; ++count)
+                construct(count, x.ptr()[count]);
+        }
+        __static_vector_storage(__static_vector_storage&& x): count(0) {
+            for(; count < x.count; ++count)
+                construct(count, std::move(x.ptr()[count]));
+        }
+        __static_vector_storage& operator=(const __static_vector_storage& x) {
+            if(this != &x)
+                assign_from(x.ptr(), x.count);
+            return *this;
+        }
+        __static_vector_storage& operator=(__static_vector_storage&& x) {
+            if(this != &x)
+                assign_from(std::make_move_iterator(x.ptr()), x.count);
+            return *this;
+        }
+        ~__static_vector_storage() {
+            while(count)
+                destroy(--count);
+        }
+
+        // 已有的元素赋值, 多出的构造, 剩下的析构
+        template <class Iterator>
+        void assign_from(Iterator src, size_t n) {
+            size_t i = 0;
+            for(; i < n && i < count; ++i, ++src)
+                ptr()[i] = *src;
+            for(; i < n; ++i, ++src) {
+                construct(i, *src);
+                count = i + 1;
+            }
+            while(count > n)
+                destroy(--count);
+        }
+    };
+
+    // 容量在编译期固定、元素放在对象内部的vector, 不经过任何分配器.
+    // 接口与vector相同(push_back/insert/erase/resize, 迭代器就是T*), 超出容量N与越界下标一样
+    // 不做检查, 不确定时先看full(). T平凡时static_vector也可以平凡复制, 并且在C++14下可以constexpr
+    template <class T, size_t N>
+    class static_vector: private __static_vector_storage<T, N> {
+        typedef __static_vector_storage<T, N> base;
+        using base::count;
+        using base::ptr;
+        using base::construct;
+        using base::destroy;
+
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef typename iterator_traits<iterator>::difference_type difference_type;
+
+        static const size_type static_capacity = N;
+
+        // 构造
+        CCSTL_CONSTEXPR14 static_vector() {}
+        CCSTL_CONSTEXPR14 static_vector(size_type n, const T& value) { insert(end(), n, value); }
+        CCSTL_CONSTEXPR14 explicit static_vector(size_type n) { resize(n); }
+        CCSTL_CONSTEXPR14 static_vector(std::initializer_list<T> il) { insert(end(), il.begin(), il.end()); }
+        template <class InputIterator>
+        CCSTL_CONSTEXPR14 static_vector(InputIterator first, InputIterator last,
+            typename std::enable_if<!std::is_integral<InputIterator>::value>::type* = 0) {
+            insert(end(), first, last);
+        }
+
+        // 迭代器
+        CCSTL_CONSTEXPR14 iterator begin() { return ptr(); }
+        constexpr const_iterator begin() const { return ptr(); }
+        CCSTL_CONSTEXPR14 iterator end() { return ptr() + count; }
+        constexpr const_iterator end() const { return ptr() + count; }
+        constexpr const_iterator cbegin() const { return begin(); }
+        constexpr const_iterator cend() const { return end(); }
+
+        // 容量
+        constexpr size_type size() const { return count; }
+        constexpr bool empty() const { return count == 0; }
+        constexpr bool full() const { return count == N; }
+        constexpr size_type capacity() const { return N; }
+        constexpr size_type max_size() const { return N; }
+        // 与vector的接口一致, 容量固定, 什么也不做
+        CCSTL_CONSTEXPR14 void reserve(size_type) {}
+
+        // 访问元素
+        CCSTL_CONSTEXPR14 reference operator[](size_type n) { return ptr()[n]; }
+        constexpr const_reference operator[](size_type n) const { return ptr()[n]; }
+        CCSTL_CONSTEXPR14 reference front() { return ptr()[0]; }
+        constexpr const_reference front() const { return ptr()[0]; }
+        CCSTL_CONSTEXPR14 reference back() { return ptr()[count - 1]; }
+        constexpr const_reference back() const { return ptr()[count - 1]; }
+        CCSTL_CONSTEXPR14 pointer data() { return ptr(); }
+        constexpr const_pointer data() const { return ptr(); }
+
+        // 在尾端增删
+        CCSTL_CONSTEXPR14 void push_back(const T& x) {
+            construct(count, x);
+            ++count;
+        }
+        CCSTL_CONSTEXPR14 void push_back(T&& x) {
+            construct(count, std::move(x));
+            ++count;
+        }
+        template <class... Args>
+        CCSTL_CONSTEXPR14 void emplace_back(Args&&... args) {
+            construct(count, std::forward<Args>(args)...);
+            ++count;
+        }
+        CCSTL_CONSTEXPR14 void pop_back() { destroy(--count); }
+
+        CCSTL_CONSTEXPR14 void clear() {
+            while(count)
+                destroy(--count);
+        }
+
+        // 在position前插入, 后面的元素整体后移.
+        // x可能就是容器里的元素, 先复制一份再移动
+        CCSTL_CONSTEXPR14 iterator insert(const_iterator position, const T& x) {
+            T x_copy(x);
+            return insert(position, std::move(x_copy));
+        }
+        CCSTL_CONSTEXPR14 iterator insert(const_iterator position, T&& x) {
+            size_type i = position - begin();
+            T* p = ptr();
+            if(i == count) {
+                construct(count, std::move(x));
+            } else {
+                construct(count, std::move(p[count - 1]));
+                for(size_type j = count - 1; j > i; --j)
+                    p[j] = std::move(p[j - 1]);
+                p[i] = std::move(x);
+            }
+            ++count;
+            return p + i;
+        }
+        // 与vector::insert(position, n, x)相同, 按插入点之后的元素个数分两种情况
+        CCSTL_CONSTEXPR14 iterator insert(const_iterator position, size_type n, const T& x) {
+            size_type i = position - begin();
+            if(n == 0)
+                return ptr() + i;
+            size_type old = count;
+            T x_copy(x);
+            T* p = ptr();
+            if(old - i > n) {
+                for(size_type j = old; j < old + n; ++j, ++count)
+                    construct(j, std::move(p[j - n]));
+                for(size_type j = old; j-- > i + n; )
+                    p[j] = std::move(p[j - n]);
+                for(size_type j = i; j < i + n; ++j)
+                    p[j] = x_copy;
+            } else {
+                for(size_type j = old; j < i + n; ++j, ++count)
+                    construct(j, x_copy);
+                for(size_type j = i; j < old; ++j, ++count)
+                    construct(j + n, std::move(p[j]));
+                for(size_type j = i; j < old; ++j)
+                    p[j] = x_copy;
+            }
+            return p + i;
+        }
+        template <class InputIterator>
+        CCSTL_CONSTEXPR14 iterator insert(const_iterator position, InputIterator first, InputIterator last,
+            typename std::enable_if<!std::is_integral<InputIterator>::value>::type* = 0) {
+            size_type i = position - begin();
+            size_type old = count;
+            // 先追加到尾端, 再转到插入点, 单遍的输入迭代器也可以用
+            for(; first != last; ++first)
+                emplace_back(*first);
+            rotate(i, old);
+            return ptr() + i;
+        }
+        CCSTL_CONSTEXPR14 iterator insert(const_iterator position, std::initializer_list<T> il) {
+            return insert(position, il.begin(), il.end());
+        }
+        template <class... Args>
+        CCSTL_CONSTEXPR14 iterator emplace(const_iterator position, Args&&... args) {
+            return insert(position, T(std::forward<Args>(args)...));
+        }
+
+        // 删除, 后面的元素前移
+        CCSTL_CONSTEXPR14 iterator erase(const_iterator first, const_iterator last) {
+            size_type i = first - begin();
+            size_type n = last - first;
+            if(n == 0)
+                return ptr() + i;
+            T* p = ptr();
+            for(size_type j = i; j + n < count; ++j)
+                p[j] = std::move(p[j + n]);
+            for(size_type k = 0; k < n; ++k)
+                destroy(--count);
+            return p + i;
+        }
+        CCSTL_CONSTEXPR14 iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+        CCSTL_CONSTEXPR14 void resize(size_type n, const T& x) {
+            if(n < count)
+                erase(begin() + n, end());
+            else
+                insert(end(), n - count, x);
+        }
+        CCSTL_CONSTEXPR14 void resize(size_type n) {
+            while(count > n)
+                destroy(--count);
+            while(count < n) {
+                construct(count);
+                ++count;
+            }
+        }
+
+        CCSTL_CONSTEXPR14 void swap(static_vector& x) {
+            static_vector tmp(std::move(x));
+            x = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+    private:
+        CCSTL_CONSTEXPR14 void reverse(size_type first, size_type last) {
+            T* p = ptr();
+            while(first + 1 < last) {
+                --last;
+                T tmp = std::move(p[first]);
+                p[first] = std::move(p[last]);
+                p[last] = std::move(tmp);
+                ++first;
+            }
+        }
+
+        // 把[i, old)与[old, count)两段交换位置, 三次翻转
+        CCSTL_CONSTEXPR14 void rotate(size_type i, size_type old) {
+            reverse(i, old);
+            reverse(old, count);
+            reverse(i, count);
+        }
+    };
+
+    template <class T, size_t N>
+    const typename static_vector<T, N>::size_type static_vector<T, N>::static_capacity;
+
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 bool operator==(const static_vector<T, N>& a, const static_vector<T, N>& b) {
+        if(a.size() != b.size())
+            return false;
+        for(size_t i = 0; i < a.size(); ++i) {
+            if(!(a[i] == b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 bool operator!=(const static_vector<T, N>& a, const static_vector<T, N>& b) {
+        return !(a == b);
+    }
+
+    template <class T, size_t N>
+    CCSTL_CONSTEXPR14 void swap(static_vector<T, N>& a, static_vector<T, N>& b) {
+        a.swap(b);
+    }
+}
+
+#endif
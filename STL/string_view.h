@@ -0,0 +1,230 @@
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "Simd.h"
+
+namespace CCSTL {
+    // std::char_traits的eq就是按位相等, 这时子串查找可以交给Simd.cpp的内核,
+    // 自定义的Traits(比如忽略大小写)只能逐个字符调用Traits
+    template <class CharT, class Traits>
+    struct __bytewise_traits: public std::false_type {};
+    template <class CharT>
+    struct __bytewise_traits<CharT, std::char_traits<CharT>>:
+        public std::integral_constant<bool, std::is_integral<CharT>::value && sizeof(CharT) == 1> {};
+
+    // basic_string和basic_string_view共用的查找/比较.
+    // 单个字符的查找和比较就是Traits::find/compare, 对char是memchr/memcmp, libc已经按向量实现,
+    // 短字符串上比经由Simd.cpp分派更快. 子串查找在较长的串上用find_bytes的首尾字节过滤,
+    // 短串先用Traits::find找首字符再比较其余部分
+
+    // 比这更短的串不值得经过Simd.cpp的分派
+    const size_t __str_simd_find_min = 32;
+
+    // 返回下标, 找不到返回n
+    template <class CharT, class Traits>
+    inline size_t __str_find_char(const CharT* s, size_t n, CharT c) {
+        const CharT* p = Traits::find(s, n, c);
+        return p ? p - s : n;
+    }
+
+    template <class CharT, class Traits>
+    size_t __str_find(const CharT* s, size_t n, const CharT* t, size_t m, std::false_type) {
+        if(m == 0)
+            return 0;
+        for(size_t i = 0; i + m <= n; ++i) {
+            i += __str_find_char<CharT, Traits>(s + i, n - m + 1 - i, t[0]);
+            if(i + m > n)
+                break;
+            if(Traits::compare(s + i + 1, t + 1, m - 1) == 0)
+                return i;
+        }
+        return n;
+    }
+
+    template <class CharT, class Traits>
+    size_t __str_find(const CharT* s, size_t n, const CharT* t, size_t m, std::true_type) {
+        if(n < __str_simd_find_min)
+            return __str_find<CharT, Traits>(s, n, t, m, std::false_type());
+        return simd::find_bytes(s, n, t, m);
+    }
+
+    template <class CharT, class Traits>
+    inline int __str_compare(const CharT* a, size_t n, const CharT* b, size_t m) {
+        int r = Traits::compare(a, b, n < m ? n : m);
+        if(r != 0)
+            return r;
+        return n < m ? -1 : (n == m ? 0 : 1);
+    }
+
+    // 指向一段字符的只读视图, 不拥有也不复制字符, 用于零拷贝地切分和解析.
+    // 被引用的字符串必须比视图活得久, 也不保证以'\0'结尾
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    class basic_string_view {
+    public:
+        typedef CharT value_type;
+        typedef Traits traits_type;
+        typedef const CharT* const_iterator;
+        typedef const_iterator iterator;
+        typedef const CharT& const_reference;
+        typedef const_reference reference;
+        typedef const CharT* const_pointer;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        static const size_type npos = size_type(-1);
+
+    private:
+        typedef __bytewise_traits<CharT, Traits> bytewise;
+
+        const CharT* ptr;
+        size_type len;
+
+    public:
+        basic_string_view(): ptr(0), len(0) {}
+        basic_string_view(const CharT* s, size_type n): ptr(s), len(n) {}
+        basic_string_view(const CharT* s): ptr(s), len(Traits::length(s)) {}
+        template <class A>
+        basic_string_view(const std::basic_string<CharT, Traits, A>& s): ptr(s.data()), len(s.size()) {}
+
+        const_iterator begin() const { return ptr; }
+        const_iterator end() const { return ptr + len; }
+        const_pointer data() const { return ptr; }
+        size_type size() const { return len; }
+        size_type length() const { return len; }
+        bool empty() const { return len == 0; }
+
+        const_reference operator[](size_type pos) const { return ptr[pos]; }
+        const_reference front() const { return ptr[0]; }
+        const_reference back() const { return ptr[len - 1]; }
+
+        // 只移动视图的边界, n不能超过size()
+        void remove_prefix(size_type n) { ptr += n; len -= n; }
+        void remove_suffix(size_type n) { len -= n; }
+        void swap(basic_string_view& v) {
+            std::swap(ptr, v.ptr);
+            std::swap(len, v.len);
+        }
+
+        // pos超过size()时返回空视图, n超出时截到结尾
+        basic_string_view substr(size_type pos, size_type n = npos) const {
+            if(pos > len)
+                pos = len;
+            if(n > len - pos)
+                n = len - pos;
+            return basic_string_view(ptr + pos, n);
+        }
+
+        int compare(basic_string_view v) const {
+            return __str_compare<CharT, Traits>(ptr, len, v.ptr, v.len);
+        }
+
+        bool starts_with(basic_string_view v) const {
+            return len >= v.len && substr(0, v.len).compare(v) == 0;
+        }
+        bool ends_with(basic_string_view v) const {
+            return len >= v.len && substr(len - v.len).compare(v) == 0;
+        }
+
+        // 查找, 找不到返回npos
+        size_type find(CharT c, size_type pos = 0) const {
+            if(pos >= len)
+                return npos;
+            size_type i = pos + __str_find_char<CharT, Traits>(ptr + pos, len - pos, c);
+            return i == len ? npos : i;
+        }
+        size_type find(basic_string_view v, size_type pos = 0) const {
+            if(pos > len)
+                return npos;
+            size_type i = __str_find<CharT, Traits>(ptr + pos, len - pos, v.ptr, v.len, bytewise());
+            return i == len - pos && v.len != 0 ? npos : pos + i;
+        }
+        size_type rfind(CharT c, size_type pos = npos) const {
+            if(len == 0)
+                return npos;
+            for(size_type i = pos < len ? pos + 1 : len; i-- != 0; ) {
+                if(Traits::eq(ptr[i], c))
+                    return i;
+            }
+            return npos;
+        }
+        size_type rfind(basic_string_view v, size_type pos = npos) const {
+            if(v.len > len)
+                return npos;
+            for(size_type i = pos < len - v.len ? pos + 1 : len - v.len + 1; i-- != 0; ) {
+                if(Traits::compare(ptr + i, v.ptr, v.len) == 0)
+                    return i;
+            }
+            return npos;
+        }
+        bool contains(basic_string_view v) const { return find(v) != npos; }
+
+        std::basic_string<CharT, Traits> to_std_string() const {
+            return std::basic_string<CharT, Traits>(ptr, len);
+        }
+    };
+
+    template <class CharT, class Traits>
+    const typename basic_string_view<CharT, Traits>::size_type basic_string_view<CharT, Traits>::npos;
+
+    // 比较运算. 两侧有一侧是字符串或字符指针时, 借助隐式转换成视图比较
+    template <class CharT, class Traits>
+    bool operator==(basic_string_view<CharT, Traits> a, basic_string_view<CharT, Traits> b) {
+        return a.size() == b.size() && a.compare(b) == 0;
+    }
+    template <class CharT, class Traits>
+    bool operator==(basic_string_view<CharT, Traits> a,
+                    typename std::common_type<basic_string_view<CharT, Traits>>::type b) {
+        return a.size() == b.size() && a.compare(b) == 0;
+    }
+    template <class CharT, class Traits>
+    bool operator==(typename std::common_type<basic_string_view<CharT, Traits>>::type a,
+                    basic_string_view<CharT, Traits> b) {
+        return a.size() == b.size() && a.compare(b) == 0;
+    }
+    template <class CharT, class Traits>
+    bool operator!=(basic_string_view<CharT, Traits> a, basic_string_view<CharT, Traits> b) {
+        return !(a == b);
+    }
+    template <class CharT, class Traits>
+    bool operator!=(basic_string_view<CharT, Traits> a,
+                    typename std::common_type<basic_string_view<CharT, Traits>>::type b) {
+        return !(a == b);
+    }
+    template <class CharT, class Traits>
+    bool operator!=(typename std::common_type<basic_string_view<CharT, Traits>>::type a,
+                    basic_string_view<CharT, Traits> b) {
+        return !(a == b);
+    }
+    template <class CharT, class Traits>
+    bool operator<(basic_string_view<CharT, Traits> a, basic_string_view<CharT, Traits> b) {
+        return a.compare(b) < 0;
+    }
+    template <class CharT, class Traits>
+    bool operator>(basic_string_view<CharT, Traits> a, basic_string_view<CharT, Traits> b) {
+        return a.compare(b) > 0;
+    }
+    template <class CharT, class Traits>
+    bool operator<=(basic_string_view<CharT, Traits> a, basic_string_view<CharT, Traits> b) {
+        return a.compare(b) <= 0;
+    }
+    template <class CharT, class Traits>
+    bool operator>=(basic_string_view<CharT, Traits> a, basic_string_view<CharT, Traits> b) {
+        return a.compare(b) >= 0;
+    }
+
+    template <class CharT, class Traits>
+    std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
+                                                  basic_string_view<CharT, Traits> v) {
+        return os.write(v.data(), v.size());
+    }
+
+    typedef basic_string_view<char> string_view;
+    typedef basic_string_view<wchar_t> wstring_view;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef UNINITIALIZED_H
+#define UNINITIALIZED_H
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Trait.h"
+
+// 容器共用的扩容策略、元素搬迁和批量追加
+namespace CCSTL {
+    // 新容量: 至少翻倍, 且不少于required
+    inline size_t __grow_capacity(size_t old_capacity, size_t required) {
+        size_t len = old_capacity != 0 ? 2 * old_capacity : 1;
+        return len < required ? required : len;
+    }
+
+    // 扩容时元素能否移动过去: 移动构造不抛异常, 或者根本不能复制(与std::move_if_noexcept相同)
+    template <class T>
+    struct __relocate_by_move: public std::integral_constant<bool,
+        std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value> {};
+
+    template <class T>
+    T* __uninitialized_relocate(T* first, T* last, T* result, std::true_type /* trivially copyable */) {
+        if(first != last)
+            memcpy(static_cast<void*>(result), static_cast<const void*>(first), (last - first) * sizeof(T));
+        return result + (last - first);
+    }
+
+    // 复制中途抛出异常时, 把已经构造的元素析构掉, 与std::uninitialized_copy相同
+    template <class T>
+    T* __uninitialized_relocate(T* first, T* last, T* result, std::false_type) {
+        T* cur = result;
+        try {
+            for(; first != last; ++first, ++cur)
+                new(static_cast<void*>(cur)) T(std::move_if_noexcept(*first));
+        } catch(...) {
+            for(; result != cur; ++result)
+                result->~T();
+            throw;
+        }
+        return cur;
+    }
+
+    // 把[first, last)搬到未初始化的result, 返回结尾. 可以按位复制的类型直接memcpy,
+    // 其余移动构造(或者在移动可能抛异常时复制); 原来的元素仍需调用者析构
+    template <class T>
+    inline T* __uninitialized_relocate(T* first, T* last, T* result) {
+        return __uninitialized_relocate(first, last, result,
+            std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+    }
+
+    // 区间长度已知(随机访问)并且容器有reserve时, 先按追加后的长度预留
+    template <class Sequence>
+    auto __reserve_more(Sequence& c, size_t n, int) -> decltype(c.reserve(n), void()) {
+        c.reserve(c.size() + n);
+    }
+
+    template <class Sequence>
+    void __reserve_more(Sequence&, size_t, long) {}
+
+    template <class Sequence, class InputIterator>
+    void __append_reserve(Sequence& c, InputIterator first, InputIterator last, random_access_iterator_tag) {
+        __reserve_more(c, size_t(last - first), 0);
+    }
+
+    template <class Sequence, class InputIterator>
+    void __append_reserve(Sequence&, InputIterator, InputIterator, input_iterator_tag) {}
+
+    // 把[first, last)追加到容器尾端(stack/queue的push_range): 长度已知并且容器有reserve时先预留好,
+    // 有insert(end, first, last)的容器(vector、list)交给它, 其余的(deque、ring_buffer)逐个push_back.
+    // vector的区间insert是逐个插入的, 不先预留就会一路扩容
+    template <class Sequence, class InputIterator>
+    auto __append_range(Sequence& c, InputIterator first, InputIterator last, int)
+        -> decltype(c.insert(c.end(), first, last), void()) {
+        typedef typename iterator_traits<InputIterator>::iterator_category category;
+        __append_reserve(c, first, last, category());
+        c.insert(c.end(), first, last);
+    }
+
+    template <class Sequence, class InputIterator>
+    void __append_range(Sequence& c, InputIterator first, InputIterator last, long) {
+        typedef typename iterator_traits<InputIterator>::iterator_category category;
+        __append_reserve(c, first, last, category());
+        for(; first != last; ++first)
+            c.push_back(*first);
+    }
+
+    template <class Sequence, class InputIterator>
+    inline void __append_range(Sequence& c, InputIterator first, InputIterator last) {
+        __append_range(c, first, last, 0);
+    }
+}
+#endif
@@ -11,9 +11,13 @@
 #include "Iterator.h"
 #include <initializer_list>
 #include "Trait.h"
+#include "algorithm.h"
+#include "Instrument.h"
+#include "uninitialized.h"
 
 namespace CCSTL{
-    template <class T, class Alloc = allocator<T>>
+    // Instrument见Instrument.h, 默认的null_instrument没有任何开销
+    template <class T, class Alloc = allocator<T>, class Instrument = null_instrument>
     class vector {
     public:
         typedef T value_type;
@@ -33,9 +37,13 @@ namespace CCSTL{
         typedef Alloc dataAllocator;
 
         void insert_aux(iterator position, const T& x);
+        template <class... Args>
+        void realloc_insert(iterator position, Args&&... args);
         void deallocate() {
-            if(start)
+            if(start) {
+                Instrument::on_deallocate((end_of_storage - start) * sizeof(T));
                 dataAllocator::deallocate(start, end_of_storage-start);
+            }
         }
         void destroy(iterator start, iterator end) {
             while(start < end)
@@ -45,6 +53,7 @@ namespace CCSTL{
             start = allocate_and_fill(n, value);
             finish = start + n;
             end_of_storage = finish;
+            Instrument::on_size(n);
         }
     public:
 
@@ -68,6 +77,7 @@ namespace CCSTL{
             finish = v.finish;
             end_of_storage = v.end_of_storage;
             v.start = v.finish = v.end_of_storage = 0;
+            Instrument::on_move(finish - start);
         }
 
         vector& operator=(const vector& v) {
@@ -86,6 +96,7 @@ namespace CCSTL{
                 finish = v.finish;
                 end_of_storage = v.end_of_storage;
                 v.start = v.finish = v.end_of_storage = 0;
+                Instrument::on_move(finish - start);
             }
 
             return *this;
@@ -108,13 +119,40 @@ namespace CCSTL{
         // 与容量相关
         size_type size() const { return size_type(end() - begin()); }
         bool empty() const { return begin() == end(); }
-        difference_type capacity() const { return end_of_storage - first; }
+        difference_type capacity() const { return end_of_storage - start; }
         size_type max_size() const { return size_type(-1) / sizeof(T); }
+        // 预留至少n个元素的空间, 原有元素像扩容时一样移动过去; n不超过capacity()时什么也不做
+        void reserve(size_type n) {
+            if(n <= size_type(capacity()))
+                return;
+            const size_type old_size = size();
+            iterator new_start = dataAllocator::allocate(n);
+            Instrument::on_allocate(n * sizeof(T));
+            Instrument::on_reallocate(old_size * sizeof(T));
+            if(__relocate_by_move<T>::value)
+                Instrument::on_move(old_size);
+            else
+                Instrument::on_copy(old_size);
+            iterator new_finish;
+            try {
+                new_finish = __uninitialized_relocate(start, finish, new_start);
+            } catch(...) {
+                dataAllocator::deallocate(new_start, n);
+                throw;
+            }
+            destroy(start, finish);
+            deallocate();
+            start = new_start;
+            finish = new_finish;
+            end_of_storage = new_start + n;
+        }
         // 访问元素相关
         reference operator[](size_type n) { return *(begin() + n); }
         const_reference operator[](size_type n) const { return *(begin() + n); }
         reference front() { return *(begin()); }
+        const_reference front() const { return *(begin()); }
         reference back() { return *(end() - 1); }
+        const_reference back() const { return *(end() - 1); }
 
         // 修改容器相关的操作
         // 清空容器, 销毁容器中的所有对象并使容器的size为0, 但不回收容器已有的空间
@@ -144,25 +182,40 @@ namespace CCSTL{
             if(finish != end_of_storage) {
                 dataAllocator::construct(finish, x);
                 ++finish;
+                Instrument::on_size(size());
             } else
                 insert_aux(end(), x);
         }
 
+        // 在尾端直接构造元素; 没有备用空间时直接在新空间里构造, 不经过临时对象
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            if(finish != end_of_storage) {
+                new(static_cast<void*>(finish)) T(std::forward<Args>(args)...);
+                ++finish;
+            } else
+                realloc_insert(end(), std::forward<Args>(args)...);
+            Instrument::on_size(size());
+        }
+
         void pop_back() {
             --finish;
             dataAllocator::destroy(finish);
         }
 
         iterator erase(iterator first, iterator last) {
-            iterator i = std::copy(last, finish, first);
+            Instrument::on_move(finish - last);
+            iterator i = std::move(last, finish, first);
             destroy(i, finish);
             finish = finish - (last - first);
             return first;
         }
 
         iterator erase(iterator position) {
-            if(position + 1 != end())
-                std::copy(position + 1, finish, position);
+            if(position + 1 != end()) {
+                Instrument::on_move(finish - position - 1);
+                std::move(position + 1, finish, position);
+            }
             --finish;
             dataAllocator::destroy(finish);
             return position;
@@ -174,6 +227,7 @@ namespace CCSTL{
             if(finish != end_of_storage && position == end()) {
                 dataAllocator::construct(finish, x);
                 ++finish;
+                Instrument::on_size(size());
             } else 
                 insert_aux(position, x);
             return begin() + n;
@@ -189,14 +243,18 @@ namespace CCSTL{
     private:
         iterator allocate_and_fill(size_type n, const T& x) {
             iterator result = dataAllocator::allocate(n);
+            Instrument::on_allocate(n * sizeof(T));
             std::uninitialized_fill_n(result, n, x);
             return result;
         }
         template <class InputIterator>
         void allocate_and_copy(InputIterator first, InputIterator last) {
             start = dataAllocator::allocate(last - first);
+            Instrument::on_allocate((last - first) * sizeof(T));
+            Instrument::on_copy(last - first);
             finish = std::uninitialized_copy(first, last, start);
             end_of_storage = finish;
+            Instrument::on_size(last - first);
         }
  
         template <class InputIterator>
@@ -211,43 +269,64 @@ namespace CCSTL{
                           input_iterator_tag);
     };
 
-    template <class T, class Alloc>
-    void vector<T, Alloc>::insert_aux(iterator position, const T& x) {
+    template <class T, class Alloc, class Instrument>
+    void vector<T, Alloc, Instrument>::insert_aux(iterator position, const T& x) {
         // 还有备用空间
         if(finish != end_of_storage) {
-            dataAllocator::construct(finish, *(finish-1));
-            ++finish;
+            Instrument::on_move(finish - position);
             T x_copy = x;
-            std::copy_backward(position, finish-2, finish-1);
-            *position = x_copy;
+            new(static_cast<void*>(finish)) T(std::move(*(finish-1)));
+            ++finish;
+            std::move_backward(position, finish-2, finish-1);
+            *position = std::move(x_copy);
         } else { // 无备用空间
-            const size_type old_size = size();
-            const size_type len = old_size != 0 ? 2*old_size:1;
-            iterator new_start = dataAllocator::allocate(len);
-            iterator new_finish = new_start;
+            realloc_insert(position, x);
+        }
+        Instrument::on_size(size());
+    }
+
+    // 扩容并在position处用args构造新元素
+    template <class T, class Alloc, class Instrument>
+    template <class... Args>
+    void vector<T, Alloc, Instrument>::realloc_insert(iterator position, Args&&... args) {
+        const size_type old_size = size();
+        const size_type len = __grow_capacity(old_size, old_size + 1);
+        iterator new_start = dataAllocator::allocate(len);
+        Instrument::on_allocate(len * sizeof(T));
+        Instrument::on_reallocate(old_size * sizeof(T));
+        if(__relocate_by_move<T>::value)
+            Instrument::on_move(old_size);
+        else
+            Instrument::on_copy(old_size);
+        // 参数可能引用着容器里的元素, 先在新空间构造好, 再把原有元素移过去
+        iterator slot = new_start + (position - start);
+        iterator new_finish = new_start;
+        try {
+            new(static_cast<void*>(slot)) T(std::forward<Args>(args)...);
             try {
-                new_finish = std::uninitialized_copy(start, position, new_start);
-                dataAllocator::construct(new_finish, x);
-                ++new_finish;
-                new_finish = std::uninitialized_copy(position, finish, new_finish);
+                new_finish = __uninitialized_relocate(start, position, new_start);
+                new_finish = __uninitialized_relocate(position, finish, slot + 1);
             } catch(...) {
-                destroy(new_start, new_finish);
-                dataAllocator::deallocate(new_start, len);
+                dataAllocator::destroy(slot);
                 throw;
             }
+        } catch(...) {
+            destroy(new_start, new_finish);
+            dataAllocator::deallocate(new_start, len);
+            throw;
+        }
 
-            destroy(begin(), end());
-            deallocate();
+        destroy(begin(), end());
+        deallocate();
 
-            start = new_start;
-            finish = new_finish;
-            end_of_storage = new_start + len;
-        }
+        start = new_start;
+        finish = new_finish;
+        end_of_storage = new_start + len;
     }
 
 
-    template <class T, class Alloc>
-    void vector<T, Alloc>::insert(iterator position, size_type n, const T& x) {
+    template <class T, class Alloc, class Instrument>
+    void vector<T, Alloc, Instrument>::insert(iterator position, size_type n, const T& x) {
         // 插入的元素个数不为0才有效
         if(n != 0) {
             // 备用空间大于等于"新增元素个数"
@@ -255,30 +334,45 @@ namespace CCSTL{
                 T x_copy = x;
                 const size_type elems_after = finish - position;
                 iterator old_finish = finish;
+                Instrument::on_move(elems_after);
                 // 插入点之后的现有元素个数"大于"新增元素个数
                 if(elems_after > n) {
-                    std::uninitialized_copy(finish - n, finish, old_finish);
+                    std::uninitialized_copy(std::make_move_iterator(finish - n),
+                                            std::make_move_iterator(finish), old_finish);
                     finish += n;
-                    std::copy_backward(position, old_finish - n, old_finish);
-                    finish += elems_after;
-                    std::fill(position, old_finish, x_copy);
+                    std::move_backward(position, old_finish - n, old_finish);
+                    std::fill(position, position + n, x_copy);
                 } else {
                 // 插入点之后的现有元素个数"小于等于"新增元素个数
                     std::uninitialized_fill_n(finish, n - elems_after, x_copy);
                     finish += n - elems_after;
-                    std::uninitialized_copy(position, old_finish, finish);
+                    std::uninitialized_copy(std::make_move_iterator(position),
+                                            std::make_move_iterator(old_finish), finish);
                     finish += elems_after;
                     std::fill(position, old_finish, x_copy);
                 }
             } else {
                 const size_type old_size = size();
-                const size_type len = old_size + std::max(old_size, n);
+                const size_type len = __grow_capacity(old_size, old_size + n);
                 iterator new_start = dataAllocator::allocate(len);
+                Instrument::on_allocate(len * sizeof(T));
+                Instrument::on_reallocate(old_size * sizeof(T));
+                if(__relocate_by_move<T>::value)
+                    Instrument::on_move(old_size);
+                else
+                    Instrument::on_copy(old_size);
+                // 与insert_aux相同, 先填好新元素再移动原有元素
+                iterator slot = new_start + (position - start);
                 iterator new_finish = new_start;
                 try {
-                    new_finish = std::uninitialized_copy(start, position, new_start);
-                    new_finish = std::uninitialized_fill_n(new_finish, n, x);
-                    new_finish = std::uninitialized_copy(position, finish, new_finish);
+                    std::uninitialized_fill_n(slot, n, x);
+                    try {
+                        new_finish = __uninitialized_relocate(start, position, new_start);
+                        new_finish = __uninitialized_relocate(position, finish, slot + n);
+                    } catch(...) {
+                        destroy(slot, slot + n);
+                        throw;
+                    }
                 } catch(...) {
                     destroy(new_start, new_finish);
                     dataAllocator::deallocate(new_start, len);
@@ -292,14 +386,15 @@ namespace CCSTL{
                 finish = new_finish;
                 end_of_storage = new_start + len;
             }
+            Instrument::on_size(size());
         }
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Instrument>
     template <class InputIterator>
-    void vector<T, Alloc>::range_insert(iterator pos, 
-                                        InputIterator first, InputIterator last,
-                                        input_iterator_tag) 
+    void vector<T, Alloc, Instrument>::range_insert(iterator pos, 
+                                                    InputIterator first, InputIterator last,
+                                                    input_iterator_tag) 
     {
         for(; first != last; ++first) {
             pos = insert(pos, *first);
@@ -308,24 +403,14 @@ namespace CCSTL{
     }
 
 
-    template <class T, class Alloc>
-    bool vector<T, Alloc>::operator ==(const vector& v) const {
-        if(size() != v.size())
-            return false;
-        else {
-            auto p1 = start;
-            auto p2 = v.start;
-            for(; p1 != finish; ++p1) {
-                if(*p1 != *p2)
-                    return false;
-            }
-
-            return true;
-        }
+    template <class T, class Alloc, class Instrument>
+    bool vector<T, Alloc, Instrument>::operator ==(const vector& v) const {
+        // 可以按位比较的元素类型会走memcmp, 其余逐个比较
+        return size() == v.size() && CCSTL::equal(begin(), end(), v.begin());
     }
 
-    template <class T, class Alloc>
-    bool vector<T, Alloc>::operator !=(const vector& v) const {
+    template <class T, class Alloc, class Instrument>
+    bool vector<T, Alloc, Instrument>::operator !=(const vector& v) const {
         return !(*this == v);
     } 
 }